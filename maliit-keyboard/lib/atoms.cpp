@@ -0,0 +1,159 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+#include "atoms.h"
+
+//! \namespace MaliitKeyboard::Atoms
+//! \brief Process-wide table of interned strings.
+//!
+//! Key area conversion looks up the same background and icon file names,
+//! font names, colors and labels over and over again, for each key, key
+//! state, view and orientation. Interning them makes all keys share a single,
+//! implicitly shared buffer per distinct string, instead of holding thousands
+//! of small duplicates. Comparing interned strings through same() then only
+//! compares data pointers.
+//!
+//! Interning takes a lock, so it should be used where keys are built, not
+//! where they are handled.
+
+namespace MaliitKeyboard {
+namespace Atoms {
+namespace {
+
+class Table
+{
+public:
+    QMutex mutex;
+    QSet<QByteArray> byte_arrays;
+    QSet<QString> strings;
+
+    explicit Table()
+        : mutex()
+        , byte_arrays()
+        , strings()
+    {}
+};
+
+Table *table()
+{
+    static Table instance;
+    return &instance;
+}
+
+template<typename T>
+T lookup(QSet<T> *set,
+         const T &value)
+{
+    if (value.isEmpty()) {
+        return T();
+    }
+
+    typename QSet<T>::const_iterator it(set->constFind(value));
+
+    if (it != set->constEnd()) {
+        return *it;
+    }
+
+    set->insert(value);
+    return value;
+}
+
+template<typename T>
+int purgeUnused(QSet<T> *set)
+{
+    int released(0);
+    typename QSet<T>::iterator it(set->begin());
+
+    while (it != set->end()) {
+        // Only referenced by the table itself:
+        if (it->isDetached()) {
+            released += it->size() * sizeof(typename T::value_type);
+            it = set->erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    return released;
+}
+
+} // unnamed namespace
+
+//! \brief Returns the shared instance of \a value.
+QByteArray intern(const QByteArray &value)
+{
+    Table *const t(table());
+    QMutexLocker locker(&t->mutex);
+    return lookup(&t->byte_arrays, value);
+}
+
+//! \brief Returns the shared instance of \a value.
+QString intern(const QString &value)
+{
+    Table *const t(table());
+    QMutexLocker locker(&t->mutex);
+    return lookup(&t->strings, value);
+}
+
+//! \brief Returns the number of distinct interned strings.
+int count()
+{
+    Table *const t(table());
+    QMutexLocker locker(&t->mutex);
+    return t->byte_arrays.count() + t->strings.count();
+}
+
+//! \brief Forgets all interned strings.
+//!
+//! Strings handed out before stay valid, but are no longer shared with
+//! strings interned afterwards.
+void clear()
+{
+    Table *const t(table());
+    QMutexLocker locker(&t->mutex);
+    t->byte_arrays.clear();
+    t->strings.clear();
+}
+
+//! \brief Forgets interned strings that are no longer used anywhere else.
+//! \returns Approximate number of bytes released.
+//!
+//! Unlike clear(), strings still in use stay shared with strings interned
+//! afterwards.
+int purge()
+{
+    Table *const t(table());
+    QMutexLocker locker(&t->mutex);
+    return (purgeUnused(&t->byte_arrays) + purgeUnused(&t->strings));
+}
+
+}} // namespace Atoms, MaliitKeyboard
@@ -0,0 +1,72 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+#include "flushtimer.h"
+
+namespace MaliitKeyboard {
+
+//! \class FlushTimer
+//! \brief Defers work to the end of the current event loop turn.
+//!
+//! Owners queue or merge work, such as host operations or geometry updates,
+//! and call schedule(). The timeout fires once, after all events that were
+//! already queued got handled, so a burst of requests from a single input
+//! event results in a single flush. It does not wait for, or synchronize
+//! with, rendering.
+//!
+//! Owners stop the timer when flushing early, and must flush before the
+//! keyboard gets hidden, see WakeupMonitor.
+
+//! \param name Object name, to tell flush timers apart in WakeupMonitor
+//!             reports.
+//! \param parent The owner of this instance (optional).
+FlushTimer::FlushTimer(const char *name,
+                       QObject *parent)
+    : QTimer(parent)
+{
+    setObjectName(QString::fromLatin1(name));
+    setSingleShot(true);
+    setInterval(0);
+}
+
+FlushTimer::~FlushTimer()
+{}
+
+//! \brief Starts the timer, unless a flush is scheduled already.
+void FlushTimer::schedule()
+{
+    if (not isActive()) {
+        start();
+    }
+}
+
+} // namespace MaliitKeyboard
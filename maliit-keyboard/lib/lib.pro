@@ -10,7 +10,7 @@ include(models/models.pri)
 include(logic/logic.pri)
 include(parser/parser.pri)
 
-HEADERS += coreutils.h
-SOURCES += coreutils.cpp
+HEADERS += coreutils.h tracing.h atoms.h wakeupmonitor.h flushtimer.h
+SOURCES += coreutils.cpp tracing.cpp atoms.cpp wakeupmonitor.cpp flushtimer.cpp
 
 include(../word-prediction.pri)
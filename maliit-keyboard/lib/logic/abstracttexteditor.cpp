@@ -34,6 +34,8 @@
 #include "logic/layoutupdater.h" // For signal/slot connection setup.
 #include "models/wordribbon.h"
 #include "models/styleattributes.h"
+#include "logic/wordboundarytracker.h"
+#include "tracing.h"
 
 namespace MaliitKeyboard {
 namespace Logic {
@@ -160,92 +162,6 @@ namespace Logic {
 
 namespace {
 
-//! \brief Checks whether given \a c is a word separator.
-//! \param c Char to test.
-//!
-//! Other way to do checks would be using isLetterOrNumber() + some
-//! other methods. But UTF is so crazy that I am not sure whether
-//! other strange categories are parts of the word or not. It is
-//! easier to specify punctuations and whitespaces.
-inline bool isSeparator(const QChar &c)
-{
-    return (c.isPunct() or c.isSpace());
-}
-
-//! \brief Extracts a word boundaries at cursor position.
-//! \param surrounding_text Text from which extraction will happen.
-//! \param cursor_position Position of cursor within \a surrounding_text.
-//! \param replacement Place where replacement data will be stored.
-//!
-//! \return whether surrounding text was valid (not empty).
-//!
-//! If cursor is placed right after the word, boundaries of this word
-//! are extracted.  Otherwise if cursor is placed right before the
-//! word, then no word boundaries are stored - instead invalid
-//! replacement is stored. It might happen that cursor position is
-//! outside the string, so \a replacement will have fixed position.
-bool extractWordBoundariesAtCursor(const QString& surrounding_text,
-                                   int cursor_position,
-                                   AbstractTextEditor::Replacement *replacement)
-{
-    const int text_length(surrounding_text.length());
-
-    if (text_length == 0) {
-        return false;
-    }
-
-    // just in case - if cursor is far after last char in surrounding
-    // text we place it right after last char.
-    cursor_position = qBound(0, cursor_position, text_length);
-
-    // cursor might be placed in after last char (that is to say - its
-    // index might be the one of string terminator) - for simplifying
-    // the algorithm below we fake it as cursor is put on delimiter:
-    // "abc" - surrounding text
-    //     | - cursor placement
-    // "abc " - fake surrounding text
-    const QString fake_surrounding_text(surrounding_text + " ");
-    const QChar *const fake_data(fake_surrounding_text.constData());
-    // begin is index of first char in a word
-    int begin(-1);
-    // end is index of a char after last char in a word.
-    // -2, because -2 - (-1) = -1 and we would like to
-    // have -1 as invalid length.
-    int end(-2);
-
-    for (int iter(cursor_position); iter >= 0; --iter) {
-        const QChar &c(fake_data[iter]);
-
-        if (isSeparator(c)) {
-            if (iter != cursor_position) {
-                break;
-            }
-        } else {
-            begin = iter;
-        }
-    }
-
-    if (begin >= 0) {
-        // take note that fake_data's last QChar is always a space.
-        for (int iter(cursor_position); iter <= text_length; ++iter) {
-            const QChar &c(fake_data[iter]);
-
-            end = iter;
-            if (isSeparator(c)) {
-                break;
-            }
-        }
-    }
-
-    if (replacement) {
-        replacement->start = begin;
-        replacement->length = end - begin;
-        replacement->cursor_position = cursor_position;
-    }
-
-    return true;
-}
-
 Qt::Key toRepeatableQtKey(Key::Action action)
 {
     switch(action) {
@@ -299,7 +215,7 @@ void connectLayoutUpdaterToTextEditor(LayoutUpdater *updater,
                      updater, SLOT(onWordCandidatesChanged(WordCandidateList)));
 
     QObject::connect(editor,  SIGNAL(autoCapsActivated()),
-                     updater, SIGNAL(autoCapsActivated()));
+                     updater, SLOT(onAutoCapsActivated()));
 
     QObject::connect(editor->wordEngine(), SIGNAL(enabledChanged(bool)),
                      updater,              SLOT(setWordRibbonVisible(bool)));
@@ -324,6 +240,7 @@ public:
             , interval(50)
         {
             timer.setSingleShot(true);
+            timer.setObjectName("AbstractTextEditor::autoRepeat");
         }
     } auto_repeat;
 
@@ -335,6 +252,7 @@ public:
     bool auto_caps_enabled;
     int ignore_next_cursor_position;
     QString ignore_next_surrounding_text;
+    WordBoundaryTracker word_boundaries;
 
     explicit AbstractTextEditorPrivate(Model::Text *new_text,
                                        Logic::AbstractWordEngine *new_word_engine,
@@ -354,6 +272,7 @@ AbstractTextEditorPrivate::AbstractTextEditorPrivate(Model::Text *new_text,
     , auto_caps_enabled(false)
     , ignore_next_cursor_position(-1)
     , ignore_next_surrounding_text()
+    , word_boundaries()
 {
     (void) valid();
 }
@@ -460,6 +379,8 @@ void AbstractTextEditor::onKeyPressed(const Key &key)
 //! applies.
 void AbstractTextEditor::onKeyReleased(const Key &key)
 {
+    MALIIT_TRACE_SCOPE("AbstractTextEditor::onKeyReleased");
+
     Q_D(AbstractTextEditor);
 
     if (not d->valid()) {
@@ -663,6 +584,23 @@ void AbstractTextEditor::clearPreedit()
     d->word_engine->computeCandidates(d->text.data());
 }
 
+//! \brief Stops auto repeat of a held key, e.g. when the keyboard gets
+//! hidden while the key is still pressed. Otherwise the repeat timer would
+//! keep firing until the key is released again.
+void AbstractTextEditor::cancelAutoRepeat()
+{
+    Q_D(AbstractTextEditor);
+    d->auto_repeat.timer.stop();
+    d->auto_repeat.key = Qt::Key_unknown;
+}
+
+//! \brief Returns whether a held key is waiting to be repeated.
+bool AbstractTextEditor::isAutoRepeating() const
+{
+    Q_D(const AbstractTextEditor);
+    return d->auto_repeat.timer.isActive();
+}
+
 //! \brief Returns whether preedit functionality is enabled.
 //! \sa preeditEnabled
 bool AbstractTextEditor::isPreeditEnabled() const
@@ -813,7 +751,7 @@ void AbstractTextEditor::onCursorPositionChanged(int cursor_position,
     Q_D(AbstractTextEditor);
     Replacement r;
 
-    if (not extractWordBoundariesAtCursor(surrounding_text, cursor_position, &r)) {
+    if (not d->word_boundaries.update(surrounding_text, cursor_position, &r)) {
         return;
     }
 
@@ -127,6 +127,8 @@ public:
     Q_SLOT void replacePreedit(const QString &replacement);
     Q_SLOT void replaceAndCommitPreedit(const QString &replacement);
     Q_SLOT void clearPreedit();
+    Q_SLOT void cancelAutoRepeat();
+    bool isAutoRepeating() const;
 
     bool isPreeditEnabled() const;
     Q_SLOT void setPreeditEnabled(bool enabled);
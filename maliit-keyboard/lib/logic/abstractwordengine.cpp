@@ -159,4 +159,18 @@ void AbstractWordEngine::addToUserDictionary(const QString &word)
     Q_UNUSED(word);
 }
 
+//! \brief Releases dictionaries and models, for example while the keyboard
+//! is hidden. Derived classes load them again when next needed.
+//!
+//! This does nothing.
+void AbstractWordEngine::releaseResources()
+{}
+
+//! \brief Loads what releaseResources() released ahead of its next use, for
+//! example when the keyboard gets shown again.
+//!
+//! This does nothing.
+void AbstractWordEngine::restoreResources()
+{}
+
 }} // namespace MaliitKeyboard, Logic
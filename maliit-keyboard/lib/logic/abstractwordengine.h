@@ -65,6 +65,8 @@ public:
     Q_SIGNAL void candidatesChanged(const WordCandidateList &candidates);
 
     virtual void addToUserDictionary(const QString &word);
+    virtual void releaseResources();
+    virtual void restoreResources();
 
 private:
     virtual WordCandidateList fetchCandidates(Model::Text *text) = 0;
@@ -32,6 +32,7 @@
 #include "eventhandler.h"
 #include "layoutupdater.h"
 #include "models/layout.h"
+#include "tracing.h"
 
 namespace MaliitKeyboard {
 namespace Logic {
@@ -44,6 +45,11 @@ public:
 
     explicit EventHandlerPrivate(Model::Layout * const new_layout,
                                  LayoutUpdater * const new_updater);
+
+    bool hasKey(int index,
+                const char *caller) const;
+    void setKeyState(int index,
+                     KeyDescription::State state);
 };
 
 
@@ -57,6 +63,35 @@ EventHandlerPrivate::EventHandlerPrivate(Model::Layout *const new_layout,
 }
 
 
+bool EventHandlerPrivate::hasKey(int index,
+                                 const char *caller) const
+{
+    if (not layout->hasKey(index)) {
+        qWarning() << caller
+                   << "Invalid index:" << index
+                   << "Keys available:" << layout->rowCount();
+        return false;
+    }
+
+    return true;
+}
+
+
+//! Keys with state backgrounds are changed in place, all other keys need to
+//! be restyled (and thus copied) by the updater.
+void EventHandlerPrivate::setKeyState(int index,
+                                      KeyDescription::State state)
+{
+    const Key &key(layout->key(index));
+
+    if (key.hasStateBackgrounds()) {
+        layout->setKeyState(index, state);
+    } else {
+        layout->replaceKey(index, updater->modifyKey(key, state));
+    }
+}
+
+
 //! \brief Performs event handling for Model::Layout instance, using a LayoutUpdater instance.
 //!
 //! Does not take ownership of either layout or updater.
@@ -83,22 +118,19 @@ void EventHandler::onEntered(int index)
 {
     Q_D(EventHandler);
 
-    const QVector<Key> &keys(d->layout->keyArea().keys());
-
-    if (index >= keys.count()) {
-        qWarning() << __PRETTY_FUNCTION__
-                   << "Invalid index:" << index
-                   << "Keys available:" << keys.count();
+    if (not d->hasKey(index, __PRETTY_FUNCTION__)) {
         return;
     }
 
-    const Key &key(keys.at(index));
+    // Updater and listeners get the key as it was before entering it. Both
+    // leave the model alone, so the key can be used in place:
+    const Key &key(d->layout->key(index));
 
-    const Key pressed_key(d->updater->modifyKey(key, KeyDescription::PressedState));
-    d->layout->replaceKey(index, pressed_key);
     d->updater->onKeyEntered(key);
 
     Q_EMIT keyEntered(key);
+
+    d->setKeyState(index, KeyDescription::PressedState);
 }
 
 
@@ -106,68 +138,59 @@ void EventHandler::onExited(int index)
 {
     Q_D(EventHandler);
 
-    const QVector<Key> &keys(d->layout->keyArea().keys());
-
-    if (index >= keys.count()) {
-        qWarning() << __PRETTY_FUNCTION__
-                   << "Invalid index:" << index
-                   << "Keys available:" << keys.count();
+    if (not d->hasKey(index, __PRETTY_FUNCTION__)) {
         return;
     }
 
-    const Key &key(keys.at(index));
+    // Listeners get the key as it was before exiting it, the updater gets
+    // the key in normal state:
+    Q_EMIT keyExited(d->layout->key(index));
 
-    const Key normal_key(d->updater->modifyKey(key, KeyDescription::NormalState));
-    d->layout->replaceKey(index, normal_key);
-    d->updater->onKeyExited(normal_key);
-
-    Q_EMIT keyExited(key);
+    d->setKeyState(index, KeyDescription::NormalState);
+    d->updater->onKeyExited(d->layout->key(index));
 }
 
 
 void EventHandler::onPressed(int index)
 {
-    Q_D(EventHandler);
+    MALIIT_TRACE_SCOPE("EventHandler::onPressed");
 
-    const QVector<Key> &keys(d->layout->keyArea().keys());
+    Q_D(EventHandler);
 
-    if (index >= keys.count()) {
-        qWarning() << __PRETTY_FUNCTION__
-                   << "Invalid index:" << index
-                   << "Keys available:" << keys.count();
+    if (not d->hasKey(index, __PRETTY_FUNCTION__)) {
         return;
     }
 
+    d->setKeyState(index, KeyDescription::PressedState);
+
+    // Shallow copy, keeps the key alive in case the updater switches views:
+    const QVector<Key> keys(d->layout->keys());
     const Key &key(keys.at(index));
 
-    const Key pressed_key(d->updater->modifyKey(key, KeyDescription::PressedState));
-    d->layout->replaceKey(index, pressed_key);
-    d->updater->onKeyPressed(pressed_key);
+    d->updater->onKeyPressed(key);
 
-    Q_EMIT keyPressed(pressed_key);
+    Q_EMIT keyPressed(key);
 }
 
 
 void EventHandler::onReleased(int index)
 {
-    Q_D(EventHandler);
+    MALIIT_TRACE_SCOPE("EventHandler::onReleased");
 
-    const QVector<Key> &keys(d->layout->keyArea().keys());
+    Q_D(EventHandler);
 
-    if (index >= keys.count()) {
-        qWarning() << __PRETTY_FUNCTION__
-                   << "Invalid index:" << index
-                   << "Keys available:" << keys.count();
+    if (not d->hasKey(index, __PRETTY_FUNCTION__)) {
         return;
     }
 
+    d->setKeyState(index, KeyDescription::NormalState);
+
+    const QVector<Key> keys(d->layout->keys());
     const Key &key(keys.at(index));
 
-    const Key normal_key(d->updater->modifyKey(key, KeyDescription::NormalState));
-    d->layout->replaceKey(index, normal_key);
-    d->updater->onKeyReleased(normal_key);
+    d->updater->onKeyReleased(key);
 
-    Q_EMIT keyReleased(normal_key);
+    Q_EMIT keyReleased(key);
 }
 
 
@@ -175,7 +198,7 @@ void EventHandler::onPressAndHold(int index)
 {
     Q_D(EventHandler);
 
-    const QVector<Key> &keys(d->layout->keyArea().keys());
+    const QVector<Key> keys(d->layout->keys());
 
     if (index >= keys.count()) {
         qWarning() << __PRETTY_FUNCTION__
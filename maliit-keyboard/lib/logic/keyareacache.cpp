@@ -0,0 +1,163 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "keyareacache.h"
+
+namespace MaliitKeyboard {
+namespace Logic {
+namespace {
+
+struct CachedKeyArea
+{
+    KeyArea key_area;
+    QString style_name;
+};
+
+} // namespace
+
+//! \class KeyAreaCache
+//! Keeps a bounded number of finished key areas, as created by
+//! KeyAreaConverter. The cache ids are built by the converter and identify
+//! layout, view variant, orientation and style attributes. Least recently
+//! used key areas are dropped first. The owner of the cache is responsible
+//! for clearing it whenever style profile or layout files change.
+
+class KeyAreaCachePrivate
+{
+public:
+    QCache<QString, CachedKeyArea> key_areas;
+    int hits;
+    int misses;
+
+    explicit KeyAreaCachePrivate(int capacity)
+        : key_areas(capacity)
+        , hits(0)
+        , misses(0)
+    {}
+};
+
+//! \param capacity The maximum number of cached key areas.
+KeyAreaCache::KeyAreaCache(int capacity)
+    : d_ptr(new KeyAreaCachePrivate(capacity))
+{}
+
+KeyAreaCache::~KeyAreaCache()
+{}
+
+//! \brief Returns the maximum number of cached key areas.
+int KeyAreaCache::capacity() const
+{
+    Q_D(const KeyAreaCache);
+    return d->key_areas.maxCost();
+}
+
+//! \brief Sets the maximum number of cached key areas.
+//! \param capacity The new capacity. Surplus key areas are dropped.
+void KeyAreaCache::setCapacity(int capacity)
+{
+    Q_D(KeyAreaCache);
+    d->key_areas.setMaxCost(capacity);
+}
+
+//! \brief Looks up a cached key area.
+//! \param id The cache id.
+//! \param key_area Receives the cached key area, if found. Must not be null.
+//! \param style_name Receives the style name of the key area (optional).
+//! \returns Whether a key area was found.
+bool KeyAreaCache::lookup(const QString &id,
+                          KeyArea *key_area,
+                          QString *style_name)
+{
+    Q_D(KeyAreaCache);
+
+    const CachedKeyArea *const cached(d->key_areas.object(id));
+
+    if (not cached || not key_area) {
+        ++d->misses;
+        return false;
+    }
+
+    ++d->hits;
+    *key_area = cached->key_area;
+
+    if (style_name) {
+        *style_name = cached->style_name;
+    }
+
+    return true;
+}
+
+//! \brief Stores a key area.
+//! \param id The cache id.
+//! \param key_area The key area to store.
+//! \param style_name The style name the key area was converted with.
+void KeyAreaCache::insert(const QString &id,
+                          const KeyArea &key_area,
+                          const QString &style_name)
+{
+    Q_D(KeyAreaCache);
+
+    CachedKeyArea *cached = new CachedKeyArea;
+    cached->key_area = key_area;
+    cached->style_name = style_name;
+
+    d->key_areas.insert(id, cached);
+}
+
+//! \brief Drops all cached key areas.
+void KeyAreaCache::clear()
+{
+    Q_D(KeyAreaCache);
+    d->key_areas.clear();
+}
+
+//! \brief Returns the number of cached key areas.
+int KeyAreaCache::count() const
+{
+    Q_D(const KeyAreaCache);
+    return d->key_areas.count();
+}
+
+//! \brief Returns the number of successful lookups.
+int KeyAreaCache::hits() const
+{
+    Q_D(const KeyAreaCache);
+    return d->hits;
+}
+
+//! \brief Returns the number of failed lookups.
+int KeyAreaCache::misses() const
+{
+    Q_D(const KeyAreaCache);
+    return d->misses;
+}
+
+}} // namespace Logic, MaliitKeyboard
@@ -37,6 +37,8 @@
 #include "models/keyarea.h"
 #include "models/key.h"
 #include "logic/keyboardloader.h"
+#include "logic/keyareacache.h"
+#include "atoms.h"
 
 #include <QtCore>
 
@@ -57,7 +59,7 @@ namespace {
 //! \param orientation The layout orientation.
 //! \param is_extended_keyarea Whether the resulting key area is used for
 //!        extended keys (optional).
-KeyArea createFromKeyboard(StyleAttributes *attributes,
+KeyArea createFromKeyboard(const StyleAttributes *attributes,
                            const Keyboard &source,
                            LayoutHelper::Orientation orientation,
                            bool is_extended_keyarea = false)
@@ -72,24 +74,26 @@ KeyArea createFromKeyboard(StyleAttributes *attributes,
         return ka;
     }
 
-    attributes->setStyleName(kb.style_name);
+    // Does not modify the attributes, so that conversion can run on any
+    // thread, as long as the attributes are not shared with other threads:
+    const SharedStyleMetrics metrics(attributes->metrics(orientation, kb.style_name));
 
     Font font;
-    font.setName(attributes->fontName(orientation));
-    font.setSize(attributes->fontSize(orientation));
-    font.setColor(attributes->fontColor(orientation));
+    font.setName(Atoms::intern(metrics->font_name));
+    font.setSize(metrics->font_size);
+    font.setColor(Atoms::intern(metrics->font_color));
 
     Font small_font(font);
-    small_font.setSize(attributes->smallFontSize(orientation));
+    small_font.setSize(metrics->small_font_size);
 
-    static const QMargins bg_margins(attributes->keyBackgroundBorders());
+    const QMargins bg_margins(attributes->keyBackgroundBorders());
 
-    const qreal max_width(attributes->keyAreaWidth(orientation));
-    const qreal key_height(attributes->keyHeight(orientation));
-    const qreal key_top_row_height(attributes->keyTopRowHeight(orientation));
-    const qreal key_bottom_row_height(attributes->keyBottomRowHeight(orientation));
-    const qreal margin = attributes->keyMargin(orientation);
-    const qreal padding = attributes->keyAreaPadding(orientation);
+    const qreal max_width(metrics->key_area_width);
+    const qreal key_height(metrics->key_height);
+    const qreal key_top_row_height(metrics->key_top_row_height);
+    const qreal key_bottom_row_height(metrics->key_bottom_row_height);
+    const qreal margin = metrics->key_margin;
+    const qreal padding = metrics->key_area_padding;
 
     QPoint pos(0, 0);
     QVector<int> row_indices;
@@ -123,7 +127,7 @@ KeyArea createFromKeyboard(StyleAttributes *attributes,
             ++spacer_count;
         }
 
-        width = attributes->keyWidth(orientation, desc.width);
+        width = metrics->key_widths[desc.width];
 
         const qreal key_margin((at_row_start || at_row_end) ? margin + padding : margin * 2);
 
@@ -141,12 +145,15 @@ KeyArea createFromKeyboard(StyleAttributes *attributes,
         key.rLabel().setFont(text.count() > 1 ? small_font : font);
 
         if (key.icon().isEmpty()) {
-            key.setIcon(attributes->icon(desc.icon,
-                                         KeyDescription::NormalState));
+            key.setIcon(Atoms::intern(attributes->icon(desc.icon,
+                                                       KeyDescription::NormalState)));
         } else {
-            key.setIcon(attributes->customIcon(key.icon()));
+            key.setIcon(Atoms::intern(attributes->customIcon(key.icon())));
         }
 
+        // Touch handling then only needs to flip the key state:
+        key.setStateBackgrounds(attributes->keyBackgrounds(key.style()));
+
         pos.rx() += key.rect().width();
 
         if (at_row_end) {
@@ -197,14 +204,14 @@ KeyArea createFromKeyboard(StyleAttributes *attributes,
     }
 
     Area area;
-    area.setBackground(attributes->keyAreaBackground());
+    area.setBackground(Atoms::intern(attributes->keyAreaBackground()));
     area.setBackgroundBorders(attributes->keyAreaBackgroundBorders());
     area.setSize(QSize((is_extended_keyarea ? consumed_width : max_width),
                        pos.y()));
 
     ka.setArea(area);
-    ka.setOrigin(is_extended_keyarea ? QPoint(0, -attributes->verticalOffset(orientation))
-                                     : QPoint(0, attributes->wordRibbonHeight(orientation)));
+    ka.setOrigin(is_extended_keyarea ? QPoint(0, -metrics->vertical_offset)
+                                     : QPoint(0, metrics->word_ribbon_height));
     ka.setKeys(kb.keys);
 
     return ka;
@@ -215,10 +222,15 @@ KeyArea createFromKeyboard(StyleAttributes *attributes,
 //! \param attributes The styling attributes that should be applied to the
 //!                   created key areas.
 //! \param loader The keyboard layout loader.
+//! \param cache The cache for finished key areas (optional). Owner of the
+//!              cache needs to clear it when style profile or layout files
+//!              change.
 KeyAreaConverter::KeyAreaConverter(StyleAttributes *attributes,
-                                   KeyboardLoader *loader)
+                                   KeyboardLoader *loader,
+                                   KeyAreaCache *cache)
     : m_attributes(attributes)
     , m_loader(loader)
+    , m_cache(cache)
     , m_orientation(LayoutHelper::Landscape)
 {
     if (not attributes || not loader) {
@@ -231,6 +243,68 @@ KeyAreaConverter::~KeyAreaConverter()
 {}
 
 
+QString KeyAreaConverter::extendedVariant(const QString &label)
+{
+    return QString("extended:%1").arg(label);
+}
+
+
+//! \brief Builds the cache id for a key area variant.
+//!
+//! The style profile and attribute set are identified by the attributes'
+//! store, the style name follows from layout and variant and is stored along
+//! with the cached key area.
+//! \param variant The key area variant (main, shifted, symbols page, ...).
+QString KeyAreaConverter::cacheId(const QString &variant) const
+{
+    return QString("%1/%2/%3/%4")
+            .arg(m_loader->activeId())
+            .arg(variant)
+            .arg(m_orientation == LayoutHelper::Landscape ? "landscape" : "portrait")
+            .arg(m_attributes->storeName());
+}
+
+
+//! \brief Looks up a finished key area in the cache.
+//!
+//! Activates the style name of the cached key area, as if it was converted.
+//! \param variant The key area variant.
+//! \param key_area Receives the cached key area, if found.
+//! \returns Whether a cached key area was found.
+bool KeyAreaConverter::lookupKeyArea(const QString &variant,
+                                     KeyArea *key_area) const
+{
+    QString style_name;
+
+    if (m_cache && m_cache->lookup(cacheId(variant), key_area, &style_name)) {
+        m_attributes->setStyleName(style_name);
+        return true;
+    }
+
+    return false;
+}
+
+
+//! \brief Converts a keyboard and stores the result in the cache.
+//! \param variant The key area variant. Empty variants are not cached.
+//! \param keyboard The keyboard to convert.
+//! \param is_extended_keyarea Whether the key area is used for extended keys.
+//! \returns The converted key area.
+KeyArea KeyAreaConverter::convertKeyboard(const QString &variant,
+                                          const Keyboard &keyboard,
+                                          bool is_extended_keyarea) const
+{
+    const KeyArea ka(createFromKeyboard(m_attributes, keyboard, m_orientation, is_extended_keyarea));
+    m_attributes->setStyleName(keyboard.style_name);
+
+    if (m_cache && not variant.isEmpty()) {
+        m_cache->insert(cacheId(variant), ka, keyboard.style_name);
+    }
+
+    return ka;
+}
+
+
 //! \brief Sets the layout orientation used for creating key areas.
 //! \param orientation The layout orientation. Default: landscape.
 void KeyAreaConverter::setLayoutOrientation(LayoutHelper::Orientation orientation)
@@ -241,28 +315,52 @@ void KeyAreaConverter::setLayoutOrientation(LayoutHelper::Orientation orientatio
 //! \brief Returns the main key area.
 KeyArea KeyAreaConverter::keyArea() const
 {
-    return createFromKeyboard(m_attributes, m_loader->keyboard(), m_orientation);
+    KeyArea ka;
+
+    if (not lookupKeyArea("main", &ka)) {
+        ka = convertKeyboard("main", m_loader->keyboard());
+    }
+
+    return ka;
 }
 
 
 //! \brief Returns the next key area (right of main key area).
 KeyArea KeyAreaConverter::nextKeyArea() const
 {
-    return createFromKeyboard(m_attributes, m_loader->nextKeyboard(), m_orientation);
+    KeyArea ka;
+
+    if (not lookupKeyArea("next", &ka)) {
+        ka = convertKeyboard("next", m_loader->nextKeyboard());
+    }
+
+    return ka;
 }
 
 
 //! \brief Returns the previous key area (left of main key area).
 KeyArea KeyAreaConverter::previousKeyArea() const
 {
-    return createFromKeyboard(m_attributes, m_loader->previousKeyboard(), m_orientation);
+    KeyArea ka;
+
+    if (not lookupKeyArea("previous", &ka)) {
+        ka = convertKeyboard("previous", m_loader->previousKeyboard());
+    }
+
+    return ka;
 }
 
 
 //! \brief Returns the main key area with shift bindings activated.
 KeyArea KeyAreaConverter::shiftedKeyArea() const
 {
-    return createFromKeyboard(m_attributes, m_loader->shiftedKeyboard(), m_orientation);
+    KeyArea ka;
+
+    if (not lookupKeyArea("shifted", &ka)) {
+        ka = convertKeyboard("shifted", m_loader->shiftedKeyboard());
+    }
+
+    return ka;
 }
 
 
@@ -270,7 +368,14 @@ KeyArea KeyAreaConverter::shiftedKeyArea() const
 //! \param page The symbols page to return (optional).
 KeyArea KeyAreaConverter::symbolsKeyArea(int page) const
 {
-    return createFromKeyboard(m_attributes, m_loader->symbolsKeyboard(page), m_orientation);
+    const QString variant(QString("symbols%1").arg(page));
+    KeyArea ka;
+
+    if (not lookupKeyArea(variant, &ka)) {
+        ka = convertKeyboard(variant, m_loader->symbolsKeyboard(page));
+    }
+
+    return ka;
 }
 
 
@@ -278,7 +383,14 @@ KeyArea KeyAreaConverter::symbolsKeyArea(int page) const
 //! \param dead The key used to look up the dead keys.
 KeyArea KeyAreaConverter::deadKeyArea(const Key &dead) const
 {
-    return createFromKeyboard(m_attributes, m_loader->deadKeyboard(dead), m_orientation);
+    const QString variant(QString("dead:%1").arg(dead.label().text()));
+    KeyArea ka;
+
+    if (not lookupKeyArea(variant, &ka)) {
+        ka = convertKeyboard(variant, m_loader->deadKeyboard(dead));
+    }
+
+    return ka;
 }
 
 
@@ -286,29 +398,79 @@ KeyArea KeyAreaConverter::deadKeyArea(const Key &dead) const
 //! \param dead The key used to look up the dead keys.
 KeyArea KeyAreaConverter::shiftedDeadKeyArea(const Key &dead) const
 {
-    return createFromKeyboard(m_attributes, m_loader->shiftedDeadKeyboard(dead), m_orientation);
+    const QString variant(QString("shifted-dead:%1").arg(dead.label().text()));
+    KeyArea ka;
+
+    if (not lookupKeyArea(variant, &ka)) {
+        ka = convertKeyboard(variant, m_loader->shiftedDeadKeyboard(dead));
+    }
+
+    return ka;
 }
 
 
 //! Returns an extended key area.
+//!
+//! The key is identified by its label, which also tells whether the shifted
+//! binding was used. Space keys and keys without label are not cached.
 //! \param key The key used to look up the extended key binding.
 KeyArea KeyAreaConverter::extendedKeyArea(const Key &key) const
 {
-    return createFromKeyboard(m_attributes, m_loader->extendedKeyboard(key), m_orientation, true);
+    const QString &text(key.label().text());
+
+    if (text.isEmpty() || key.action() == Key::ActionSpace) {
+        return convertKeyboard(QString(), m_loader->extendedKeyboard(key), true);
+    }
+
+    const QString variant(extendedVariant(text));
+    KeyArea ka;
+
+    if (not lookupKeyArea(variant, &ka)) {
+        ka = convertKeyboard(variant, m_loader->extendedKeyboard(key), true);
+    }
+
+    return ka;
+}
+
+
+//! \brief Adds an extended key area that was converted elsewhere, such as
+//! by LayoutPipeline, to the cache.
+//! \param label The label of the key the extended key area belongs to.
+//! \param key_area The converted extended key area.
+//! \param style_name The style name that was active for the conversion.
+void KeyAreaConverter::cacheExtendedKeyArea(const QString &label,
+                                            const KeyArea &key_area,
+                                            const QString &style_name) const
+{
+    if (m_cache && not label.isEmpty() && key_area.hasKeys()) {
+        m_cache->insert(cacheId(extendedVariant(label)), key_area, style_name);
+    }
 }
 
 
 //! Returns the number key area.
 KeyArea KeyAreaConverter::numberKeyArea() const
 {
-    return createFromKeyboard(m_attributes, m_loader->numberKeyboard(), m_orientation);
+    KeyArea ka;
+
+    if (not lookupKeyArea("number", &ka)) {
+        ka = convertKeyboard("number", m_loader->numberKeyboard());
+    }
+
+    return ka;
 }
 
 
 //! Returns the phone number key area.
 KeyArea KeyAreaConverter::phoneNumberKeyArea() const
 {
-    return createFromKeyboard(m_attributes, m_loader->phoneNumberKeyboard(), m_orientation);
+    KeyArea ka;
+
+    if (not lookupKeyArea("phonenumber", &ka)) {
+        ka = convertKeyboard("phonenumber", m_loader->phoneNumberKeyboard());
+    }
+
+    return ka;
 }
 
 }} // namespace Logic, MaliitKeyboard
@@ -42,19 +42,32 @@ class StyleAttributes;
 class KeyboardLoader;
 class KeyArea;
 class Key;
+struct Keyboard;
 
 namespace Logic {
 
+class KeyAreaCache;
+
 class KeyAreaConverter
 {
 private:
     StyleAttributes * const m_attributes;
     KeyboardLoader * const m_loader;
+    KeyAreaCache * const m_cache;
     LayoutHelper::Orientation m_orientation;
 
+    static QString extendedVariant(const QString &label);
+    QString cacheId(const QString &variant) const;
+    bool lookupKeyArea(const QString &variant,
+                       KeyArea *key_area) const;
+    KeyArea convertKeyboard(const QString &variant,
+                            const Keyboard &keyboard,
+                            bool is_extended_keyarea = false) const;
+
 public:
     explicit KeyAreaConverter(StyleAttributes *attributes,
-                              KeyboardLoader *loader);
+                              KeyboardLoader *loader,
+                              KeyAreaCache *cache = 0);
     virtual ~KeyAreaConverter();
 
     void setLayoutOrientation(LayoutHelper::Orientation orientation);
@@ -68,6 +81,9 @@ public:
     virtual KeyArea deadKeyArea(const Key &dead) const;
     virtual KeyArea shiftedDeadKeyArea(const Key &dead) const;
     virtual KeyArea extendedKeyArea(const Key &key) const;
+    void cacheExtendedKeyArea(const QString &label,
+                              const KeyArea &key_area,
+                              const QString &style_name) const;
     virtual KeyArea numberKeyArea() const;
     virtual KeyArea phoneNumberKeyArea() const;
 };
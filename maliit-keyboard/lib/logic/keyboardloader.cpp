@@ -33,10 +33,12 @@
 
 #include <QDir>
 #include <QFile>
+#include <QFileSystemWatcher>
 #include <QRegExp>
 
 #include "parser/layoutparser.h"
 #include "coreutils.h"
+#include "atoms.h"
 
 #include "keyboardloader.h"
 
@@ -102,7 +104,7 @@ QPair<Key, KeyDescription> keyAndDescFromTags(const TagKeyPtr &key,
     KeyDescription skey_description;
 
     skey.setExtendedKeysEnabled(key->extended());
-    skey.rLabel().setText(binding->label());
+    skey.rLabel().setText(Atoms::intern(binding->label()));
 
     if (binding->dead()) {
         // TODO: document it.
@@ -112,7 +114,7 @@ QPair<Key, KeyDescription> keyAndDescFromTags(const TagKeyPtr &key,
     }
 
     skey.setCommandSequence(binding->sequence());
-    skey.setIcon(binding->icon().toUtf8());
+    skey.setIcon(Atoms::intern(binding->icon().toUtf8()));
     skey.setStyle(static_cast<Key::Style>(key->style()));
 
     skey_description.row = row;
@@ -221,8 +223,8 @@ Keyboard getKeyboard(const TagKeyboardPtr &keyboard,
                         const int index(dead_key.isNull() ? -1 : the_binding->accents().indexOf(dead_key));
                         QPair<Key, KeyDescription> key_and_desc(keyAndDescFromTags(key, the_binding, row_num));
 
-                        key_and_desc.first.rLabel().setText(index < 0 ? the_binding->label()
-                                                                      : the_binding->accented_labels().at(index));
+                        key_and_desc.first.rLabel().setText(Atoms::intern(index < 0 ? the_binding->label()
+                                                                                     : the_binding->accented_labels().at(index)));
                         key_and_desc.second.left_spacer = spacer_met;
                         key_and_desc.second.right_spacer = false;
 
@@ -382,6 +384,12 @@ class KeyboardLoaderPrivate
 public:
 
     QString active_id;
+    QScopedPointer<QFileSystemWatcher> watcher;
+
+    static QString layoutPath(const QString &id)
+    {
+        return (getLanguagesDir() + "/" + id + ".xml");
+    }
 };
 
 KeyboardLoader::KeyboardLoader(QObject *parent)
@@ -416,6 +424,38 @@ QStringList KeyboardLoader::ids() const
     return ids;
 }
 
+//! \brief Starts watching the languages directory and the active layout
+//! file, see layoutFilesChanged().
+//!
+//! Only loaders whose users keep anything derived from layout files, such
+//! as cached key areas, need this. Each watcher costs file descriptors and
+//! inotify watches, so it is not set up by default.
+void KeyboardLoader::watchLayoutFiles()
+{
+    Q_D(KeyboardLoader);
+
+    if (d->watcher) {
+        return;
+    }
+
+    d->watcher.reset(new QFileSystemWatcher);
+
+    const QString languages_dir(getLanguagesDir());
+    if (QDir(languages_dir).exists()) {
+        d->watcher->addPath(languages_dir);
+    }
+
+    const QString active_path(KeyboardLoaderPrivate::layoutPath(d->active_id));
+    if (not d->active_id.isEmpty() && QFile::exists(active_path)) {
+        d->watcher->addPath(active_path);
+    }
+
+    connect(d->watcher.data(), SIGNAL(directoryChanged(QString)),
+            this,              SIGNAL(layoutFilesChanged()));
+    connect(d->watcher.data(), SIGNAL(fileChanged(QString)),
+            this,              SIGNAL(layoutFilesChanged()));
+}
+
 QString KeyboardLoader::activeId() const
 {
     Q_D(const KeyboardLoader);
@@ -427,6 +467,19 @@ void KeyboardLoader::setActiveId(const QString &id)
     Q_D(KeyboardLoader);
 
     if (d->active_id != id) {
+        if (d->watcher) {
+            const QString old_path(KeyboardLoaderPrivate::layoutPath(d->active_id));
+            const QString new_path(KeyboardLoaderPrivate::layoutPath(id));
+
+            if (d->watcher->files().contains(old_path)) {
+                d->watcher->removePath(old_path);
+            }
+
+            if (QFile::exists(new_path)) {
+                d->watcher->addPath(new_path);
+            }
+        }
+
         d->active_id = id;
 
         // FIXME: Emit only after parsing new keyboard.
@@ -616,4 +669,46 @@ Keyboard KeyboardLoader::phoneNumberKeyboard() const
     return getImportedKeyboard(d->active_id, &LayoutParser::phonenumbers, "phonenumber", "phonenumber.xml");
 }
 
+//! \brief Returns the labels of all keys in all views of the active layout,
+//! without duplicates.
+//!
+//! Covers main, shifted, dead key, symbols, number, phone number and extended
+//! keyboards. Parses the layout files many times, so better not use it on
+//! the GUI thread.
+QStringList KeyboardLoader::labels() const
+{
+    QStringList result;
+    QSet<QString> seen;
+    QVector<Keyboard> keyboards;
+
+    const Keyboard main(keyboard());
+    const Keyboard shifted(shiftedKeyboard());
+    keyboards << main << shifted
+              << symbolsKeyboard(0) << symbolsKeyboard(1)
+              << numberKeyboard() << phoneNumberKeyboard();
+
+    Q_FOREACH (const Key &key, main.keys + shifted.keys) {
+        if (key.action() == Key::ActionDead) {
+            keyboards << deadKeyboard(key) << shiftedDeadKeyboard(key);
+        }
+
+        if (key.hasExtendedKeys()) {
+            keyboards << extendedKeyboard(key);
+        }
+    }
+
+    Q_FOREACH (const Keyboard &current, keyboards) {
+        Q_FOREACH (const Key &key, current.keys) {
+            const QString &text(key.label().text());
+
+            if (not text.isEmpty() && not seen.contains(text)) {
+                seen.insert(text);
+                result.append(text);
+            }
+        }
+    }
+
+    return result;
+}
+
 } // namespace MaliitKeyboard
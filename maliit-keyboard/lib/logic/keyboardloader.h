@@ -56,6 +56,7 @@ public:
     virtual QStringList ids() const;
     virtual QString activeId() const;
     virtual void setActiveId(const QString &id);
+    void watchLayoutFiles();
 
     virtual QString title(const QString &id) const;
 
@@ -71,7 +72,10 @@ public:
     virtual Keyboard numberKeyboard() const;
     virtual Keyboard phoneNumberKeyboard() const;
 
+    QStringList labels() const;
+
     Q_SIGNAL void keyboardsChanged() const;
+    Q_SIGNAL void layoutFilesChanged() const;
 
 private:
     const QScopedPointer<KeyboardLoaderPrivate> d_ptr;
@@ -0,0 +1,161 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+#include "labeloverlay.h"
+
+namespace MaliitKeyboard {
+namespace Logic {
+namespace {
+
+bool sameGeometry(const Key &lhs,
+                  const Key &rhs)
+{
+    return (lhs.rect() == rhs.rect()
+            && lhs.margins() == rhs.margins());
+}
+
+} // namespace
+
+//! \class LabelOverlay
+//! Shift and dead key views share the geometry of the main view and only
+//! differ in key labels, icons and sometimes key styles. A LabelOverlay
+//! records those differences, so that a view can be created by patching the
+//! main key area, without going through KeyAreaConverter and the style again.
+
+LabelOverlay::LabelOverlay()
+    : m_rects()
+    , m_indices()
+    , m_faces()
+    , m_valid(false)
+{}
+
+//! \brief Creates an overlay which turns base into variant.
+//!
+//! Returns an invalid overlay if the two key areas differ in geometry.
+//! \param base The key area the overlay will be applied on, usually the main
+//!             view.
+//! \param variant The key area the overlay should produce.
+LabelOverlay LabelOverlay::fromKeyAreas(const KeyArea &base,
+                                        const KeyArea &variant)
+{
+    LabelOverlay overlay;
+
+    const QVector<Key> &base_keys(base.keys());
+    const QVector<Key> &variant_keys(variant.keys());
+
+    if (base.area() != variant.area()
+        || base.origin() != variant.origin()
+        || base_keys.isEmpty()
+        || base_keys.count() != variant_keys.count()) {
+        return overlay;
+    }
+
+    overlay.m_rects.reserve(base_keys.count());
+
+    for (int index = 0; index < base_keys.count(); ++index) {
+        const Key &base_key(base_keys.at(index));
+        const Key &variant_key(variant_keys.at(index));
+
+        if (not sameGeometry(base_key, variant_key)) {
+            return LabelOverlay();
+        }
+
+        overlay.m_rects.append(base_key.rect());
+
+        if (base_key != variant_key
+            || base_key.action() != variant_key.action()
+            || base_key.style() != variant_key.style()
+            || base_key.commandSequence() != variant_key.commandSequence()) {
+            overlay.m_indices.append(index);
+            overlay.m_faces.append(variant_key);
+        }
+    }
+
+    overlay.m_valid = true;
+    return overlay;
+}
+
+bool LabelOverlay::isValid() const
+{
+    return m_valid;
+}
+
+//! \brief Returns the number of keys changed by this overlay.
+int LabelOverlay::count() const
+{
+    return m_indices.count();
+}
+
+//! \brief Checks whether key area has the geometry this overlay was made
+//! for.
+bool LabelOverlay::appliesTo(const KeyArea &key_area) const
+{
+    if (not m_valid) {
+        return false;
+    }
+
+    const QVector<Key> &keys(key_area.keys());
+
+    if (keys.count() != m_rects.count()) {
+        return false;
+    }
+
+    for (int index = 0; index < keys.count(); ++index) {
+        if (keys.at(index).rect() != m_rects.at(index)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//! \brief Returns a copy of key area, with the overlay's keys replaced.
+//!
+//! Check appliesTo() first, key area is returned unchanged otherwise.
+KeyArea LabelOverlay::apply(const KeyArea &key_area) const
+{
+    if (not appliesTo(key_area)) {
+        return key_area;
+    }
+
+    KeyArea result(key_area);
+    QVector<Key> &keys(result.rKeys());
+
+    for (int index = 0; index < m_indices.count(); ++index) {
+        keys[m_indices.at(index)] = m_faces.at(index);
+    }
+
+    result.updateKeyIds();
+    return result;
+}
+
+}} // namespace Logic, MaliitKeyboard
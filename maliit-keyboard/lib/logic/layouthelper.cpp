@@ -30,11 +30,7 @@
  *
  */
 
-#include <algorithm>
-#include <tr1/functional>
-
 #include "layouthelper.h"
-#include "coreutils.h"
 
 namespace MaliitKeyboard {
 namespace Logic {
@@ -60,24 +56,8 @@ bool removeKey(QVector<Key> *keys,
     return false;
 }
 
-struct KeyPredicate
-{
-    KeyPredicate(const QSet<QString> &changed_ids)
-        : m_changed_ids(changed_ids)
-    {}
-
-    bool operator()(Key &key)
-    {
-        return (m_changed_ids.constFind(CoreUtils::idFromKey(key)) != m_changed_ids.constEnd());
-    }
-
-    const QSet<QString> &m_changed_ids;
-};
-
 } // namespace
 
-typedef std::tr1::function<void(const KeyArea &, const KeyOverrides &)> EmitFunc;
-
 class LayoutHelperPrivate
 {
 public:
@@ -109,9 +89,8 @@ public:
 
     KeyArea lookup(LayoutHelper::Panel panel) const;
     QPoint panelOrigin() const;
-    void overrideCheck(const QSet<QString> &changed_ids,
-                       KeyArea &key_area,
-                       const EmitFunc& func);
+    QVector<int> overrideCheck(const QSet<QString> &changed_ids,
+                               const KeyArea &key_area) const;
 };
 
 LayoutHelperPrivate::LayoutHelperPrivate()
@@ -149,16 +128,19 @@ QPoint LayoutHelperPrivate::panelOrigin() const
     return QPoint(0, ribbon.area().size().height());
 }
 
-void LayoutHelperPrivate::overrideCheck(const QSet<QString> &changed_ids,
-                                  KeyArea &key_area,
-                                  const EmitFunc &func)
+// Returns the indices of all keys in key_area that are affected by the
+// changed overrides, using the key id index of the key area.
+QVector<int> LayoutHelperPrivate::overrideCheck(const QSet<QString> &changed_ids,
+                                                const KeyArea &key_area) const
 {
-    QVector<Key> &keys(key_area.rKeys());
-    KeyPredicate predicate(changed_ids);
+    QVector<int> indices;
 
-    if (std::find_if(keys.begin(), keys.end(), predicate) != keys.end()) {
-        func(key_area, overriden_keys);
+    Q_FOREACH (const QString &id, changed_ids) {
+        indices += key_area.keyIndices(id);
     }
+
+    qSort(indices);
+    return indices;
 }
 
 LayoutHelper::LayoutHelper(QObject *parent)
@@ -447,6 +429,13 @@ void LayoutHelper::clearMagnifierKey()
     setMagnifierKey(Key());
 }
 
+//! \brief Stores key overrides and announces the keys affected by them.
+//!
+//! Affected keys are looked up through the key id index of each panel, see
+//! KeyArea::keyIndices(). Only their indices get announced, through
+//! overridenKeysChanged(), instead of whole panels.
+//! \param overriden_keys The key overrides, by key id.
+//! \param update Whether to only update already known overrides.
 void LayoutHelper::onKeysOverriden(const KeyOverrides &overriden_keys,
                              bool update)
 {
@@ -468,13 +457,17 @@ void LayoutHelper::onKeysOverriden(const KeyOverrides &overriden_keys,
         d->overriden_keys = overriden_keys;
     }
 
-    using std::tr1::placeholders::_1;
-    using std::tr1::placeholders::_2;
+    if (changed_ids.isEmpty()) {
+        return;
+    }
+
+    for (int panel = LeftPanel; panel < NumPanels; ++panel) {
+        const QVector<int> &indices(d->overrideCheck(changed_ids, d->lookup(static_cast<Panel>(panel))));
 
-    d->overrideCheck(changed_ids, d->left, std::tr1::bind(&LayoutHelper::leftPanelChanged, this, _1, _2));
-    d->overrideCheck(changed_ids, d->right, std::tr1::bind(&LayoutHelper::rightPanelChanged, this, _1, _2));
-    d->overrideCheck(changed_ids, d->center, std::tr1::bind(&LayoutHelper::centerPanelChanged, this, _1, _2));
-    d->overrideCheck(changed_ids, d->extended, std::tr1::bind(&LayoutHelper::extendedPanelChanged, this, _1, _2));
+        if (not indices.isEmpty()) {
+            Q_EMIT overridenKeysChanged(static_cast<Panel>(panel), indices, d->overriden_keys);
+        }
+    }
 }
 
 }} // namespace Logic, MaliitKeyboard
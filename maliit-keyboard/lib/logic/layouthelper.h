@@ -42,7 +42,7 @@
 namespace MaliitKeyboard {
 namespace Logic {
 
-typedef QMap<QString, Key> KeyOverrides;
+typedef MaliitKeyboard::KeyOverrides KeyOverrides;
 
 class LayoutHelperPrivate;
 
@@ -143,6 +143,9 @@ public:
 
     Q_SLOT void onKeysOverriden(const Logic::KeyOverrides &overriden_keys,
                                 bool update);
+    Q_SIGNAL void overridenKeysChanged(Logic::LayoutHelper::Panel panel,
+                                       const QVector<int> &indices,
+                                       const Logic::KeyOverrides &overrides);
 
 private:
     const QScopedPointer<LayoutHelperPrivate> d_ptr;
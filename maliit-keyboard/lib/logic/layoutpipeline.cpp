@@ -0,0 +1,484 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "layoutpipeline.h"
+
+#include "models/styleattributes.h"
+#include "logic/style.h"
+#include "logic/keyboardloader.h"
+#include "logic/keyareaconverter.h"
+#include "logic/keyareacache.h"
+
+namespace MaliitKeyboard {
+namespace Logic {
+
+//! \class LayoutPipeline
+//! Loads language layouts and converts them into key areas on a worker
+//! thread. The worker uses its own keyboard loader and its own style
+//! attributes, so no mutable state is shared with the GUI thread. Finished
+//! key areas are delivered through keyAreaLoaded(). Only the most recent
+//! request gets delivered; older requests are dropped, either before they
+//! are processed or before their result is posted.
+
+namespace {
+
+//! \brief Requests shared between the GUI thread and the worker.
+struct RequestQueue
+{
+    QMutex mutex;
+    LayoutPipeline::Request pending;
+    bool has_pending;
+    QAtomicInt latest_serial;
+
+    explicit RequestQueue()
+        : mutex()
+        , pending()
+        , has_pending(false)
+        , latest_serial(0)
+    {}
+
+    bool isSuperseded(int serial) const
+    {
+        return (serial != latest_serial.load());
+    }
+};
+
+} // unnamed namespace
+
+class LayoutPipelineWorker
+    : public QObject
+{
+    Q_OBJECT
+
+private:
+    RequestQueue *const m_queue;
+    QScopedPointer<Style> m_style;
+    QScopedPointer<KeyboardLoader> m_loader;
+    KeyAreaCache m_cache;
+
+public:
+    explicit LayoutPipelineWorker(RequestQueue *queue)
+        : QObject()
+        , m_queue(queue)
+        , m_style()
+        , m_loader()
+        , m_cache()
+    {}
+
+    // Created lazily, to make sure they live in the worker thread:
+    void init()
+    {
+        if (m_style.isNull()) {
+            m_style.reset(new Style);
+            m_loader.reset(new KeyboardLoader);
+            m_loader->watchLayoutFiles();
+
+            connect(m_loader.data(), SIGNAL(layoutFilesChanged()),
+                    this,            SLOT(clearCache()),
+                    Qt::UniqueConnection);
+        }
+    }
+
+    // Activates the keyboard and style profile a request is for:
+    void activate(const QString &keyboard_id,
+                  const QString &style_profile)
+    {
+        init();
+
+        if (m_style->profile() != style_profile) {
+            m_style->setProfile(style_profile);
+            m_cache.clear();
+        }
+
+        m_loader->setActiveId(keyboard_id);
+    }
+
+    KeyArea convert(const LayoutPipeline::Request &request)
+    {
+        activate(request.keyboard_id, request.style_profile);
+
+        KeyAreaConverter converter(m_style->attributes(), m_loader.data(), &m_cache);
+        converter.setLayoutOrientation(request.orientation);
+
+        switch (request.view) {
+        case LayoutPipeline::MainView:
+            return converter.keyArea();
+
+        case LayoutPipeline::ShiftedView:
+            return converter.shiftedKeyArea();
+
+        case LayoutPipeline::SymbolsView:
+            return converter.symbolsKeyArea(request.page);
+
+        case LayoutPipeline::DeadkeyView:
+            return converter.deadKeyArea(request.dead_key);
+
+        case LayoutPipeline::ShiftedDeadkeyView:
+            return converter.shiftedDeadKeyArea(request.dead_key);
+
+        case LayoutPipeline::NumberView:
+            return converter.numberKeyArea();
+
+        case LayoutPipeline::PhoneNumberView:
+            return converter.phoneNumberKeyArea();
+        }
+
+        return KeyArea();
+    }
+
+    //! \brief Processes the pending request, if any. Runs on the worker thread.
+    Q_SLOT void process()
+    {
+        LayoutPipeline::Request request;
+
+        {
+            QMutexLocker lock(&m_queue->mutex);
+
+            if (not m_queue->has_pending) {
+                return;
+            }
+
+            request = m_queue->pending;
+            m_queue->has_pending = false;
+        }
+
+        if (m_queue->isSuperseded(request.serial)) {
+            return;
+        }
+
+        const KeyArea key_area(convert(request));
+
+        // No need to post results nobody is waiting for:
+        if (m_queue->isSuperseded(request.serial)) {
+            return;
+        }
+
+        Q_EMIT keyAreaConverted(request.serial, key_area,
+                                m_style->attributes()->styleName());
+    }
+
+    //! \brief Converts a key area ahead of its use. Runs on the worker
+    //! thread, and is never superseded.
+    Q_SLOT void prepare(const QString &keyboard_id,
+                        const QString &style_profile,
+                        int orientation,
+                        int view,
+                        int page)
+    {
+        LayoutPipeline::Request request;
+        request.keyboard_id = keyboard_id;
+        request.style_profile = style_profile;
+        request.orientation = static_cast<LayoutHelper::Orientation>(orientation);
+        request.view = static_cast<LayoutPipeline::View>(view);
+        request.page = page;
+
+        const KeyArea key_area(convert(request));
+        Q_EMIT keyAreaPrepared(keyboard_id, style_profile, orientation, view, page,
+                               key_area, m_style->attributes()->styleName());
+    }
+
+    //! \brief Converts extended key areas ahead of their use. Runs on the
+    //! worker thread, and is never superseded.
+    Q_SLOT void prepareExtendedKeys(const QString &keyboard_id,
+                                    const QString &style_profile,
+                                    int orientation,
+                                    const QStringList &labels)
+    {
+        activate(keyboard_id, style_profile);
+
+        StyleAttributes *const attributes(m_style->extendedKeysAttributes());
+        KeyAreaConverter converter(attributes, m_loader.data(), &m_cache);
+        converter.setLayoutOrientation(static_cast<LayoutHelper::Orientation>(orientation));
+
+        Q_FOREACH (const QString &label, labels) {
+            Key key;
+            key.rLabel().setText(label);
+
+            const KeyArea key_area(converter.extendedKeyArea(key));
+            Q_EMIT extendedKeyAreaPrepared(keyboard_id, style_profile, orientation, label,
+                                           key_area, attributes->styleName());
+        }
+    }
+
+    //! \brief Collects all labels of a layout. Runs on the worker thread.
+    Q_SLOT void collectLabels(const QString &keyboard_id)
+    {
+        init();
+        m_loader->setActiveId(keyboard_id);
+
+        Q_EMIT labelsCollected(keyboard_id, m_loader->labels());
+    }
+
+    Q_SLOT void clearCache()
+    {
+        m_cache.clear();
+    }
+
+    Q_SIGNAL void labelsCollected(const QString &keyboard_id,
+                                  const QStringList &labels);
+
+    Q_SIGNAL void keyAreaPrepared(const QString &keyboard_id,
+                                  const QString &style_profile,
+                                  int orientation,
+                                  int view,
+                                  int page,
+                                  const MaliitKeyboard::KeyArea &key_area,
+                                  const QString &style_name);
+
+    Q_SIGNAL void extendedKeyAreaPrepared(const QString &keyboard_id,
+                                          const QString &style_profile,
+                                          int orientation,
+                                          const QString &label,
+                                          const MaliitKeyboard::KeyArea &key_area,
+                                          const QString &style_name);
+
+    Q_SIGNAL void keyAreaConverted(int serial,
+                                   const MaliitKeyboard::KeyArea &key_area,
+                                   const QString &style_name);
+};
+
+
+LayoutPipeline::Request::Request()
+    : serial(0)
+    , keyboard_id()
+    , style_profile()
+    , orientation(LayoutHelper::Landscape)
+    , view(MainView)
+    , page(0)
+    , dead_key()
+{}
+
+
+class LayoutPipelinePrivate
+{
+public:
+    RequestQueue queue;
+    QThread thread;
+    LayoutPipelineWorker *worker;
+    int next_serial;
+    bool pending;
+
+    explicit LayoutPipelinePrivate()
+        : queue()
+        , thread()
+        , worker(new LayoutPipelineWorker(&queue))
+        , next_serial(0)
+        , pending(false)
+    {}
+};
+
+
+//! \param parent The owner of this instance (optional).
+LayoutPipeline::LayoutPipeline(QObject *parent)
+    : QObject(parent)
+    , d_ptr(new LayoutPipelinePrivate)
+{
+    Q_D(LayoutPipeline);
+
+    qRegisterMetaType<MaliitKeyboard::KeyArea>("MaliitKeyboard::KeyArea");
+
+    d->worker->moveToThread(&d->thread);
+
+    connect(&d->thread, SIGNAL(finished()),
+            d->worker,  SLOT(deleteLater()));
+    connect(d->worker, SIGNAL(keyAreaConverted(int, MaliitKeyboard::KeyArea, QString)),
+            this,      SLOT(onKeyAreaConverted(int, MaliitKeyboard::KeyArea, QString)),
+            Qt::QueuedConnection);
+    connect(d->worker, SIGNAL(labelsCollected(QString, QStringList)),
+            this,      SIGNAL(labelsLoaded(QString, QStringList)),
+            Qt::QueuedConnection);
+    connect(d->worker, SIGNAL(keyAreaPrepared(QString, QString, int, int, int, MaliitKeyboard::KeyArea, QString)),
+            this,      SIGNAL(keyAreaPrepared(QString, QString, int, int, int, MaliitKeyboard::KeyArea, QString)),
+            Qt::QueuedConnection);
+    connect(d->worker, SIGNAL(extendedKeyAreaPrepared(QString, QString, int, QString, MaliitKeyboard::KeyArea, QString)),
+            this,      SIGNAL(extendedKeyAreaPrepared(QString, QString, int, QString, MaliitKeyboard::KeyArea, QString)),
+            Qt::QueuedConnection);
+
+    d->thread.start(QThread::LowPriority);
+}
+
+
+LayoutPipeline::~LayoutPipeline()
+{
+    Q_D(LayoutPipeline);
+
+    cancel();
+    d->thread.quit();
+    d->thread.wait();
+}
+
+
+//! \brief Requests a key area. Supersedes all previous requests.
+//! \param keyboard_id The language layout id.
+//! \param style_profile The style profile used for conversion.
+//! \param orientation The layout orientation.
+//! \param view The key area to create.
+//! \param page The symbols page, only used for symbols views (optional).
+//! \param dead_key The dead key, only used for dead key views (optional).
+//! \returns The serial of the request, as passed to keyAreaLoaded().
+int LayoutPipeline::request(const QString &keyboard_id,
+                            const QString &style_profile,
+                            LayoutHelper::Orientation orientation,
+                            View view,
+                            int page,
+                            const Key &dead_key)
+{
+    Q_D(LayoutPipeline);
+
+    Request request;
+    request.serial = ++d->next_serial;
+    request.keyboard_id = keyboard_id;
+    request.style_profile = style_profile;
+    request.orientation = orientation;
+    request.view = view;
+    request.page = page;
+    request.dead_key = dead_key;
+
+    {
+        QMutexLocker lock(&d->queue.mutex);
+        d->queue.pending = request;
+        d->queue.has_pending = true;
+        d->queue.latest_serial.store(request.serial);
+    }
+
+    d->pending = true;
+    QMetaObject::invokeMethod(d->worker, "process", Qt::QueuedConnection);
+
+    return request.serial;
+}
+
+
+//! \brief Requests all key labels of a layout, in all of its views.
+//!
+//! Independent of key area requests. Results are delivered through
+//! labelsLoaded().
+//! \param keyboard_id The language layout id.
+void LayoutPipeline::requestLabels(const QString &keyboard_id)
+{
+    Q_D(LayoutPipeline);
+    QMetaObject::invokeMethod(d->worker, "collectLabels", Qt::QueuedConnection,
+                              Q_ARG(QString, keyboard_id));
+}
+
+
+//! \brief Converts a key area in the background, for example for the
+//! orientation that is not shown. Unlike request(), does not supersede
+//! other requests, and is not superseded by them. Results are delivered
+//! through keyAreaPrepared().
+//! \param keyboard_id The language layout id.
+//! \param style_profile The style profile used for conversion.
+//! \param orientation The layout orientation.
+//! \param view The key area to create. Dead key views are not supported.
+//! \param page The symbols page, only used for symbols views (optional).
+void LayoutPipeline::prepare(const QString &keyboard_id,
+                             const QString &style_profile,
+                             LayoutHelper::Orientation orientation,
+                             View view,
+                             int page)
+{
+    Q_D(LayoutPipeline);
+    QMetaObject::invokeMethod(d->worker, "prepare", Qt::QueuedConnection,
+                              Q_ARG(QString, keyboard_id),
+                              Q_ARG(QString, style_profile),
+                              Q_ARG(int, orientation),
+                              Q_ARG(int, view),
+                              Q_ARG(int, page));
+}
+
+
+//! \brief Converts extended key areas in the background, ahead of their
+//! first long press. Like prepare(), independent of other requests. Results
+//! are delivered through extendedKeyAreaPrepared(), one per label.
+//! \param keyboard_id The language layout id.
+//! \param style_profile The style profile used for conversion.
+//! \param orientation The layout orientation.
+//! \param labels Labels of the keys whose extended key areas to convert.
+void LayoutPipeline::prepareExtendedKeys(const QString &keyboard_id,
+                                         const QString &style_profile,
+                                         LayoutHelper::Orientation orientation,
+                                         const QStringList &labels)
+{
+    Q_D(LayoutPipeline);
+    QMetaObject::invokeMethod(d->worker, "prepareExtendedKeys", Qt::QueuedConnection,
+                              Q_ARG(QString, keyboard_id),
+                              Q_ARG(QString, style_profile),
+                              Q_ARG(int, orientation),
+                              Q_ARG(QStringList, labels));
+}
+
+
+//! \brief Cancels all requests. No key area is delivered until the next
+//! request.
+void LayoutPipeline::cancel()
+{
+    Q_D(LayoutPipeline);
+
+    QMutexLocker lock(&d->queue.mutex);
+    d->queue.has_pending = false;
+    d->queue.latest_serial.store(++d->next_serial);
+    d->pending = false;
+}
+
+
+//! \brief Drops the key areas cached by the worker, to release memory.
+void LayoutPipeline::clearCache()
+{
+    Q_D(LayoutPipeline);
+    QMetaObject::invokeMethod(d->worker, "clearCache", Qt::QueuedConnection);
+}
+
+
+//! \brief Returns whether a requested key area has not been delivered yet.
+bool LayoutPipeline::isPending() const
+{
+    Q_D(const LayoutPipeline);
+    return d->pending;
+}
+
+
+void LayoutPipeline::onKeyAreaConverted(int serial,
+                                        const KeyArea &key_area,
+                                        const QString &style_name)
+{
+    Q_D(LayoutPipeline);
+
+    // Results can still be in the event queue when a newer request comes in:
+    if (d->queue.isSuperseded(serial)) {
+        return;
+    }
+
+    d->pending = false;
+    Q_EMIT keyAreaLoaded(serial, key_area, style_name);
+}
+
+}} // namespace Logic, MaliitKeyboard
+
+#include "layoutpipeline.moc"
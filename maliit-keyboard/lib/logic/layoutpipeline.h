@@ -0,0 +1,130 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef MALIIT_KEYBOARD_LAYOUTPIPELINE_H
+#define MALIIT_KEYBOARD_LAYOUTPIPELINE_H
+
+#include "models/key.h"
+#include "models/keyarea.h"
+#include "logic/layouthelper.h"
+
+#include <QtCore>
+
+namespace MaliitKeyboard {
+namespace Logic {
+
+class LayoutPipelinePrivate;
+
+class LayoutPipeline
+    : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(LayoutPipeline)
+    Q_DECLARE_PRIVATE(LayoutPipeline)
+
+public:
+    enum View {
+        MainView, //!< Main key area.
+        ShiftedView, //!< Main key area, with shift bindings.
+        SymbolsView, //!< Symbols key area, see Request::page.
+        DeadkeyView, //!< Main key area, with dead key bindings of Request::dead_key.
+        ShiftedDeadkeyView, //!< Same as DeadkeyView, but with shift bindings.
+        NumberView, //!< Number key area.
+        PhoneNumberView //!< Phone number key area.
+    };
+
+    struct Request
+    {
+        int serial;
+        QString keyboard_id;
+        QString style_profile;
+        LayoutHelper::Orientation orientation;
+        View view;
+        int page;
+        Key dead_key;
+
+        explicit Request();
+    };
+
+    explicit LayoutPipeline(QObject *parent = 0);
+    virtual ~LayoutPipeline();
+
+    int request(const QString &keyboard_id,
+                const QString &style_profile,
+                LayoutHelper::Orientation orientation,
+                View view,
+                int page = 0,
+                const Key &dead_key = Key());
+    void cancel();
+    bool isPending() const;
+    void clearCache();
+
+    void requestLabels(const QString &keyboard_id);
+    void prepare(const QString &keyboard_id,
+                 const QString &style_profile,
+                 LayoutHelper::Orientation orientation,
+                 View view,
+                 int page = 0);
+    void prepareExtendedKeys(const QString &keyboard_id,
+                             const QString &style_profile,
+                             LayoutHelper::Orientation orientation,
+                             const QStringList &labels);
+
+    Q_SIGNAL void keyAreaLoaded(int serial,
+                                const MaliitKeyboard::KeyArea &key_area,
+                                const QString &style_name);
+    Q_SIGNAL void labelsLoaded(const QString &keyboard_id,
+                               const QStringList &labels);
+    Q_SIGNAL void keyAreaPrepared(const QString &keyboard_id,
+                                  const QString &style_profile,
+                                  int orientation,
+                                  int view,
+                                  int page,
+                                  const MaliitKeyboard::KeyArea &key_area,
+                                  const QString &style_name);
+    Q_SIGNAL void extendedKeyAreaPrepared(const QString &keyboard_id,
+                                          const QString &style_profile,
+                                          int orientation,
+                                          const QString &label,
+                                          const MaliitKeyboard::KeyArea &key_area,
+                                          const QString &style_name);
+
+private:
+    Q_SLOT void onKeyAreaConverted(int serial,
+                                   const MaliitKeyboard::KeyArea &key_area,
+                                   const QString &style_name);
+
+    const QScopedPointer<LayoutPipelinePrivate> d_ptr;
+};
+
+}} // namespace Logic, MaliitKeyboard
+
+#endif // MALIIT_KEYBOARD_LAYOUTPIPELINE_H
@@ -32,6 +32,7 @@
 
 #include "layoutupdater.h"
 #include "style.h"
+#include "tracing.h"
 
 #include "models/area.h"
 #include "models/keyboard.h"
@@ -42,6 +43,9 @@
 #include "models/styleattributes.h"
 
 #include "logic/keyareaconverter.h"
+#include "logic/keyareacache.h"
+#include "logic/labeloverlay.h"
+#include "logic/layoutpipeline.h"
 #include "logic/state-machines/shiftmachine.h"
 #include "logic/state-machines/viewmachine.h"
 #include "logic/state-machines/deadkeymachine.h"
@@ -54,15 +58,32 @@ enum ActivationPolicy {
     DeactivateElement
 };
 
+// A key area converted ahead of its use, together with the style name it was
+// converted with:
+struct PreparedKeyArea
+{
+    KeyArea key_area;
+    QString style_name;
+};
+
 Key modifyKey(const Key &key,
               KeyDescription::State state,
               const StyleAttributes *attributes)
 {
+    // Keys created by KeyAreaConverter carry their state backgrounds
+    // already, no need to consult the style again:
+    if (key.hasStateBackgrounds()) {
+        Key k(key);
+        k.setState(state);
+        return k;
+    }
+
     if (not attributes) {
         return key;
     }
 
     Key k(key);
+    k.setState(state);
 
     k.rArea().setBackground(attributes->keyBackground(key.style(), state));
     k.rArea().setBackgroundBorders(attributes->keyBackgroundBorders());
@@ -70,6 +91,19 @@ Key modifyKey(const Key &key,
     return k;
 }
 
+void appendPressedKey(LayoutHelper *layout,
+                      const Key &key,
+                      const StyleAttributes *attributes)
+{
+    // Keys handed over by EventHandler usually are in pressed state already:
+    if (key.hasStateBackgrounds() && key.state() == KeyDescription::PressedState) {
+        layout->appendActiveKey(key);
+        return;
+    }
+
+    layout->appendActiveKey(modifyKey(key, KeyDescription::PressedState, attributes));
+}
+
 void applyStyleToCandidate(WordCandidate *candidate,
                            const StyleAttributes *attributes,
                            LayoutHelper::Orientation orientation,
@@ -205,46 +239,104 @@ Key magnifyKey(const Key &key,
     return magnifier;
 }
 
+namespace {
+
+// Room for the extended keys of a layout, in both shift states and
+// orientations:
+const int g_extended_key_area_cache_capacity = 128;
+
+} // unnamed namespace
+
 class LayoutUpdaterPrivate
 {
 public:
     bool initialized;
     LayoutHelper *layout;
     KeyboardLoader loader;
+    KeyAreaCache key_area_cache;
+    KeyAreaCache extended_key_area_cache;
+    QScopedPointer<LayoutPipeline> pipeline;
+    bool asynchronous_loading;
     ShiftMachine shift_machine;
     ViewMachine view_machine;
     DeadkeyMachine deadkey_machine;
     SharedStyle style;
     bool word_ribbon_visible;
     LayoutHelper::Panel close_extended_on_release;
+    bool rebuild_scheduled;
+    LayoutPipeline::View rebuild_view;
+    int rebuild_page;
+    Key rebuild_dead_key;
+    int rebuild_count;
+    int coalesced_rebuild_count;
+    int overlaid_rebuild_count;
+    int prepared_rebuild_count;
+    int pending_serial;
+    LayoutHelper::Orientation pending_orientation;
+    LayoutPipeline::View pending_view;
+    int pending_page;
+    Key pending_dead_key;
+    KeyArea overlay_base;
+    QString overlay_base_style_name;
+    QHash<QString, LabelOverlay> overlays;
+    QString prepared_source;
+    QHash<QString, PreparedKeyArea> prepared;
+    bool extended_warmup_enabled;
+    QString extended_warmup_source;
+    QSet<QString> extended_warmup_labels;
 
     explicit LayoutUpdaterPrivate()
         : initialized(false)
         , layout(0)
         , loader()
+        , key_area_cache()
+        , extended_key_area_cache(g_extended_key_area_cache_capacity)
+        , pipeline()
+        , asynchronous_loading(false)
         , shift_machine()
         , view_machine()
         , deadkey_machine()
         , style()
         , word_ribbon_visible(false)
         , close_extended_on_release(LayoutHelper::NumPanels) // NumPanels counts as invalid panel.
+        , rebuild_scheduled(false)
+        , rebuild_view(LayoutPipeline::MainView)
+        , rebuild_page(0)
+        , rebuild_dead_key()
+        , rebuild_count(0)
+        , coalesced_rebuild_count(0)
+        , overlaid_rebuild_count(0)
+        , prepared_rebuild_count(0)
+        , pending_serial(-1)
+        , pending_orientation(LayoutHelper::Landscape)
+        , pending_view(LayoutPipeline::MainView)
+        , pending_page(0)
+        , pending_dead_key()
+        , overlay_base()
+        , overlay_base_style_name()
+        , overlays()
+        , prepared_source()
+        , prepared()
+        , extended_warmup_enabled(false)
+        , extended_warmup_source()
+        , extended_warmup_labels()
     {}
 
     bool inShiftedState() const
     {
-        return (shift_machine.inState(ShiftMachine::shift_state) or
-                shift_machine.inState(ShiftMachine::caps_lock_state) or
-                shift_machine.inState(ShiftMachine::latched_shift_state));
+        return (shift_machine.inState(ShiftMachine::ShiftState) or
+                shift_machine.inState(ShiftMachine::CapsLockState) or
+                shift_machine.inState(ShiftMachine::LatchedShiftState));
     }
 
     bool arePrimarySymbolsShown() const
     {
-        return view_machine.inState(ViewMachine::symbols0_state);
+        return view_machine.inState(ViewMachine::Symbols0State);
     }
 
     bool areSecondarySymbolsShown() const
     {
-        return view_machine.inState(ViewMachine::symbols1_state);
+        return view_machine.inState(ViewMachine::Symbols1State);
     }
 
     bool areSymbolsShown() const
@@ -254,8 +346,18 @@ public:
 
     bool inDeadkeyState() const
     {
-        return (deadkey_machine.inState(DeadkeyMachine::deadkey_state) or
-                deadkey_machine.inState(DeadkeyMachine::latched_deadkey_state));
+        return (deadkey_machine.inState(DeadkeyMachine::DeadkeyState) or
+                deadkey_machine.inState(DeadkeyMachine::LatchedDeadkeyState));
+    }
+
+    // Identifies the view that the state machines currently ask for.
+    int requestedView() const
+    {
+        if (areSymbolsShown()) {
+            return (arePrimarySymbolsShown() ? -1 : -2);
+        }
+
+        return ((inShiftedState() ? 1 : 0) | (inDeadkeyState() ? 2 : 0));
     }
 
     const StyleAttributes * activeStyleAttributes() const
@@ -263,15 +365,243 @@ public:
         return (layout->activePanel() == LayoutHelper::ExtendedPanel
                 ? style->extendedKeysAttributes() : style->attributes());
     }
+
+    static bool isOverlayView(LayoutPipeline::View view)
+    {
+        return (view == LayoutPipeline::ShiftedView
+                || view == LayoutPipeline::DeadkeyView
+                || view == LayoutPipeline::ShiftedDeadkeyView);
+    }
+
+    static QString overlayId(LayoutPipeline::View view,
+                             const Key &dead_key)
+    {
+        return QString("%1:%2").arg(view).arg(dead_key.label().text());
+    }
+
+    void resetOverlays()
+    {
+        overlay_base = KeyArea();
+        overlay_base_style_name.clear();
+        overlays.clear();
+    }
+
+    static bool isPreparableView(LayoutPipeline::View view)
+    {
+        return (view == LayoutPipeline::MainView
+                || view == LayoutPipeline::ShiftedView
+                || view == LayoutPipeline::SymbolsView);
+    }
+
+    static QString preparedId(LayoutHelper::Orientation orientation,
+                              LayoutPipeline::View view,
+                              int page)
+    {
+        return QString("%1:%2:%3").arg(orientation).arg(view).arg(page);
+    }
+
+    // Prepared key areas are only valid for one keyboard and style profile:
+    QString preparedSource() const
+    {
+        return QString("%1:%2").arg(loader.activeId()).arg(style->profile());
+    }
+
+    void resetPrepared()
+    {
+        prepared_source.clear();
+        prepared.clear();
+    }
+
+    void storePrepared(LayoutHelper::Orientation orientation,
+                       LayoutPipeline::View view,
+                       int page,
+                       const KeyArea &key_area,
+                       const QString &style_name)
+    {
+        if (not isPreparableView(view) || not key_area.hasKeys()) {
+            return;
+        }
+
+        const QString source(preparedSource());
+
+        if (prepared_source != source) {
+            prepared.clear();
+            prepared_source = source;
+        }
+
+        PreparedKeyArea entry;
+        entry.key_area = key_area;
+        entry.style_name = style_name;
+        prepared.insert(preparedId(orientation, view, page), entry);
+    }
+
+    bool preparedKeyArea(LayoutHelper::Orientation orientation,
+                         LayoutPipeline::View view,
+                         int page,
+                         KeyArea *key_area,
+                         QString *style_name = 0) const
+    {
+        if (not key_area || not isPreparableView(view)
+            || prepared_source != preparedSource()) {
+            return false;
+        }
+
+        const QHash<QString, PreparedKeyArea>::const_iterator it(prepared.find(preparedId(orientation, view, page)));
+
+        if (it == prepared.end()) {
+            return false;
+        }
+
+        *key_area = it->key_area;
+
+        if (style_name) {
+            *style_name = it->style_name;
+        }
+
+        return true;
+    }
+
+    // Asks the pipeline for the key areas a rotation would need, that is,
+    // the given view (and its shifted variant) in the other orientation:
+    void prepareOtherOrientation(LayoutHelper::Orientation orientation,
+                                 LayoutPipeline::View view,
+                                 int page)
+    {
+        if (not asynchronous_loading || not isPreparableView(view)) {
+            return;
+        }
+
+        const LayoutHelper::Orientation other(orientation == LayoutHelper::Landscape
+                                              ? LayoutHelper::Portrait : LayoutHelper::Landscape);
+        QList<LayoutPipeline::View> views;
+
+        if (view == LayoutPipeline::SymbolsView) {
+            views.append(view);
+        } else {
+            views.append(LayoutPipeline::MainView);
+            views.append(LayoutPipeline::ShiftedView);
+        }
+
+        KeyArea unused;
+
+        Q_FOREACH (LayoutPipeline::View v, views) {
+            if (not preparedKeyArea(other, v, page, &unused)) {
+                pipeline->prepare(loader.activeId(), style->profile(), other, v, page);
+            }
+        }
+    }
+
+    // Extended key areas get their own cache, so that long presses on many
+    // different keys do not evict the center panel views:
+    KeyArea extendedKeyArea(const Key &key,
+                            LayoutHelper::Orientation orientation)
+    {
+        KeyAreaConverter converter(style->extendedKeysAttributes(), &loader, &extended_key_area_cache);
+        converter.setLayoutOrientation(orientation);
+        return converter.extendedKeyArea(key);
+    }
+
+    // Returns labels of keys in key_area whose extended key areas were not
+    // warmed up yet, and marks them as warmed up:
+    QStringList takeExtendedWarmupLabels(const KeyArea &key_area,
+                                         LayoutHelper::Orientation orientation)
+    {
+        const QString source(QString("%1:%2").arg(preparedSource()).arg(orientation));
+
+        if (extended_warmup_source != source) {
+            extended_warmup_labels.clear();
+            extended_warmup_source = source;
+        }
+
+        QStringList labels;
+
+        Q_FOREACH (const Key &key, key_area.keys()) {
+            const QString &text(key.label().text());
+
+            if (key.hasExtendedKeys() && key.action() != Key::ActionSpace
+                && not text.isEmpty() && not extended_warmup_labels.contains(text)) {
+                extended_warmup_labels.insert(text);
+                labels.append(text);
+            }
+        }
+
+        return labels;
+    }
+
+    void resetExtendedWarmup()
+    {
+        extended_warmup_source.clear();
+        extended_warmup_labels.clear();
+    }
+
+    // Remembers the main view, and how other views differ from it:
+    void recordKeyArea(LayoutPipeline::View view,
+                       const Key &dead_key,
+                       const KeyArea &key_area,
+                       const QString &style_name)
+    {
+        if (view == LayoutPipeline::MainView) {
+            overlay_base_style_name = style_name;
+
+            if (overlay_base != key_area) {
+                overlay_base = key_area;
+                overlays.clear();
+            }
+        } else if (isOverlayView(view) && overlay_base.hasKeys()) {
+            const LabelOverlay overlay(LabelOverlay::fromKeyAreas(overlay_base, key_area));
+
+            if (overlay.isValid()) {
+                overlays.insert(overlayId(view, dead_key), overlay);
+            }
+        }
+    }
+
+    // Overlaid views share the style name of their main view:
+    bool overlaidKeyArea(LayoutPipeline::View view,
+                         const Key &dead_key,
+                         KeyArea *key_area,
+                         QString *style_name = 0) const
+    {
+        if (not key_area || not overlay_base.hasKeys()) {
+            return false;
+        }
+
+        if (style_name) {
+            *style_name = overlay_base_style_name;
+        }
+
+        if (view == LayoutPipeline::MainView) {
+            *key_area = overlay_base;
+            return true;
+        }
+
+        if (not isOverlayView(view)) {
+            return false;
+        }
+
+        const QHash<QString, LabelOverlay>::const_iterator it(overlays.find(overlayId(view, dead_key)));
+
+        if (it == overlays.end() || not it->appliesTo(overlay_base)) {
+            return false;
+        }
+
+        *key_area = it->apply(overlay_base);
+        return true;
+    }
 };
 
 LayoutUpdater::LayoutUpdater(QObject *parent)
     : QObject(parent)
     , d_ptr(new LayoutUpdaterPrivate)
 {
+    d_ptr->loader.watchLayoutFiles();
+
     connect(&d_ptr->loader, SIGNAL(keyboardsChanged()),
             this,           SLOT(onKeyboardsChanged()),
             Qt::UniqueConnection);
+    connect(&d_ptr->loader, SIGNAL(layoutFilesChanged()),
+            this,           SLOT(clearKeyAreaCache()),
+            Qt::UniqueConnection);
 }
 
 LayoutUpdater::~LayoutUpdater()
@@ -281,9 +611,10 @@ void LayoutUpdater::init()
 {
     Q_D(LayoutUpdater);
 
-    d->shift_machine.setup(this);
-    d->view_machine.setup(this);
-    d->deadkey_machine.setup(this);
+    d->shift_machine.restart();
+    d->view_machine.restart();
+    d->deadkey_machine.restart();
+    syncLayoutToView();
 }
 
 QStringList LayoutUpdater::keyboardIds() const
@@ -327,11 +658,9 @@ void LayoutUpdater::setOrientation(LayoutHelper::Orientation orientation)
 
     if (d->layout && d->style && d->layout->orientation() != orientation) {
         d->layout->setOrientation(orientation);
-
-        KeyAreaConverter converter(d->style->attributes(), &d->loader);
-        converter.setLayoutOrientation(orientation);
-        d->layout->setCenterPanel(d->inShiftedState() ? converter.shiftedKeyArea()
-                                                      : converter.keyArea());
+        d->resetOverlays();
+        loadCenterPanel(d->inShiftedState() ? LayoutPipeline::ShiftedView
+                                            : LayoutPipeline::MainView);
 
         if (isWordRibbonVisible()) {
             WordRibbon ribbon(d->layout->wordRibbon());
@@ -346,7 +675,27 @@ void LayoutUpdater::setOrientation(LayoutHelper::Orientation orientation)
 void LayoutUpdater::setStyle(const SharedStyle &style)
 {
     Q_D(LayoutUpdater);
+
+    if (d->style == style) {
+        return;
+    }
+
+    if (d->style) {
+        disconnect(d->style.data(), SIGNAL(profileChanged()),
+                   this,            SLOT(clearKeyAreaCache()));
+    }
+
     d->style = style;
+    clearKeyAreaCache();
+
+    if (d->style) {
+        connect(d->style.data(), SIGNAL(profileChanged()),
+                this,            SLOT(clearKeyAreaCache()),
+                Qt::UniqueConnection);
+
+        // Also shows the initial view, if the layout was set before the style:
+        syncLayoutToView();
+    }
 }
 
 bool LayoutUpdater::isWordRibbonVisible() const
@@ -391,14 +740,15 @@ Key LayoutUpdater::modifyKey(const Key &key,
 
 void LayoutUpdater::onKeyPressed(const Key &key)
 {
+    MALIIT_TRACE_SCOPE("LayoutUpdater::onKeyPressed");
+
     Q_D(LayoutUpdater);
 
     if (not d->layout) {
         return;
     }
 
-    d->layout->appendActiveKey(MaliitKeyboard::Logic::modifyKey(key, KeyDescription::PressedState,
-                                                                d->activeStyleAttributes()));
+    appendPressedKey(d->layout, key, d->activeStyleAttributes());
 
     if (d->layout->activePanel() == LayoutHelper::CenterPanel) {
         d->layout->setMagnifierKey(magnifyKey(key, d->activeStyleAttributes(), d->layout->orientation(),
@@ -407,12 +757,12 @@ void LayoutUpdater::onKeyPressed(const Key &key)
 
     switch (key.action()) {
     case Key::ActionShift:
-        Q_EMIT shiftPressed();
+        processEvent(&d->shift_machine, ShiftMachine::ShiftPressed);
         break;
 
     case Key::ActionDead:
         d->deadkey_machine.setAccentKey(key);
-        Q_EMIT deadkeyPressed();
+        processEvent(&d->deadkey_machine, DeadkeyMachine::DeadkeyPressed);
         break;
 
     default:
@@ -434,9 +784,7 @@ void LayoutUpdater::onKeyLongPressed(const Key &key)
     const LayoutHelper::Orientation orientation(d->layout->orientation());
     StyleAttributes * const extended_attributes(d->style->extendedKeysAttributes());
     const qreal vertical_offset(d->style->attributes()->verticalOffset(orientation));
-    KeyAreaConverter converter(extended_attributes, &d->loader);
-    converter.setLayoutOrientation(orientation);
-    KeyArea ext_ka(converter.extendedKeyArea(key));
+    KeyArea ext_ka(d->extendedKeyArea(key, orientation));
 
     if (not ext_ka.hasKeys()) {
         if (key.action() == Key::ActionSpace) {
@@ -464,7 +812,7 @@ void LayoutUpdater::onKeyLongPressed(const Key &key)
 
 void LayoutUpdater::onKeyReleased(const Key &key)
 {
-    Q_D(const LayoutUpdater);
+    Q_D(LayoutUpdater);
 
     if (not d->layout) {
         return;
@@ -482,30 +830,30 @@ void LayoutUpdater::onKeyReleased(const Key &key)
 
     switch (key.action()) {
     case Key::ActionShift:
-        Q_EMIT shiftReleased();
+        processEvent(&d->shift_machine, ShiftMachine::ShiftReleased);
         break;
 
     case Key::ActionInsert:
-        if (d->shift_machine.inState(ShiftMachine::latched_shift_state)) {
-            Q_EMIT shiftCancelled();
+        if (d->shift_machine.inState(ShiftMachine::LatchedShiftState)) {
+            processEvent(&d->shift_machine, ShiftMachine::ShiftCancelled);
         }
 
-        if (d->deadkey_machine.inState(DeadkeyMachine::latched_deadkey_state)) {
-            Q_EMIT deadkeyCancelled();
+        if (d->deadkey_machine.inState(DeadkeyMachine::LatchedDeadkeyState)) {
+            processEvent(&d->deadkey_machine, DeadkeyMachine::DeadkeyCancelled);
         }
 
         break;
 
     case Key::ActionSym:
-        Q_EMIT symKeyReleased();
+        processEvent(&d->view_machine, ViewMachine::SymKeyReleased);
         break;
 
     case Key::ActionSwitch:
-        Q_EMIT symSwitcherReleased();
+        processEvent(&d->view_machine, ViewMachine::SymSwitcherReleased);
         break;
 
     case Key::ActionDead:
-        Q_EMIT deadkeyReleased();
+        processEvent(&d->deadkey_machine, DeadkeyMachine::DeadkeyReleased);
         break;
 
     default:
@@ -550,8 +898,7 @@ void LayoutUpdater::onKeyEntered(const Key &key)
         return;
     }
 
-    d->layout->appendActiveKey(MaliitKeyboard::Logic::modifyKey(key, KeyDescription::PressedState,
-                                                                d->activeStyleAttributes()));
+    appendPressedKey(d->layout, key, d->activeStyleAttributes());
 
     if (d->layout->activePanel() == LayoutHelper::CenterPanel) {
         d->layout->setMagnifierKey(magnifyKey(key, d->activeStyleAttributes(), d->layout->orientation(),
@@ -587,7 +934,7 @@ void LayoutUpdater::clearActiveKeysAndMagnifier()
 
 void LayoutUpdater::resetOnKeyboardClosed()
 {
-    Q_D(const LayoutUpdater);
+    Q_D(LayoutUpdater);
 
     clearActiveKeysAndMagnifier();
     d->layout->setExtendedPanel(KeyArea());
@@ -638,9 +985,7 @@ void LayoutUpdater::onExtendedKeysShown(const Key &main_key)
     const LayoutHelper::Orientation orientation(d->layout->orientation());
     StyleAttributes * const extended_attributes(d->style->extendedKeysAttributes());
     const qreal vertical_offset(d->style->attributes()->verticalOffset(orientation));
-    KeyAreaConverter converter(extended_attributes, &d->loader);
-    converter.setLayoutOrientation(orientation);
-    KeyArea ext_ka(converter.extendedKeyArea(main_key));
+    KeyArea ext_ka(d->extendedKeyArea(main_key, orientation));
 
     if (not ext_ka.hasKeys()) {
         if (main_key.action() == Key::ActionSpace) {
@@ -692,6 +1037,32 @@ void LayoutUpdater::onWordCandidateReleased(const WordCandidate &candidate)
     }
 }
 
+void LayoutUpdater::onAutoCapsActivated()
+{
+    Q_D(LayoutUpdater);
+    processEvent(&d->shift_machine, ShiftMachine::AutoCapsActivated);
+}
+
+//! \brief Feeds an event to one of the state machines.
+//!
+//! Transitions happen synchronously. The layout is only synced if the
+//! transition changes the view requested by the state machines, for example
+//! going from latched shift to caps lock does not.
+//! \param machine The shift, view or dead key machine.
+//! \param event The event, as defined by the machine.
+void LayoutUpdater::processEvent(AbstractStateMachine *machine,
+                                 int event)
+{
+    Q_D(LayoutUpdater);
+
+    const int view(d->requestedView());
+
+    if (machine->processEvent(event) && d->requestedView() != view) {
+        syncLayoutToView();
+    }
+}
+
+//! \brief Shows the view requested by the state machines.
 void LayoutUpdater::syncLayoutToView()
 {
     Q_D(const LayoutUpdater);
@@ -700,12 +1071,11 @@ void LayoutUpdater::syncLayoutToView()
         return;
     }
 
-    // Symbols do not care about shift state.
-    if (d->areSymbolsShown()) {
-        return;
-    }
-
-    if (d->inDeadkeyState()) {
+    if (d->arePrimarySymbolsShown()) {
+        switchToPrimarySymView();
+    } else if (d->areSecondarySymbolsShown()) {
+        switchToSecondarySymView();
+    } else if (d->inDeadkeyState()) {
         switchToAccentedView();
     } else {
         switchToMainView();
@@ -716,16 +1086,47 @@ void LayoutUpdater::onKeyboardsChanged()
 {
     Q_D(LayoutUpdater);
 
-    // Resetting state machines should reset layout also.
-    // FIXME: Most probably reloading will happen three
-    // times, which is not what we want.
+    // Resetting state machines should reset layout also:
+    d->resetOverlays();
+    d->resetPrepared();
     d->shift_machine.restart();
     d->deadkey_machine.restart();
     d->view_machine.restart();
+    syncLayoutToView();
+
+    // Lets the view prepare rendering of all labels, if it wants to, see
+    // keyboardLabelsLoaded(). Collecting loads every view of the layout, so
+    // it always runs on the pipeline's worker thread. The worker handles
+    // requests in order, so a center panel that is still scheduled (with
+    // asynchronous loading) gets requested first:
+    if (receivers(SIGNAL(keyboardLabelsLoaded(QString, QStringList))) > 0) {
+        if (d->rebuild_scheduled) {
+            QMetaObject::invokeMethod(this, "requestKeyboardLabels", Qt::QueuedConnection);
+        } else {
+            requestKeyboardLabels();
+        }
+    }
 
     Q_EMIT keyboardTitleChanged(d->loader.title(d->loader.activeId()));
 }
 
+//! \brief Asks the layout pipeline for all labels of the active keyboard.
+void LayoutUpdater::requestKeyboardLabels()
+{
+    Q_D(LayoutUpdater);
+    pipeline()->requestLabels(d->loader.activeId());
+}
+
+void LayoutUpdater::clearKeyAreaCache()
+{
+    Q_D(LayoutUpdater);
+    d->key_area_cache.clear();
+    d->extended_key_area_cache.clear();
+    d->resetExtendedWarmup();
+    d->resetOverlays();
+    d->resetPrepared();
+}
+
 void LayoutUpdater::switchToMainView()
 {
     Q_D(LayoutUpdater);
@@ -745,10 +1146,8 @@ void LayoutUpdater::switchToMainView()
         d->layout->setWordRibbon(ribbon);
     }
 
-    KeyAreaConverter converter(d->style->attributes(), &d->loader);
-    converter.setLayoutOrientation(orientation);
-    d->layout->setCenterPanel(d->inShiftedState() ? converter.shiftedKeyArea()
-                                                  : converter.keyArea());
+    loadCenterPanel(d->inShiftedState() ? LayoutPipeline::ShiftedView
+                                        : LayoutPipeline::MainView);
 }
 
 void LayoutUpdater::switchToPrimarySymView()
@@ -759,10 +1158,7 @@ void LayoutUpdater::switchToPrimarySymView()
         return;
     }
 
-    const LayoutHelper::Orientation orientation(d->layout->orientation());
-    KeyAreaConverter converter(d->style->attributes(), &d->loader);
-    converter.setLayoutOrientation(orientation);
-    d->layout->setCenterPanel(converter.symbolsKeyArea(0));
+    loadCenterPanel(LayoutPipeline::SymbolsView, 0);
 
     // Reset shift state machine, also see switchToMainView.
     d->shift_machine.restart();
@@ -776,10 +1172,7 @@ void LayoutUpdater::switchToSecondarySymView()
         return;
     }
 
-    const LayoutHelper::Orientation orientation(d->layout->orientation());
-    KeyAreaConverter converter(d->style->attributes(), &d->loader);
-    converter.setLayoutOrientation(orientation);
-    d->layout->setCenterPanel(converter.symbolsKeyArea(1));
+    loadCenterPanel(LayoutPipeline::SymbolsView, 1);
 }
 
 void LayoutUpdater::switchToAccentedView()
@@ -790,13 +1183,416 @@ void LayoutUpdater::switchToAccentedView()
         return;
     }
 
+    loadCenterPanel(d->inShiftedState() ? LayoutPipeline::ShiftedDeadkeyView
+                                        : LayoutPipeline::DeadkeyView,
+                    0, d->deadkey_machine.accentKey());
+}
+
+//! \brief Enables loading of center panels on a worker thread.
+//!
+//! When enabled, view switches only request the new key area. The current
+//! center panel stays active (and keeps serving input) until the new key area
+//! is delivered. Superseded requests get dropped.
+//! \param enable Whether to load center panels asynchronously.
+void LayoutUpdater::setAsynchronousLoading(bool enable)
+{
+    Q_D(LayoutUpdater);
+
+    if (enable == d->asynchronous_loading) {
+        return;
+    }
+
+    d->asynchronous_loading = enable;
+
+    if (enable) {
+        pipeline();
+    } else if (d->pipeline) {
+        d->pipeline->cancel();
+    }
+}
+
+bool LayoutUpdater::isAsynchronousLoading() const
+{
+    Q_D(const LayoutUpdater);
+    return d->asynchronous_loading;
+}
+
+//! \brief Returns the layout pipeline, which gets created on first use.
+//!
+//! Also used without asynchronous loading, for work that should never run
+//! on the GUI thread, such as collecting labels.
+LayoutPipeline * LayoutUpdater::pipeline()
+{
+    Q_D(LayoutUpdater);
+
+    if (d->pipeline.isNull()) {
+        d->pipeline.reset(new LayoutPipeline);
+        connect(d->pipeline.data(), SIGNAL(keyAreaLoaded(int, MaliitKeyboard::KeyArea, QString)),
+                this,               SLOT(onCenterPanelLoaded(int, MaliitKeyboard::KeyArea, QString)),
+                Qt::UniqueConnection);
+        connect(d->pipeline.data(), SIGNAL(labelsLoaded(QString, QStringList)),
+                this,               SIGNAL(keyboardLabelsLoaded(QString, QStringList)),
+                Qt::UniqueConnection);
+        connect(d->pipeline.data(), SIGNAL(keyAreaPrepared(QString, QString, int, int, int, MaliitKeyboard::KeyArea, QString)),
+                this,               SLOT(onKeyAreaPrepared(QString, QString, int, int, int, MaliitKeyboard::KeyArea, QString)),
+                Qt::UniqueConnection);
+        connect(d->pipeline.data(), SIGNAL(extendedKeyAreaPrepared(QString, QString, int, QString, MaliitKeyboard::KeyArea, QString)),
+                this,               SLOT(onExtendedKeyAreaPrepared(QString, QString, int, QString, MaliitKeyboard::KeyArea, QString)),
+                Qt::UniqueConnection);
+    }
+
+    return d->pipeline.data();
+}
+
+//! \brief Returns how many times the center panel was rebuilt.
+int LayoutUpdater::rebuildCount() const
+{
+    Q_D(const LayoutUpdater);
+    return d->rebuild_count;
+}
+
+//! \brief Returns how many center panel rebuilds were merged into another
+//! rebuild within the same event loop iteration.
+int LayoutUpdater::coalescedRebuildCount() const
+{
+    Q_D(const LayoutUpdater);
+    return d->coalesced_rebuild_count;
+}
+
+//! \brief Returns how many center panel rebuilds were done by applying a
+//! label overlay on the main view, instead of converting a key area.
+int LayoutUpdater::overlaidRebuildCount() const
+{
+    Q_D(const LayoutUpdater);
+    return d->overlaid_rebuild_count;
+}
+
+//! \brief Returns how many center panel rebuilds used a key area that was
+//! prepared before, for example in the background for the other orientation.
+int LayoutUpdater::preparedRebuildCount() const
+{
+    Q_D(const LayoutUpdater);
+    return d->prepared_rebuild_count;
+}
+
+//! \brief Returns how many prepared key areas are held for the active
+//! keyboard and style.
+int LayoutUpdater::preparedKeyAreaCount() const
+{
+    Q_D(const LayoutUpdater);
+    return d->prepared.size();
+}
+
+//! \brief Converts extended key areas of the center panel ahead of their
+//! first long press, on the layout pipeline's worker thread.
+//!
+//! Each center panel asks for the keys it shows, unless they were asked
+//! for already. Disabled by default.
+//! \param enable Whether to warm up extended key areas.
+void LayoutUpdater::setExtendedKeysWarmupEnabled(bool enable)
+{
+    Q_D(LayoutUpdater);
+    d->extended_warmup_enabled = enable;
+    d->resetExtendedWarmup();
+}
+
+bool LayoutUpdater::isExtendedKeysWarmupEnabled() const
+{
+    Q_D(const LayoutUpdater);
+    return d->extended_warmup_enabled;
+}
+
+//! \brief Returns how many extended key areas are cached.
+int LayoutUpdater::extendedKeyAreaCount() const
+{
+    Q_D(const LayoutUpdater);
+    return d->extended_key_area_cache.count();
+}
+
+//! \brief Drops cached key areas, for when the keyboard is hidden and
+//! memory gets trimmed.
+//!
+//! The current key area and the label overlays stay, so that the keyboard
+//! can be shown again without a rebuild. Other views get converted again
+//! on first use.
+void LayoutUpdater::releaseCaches()
+{
+    Q_D(LayoutUpdater);
+    d->key_area_cache.clear();
+    d->extended_key_area_cache.clear();
+    d->resetExtendedWarmup();
+    d->resetPrepared();
+
+    if (d->pipeline) {
+        d->pipeline->clearCache();
+    }
+}
+
+//! \brief Rebuilds the center panel, for the active keyboard, style and
+//! orientation.
+//!
+//! Rebuilds synchronously, unless asynchronous loading is enabled. Then, a
+//! language switch and an orientation change arriving together would each
+//! start a background conversion, so the rebuild is deferred to the next
+//! event loop iteration and only the last request is performed.
+//! \param view The key area to create.
+//! \param page The symbols page, for symbol views.
+//! \param dead_key The dead key, for dead key views.
+void LayoutUpdater::loadCenterPanel(LayoutPipeline::View view,
+                                    int page,
+                                    const Key &dead_key)
+{
+    Q_D(LayoutUpdater);
+
+    d->rebuild_view = view;
+    d->rebuild_page = page;
+    d->rebuild_dead_key = dead_key;
+
+    if (not d->asynchronous_loading) {
+        d->rebuild_scheduled = true;
+        rebuildCenterPanel();
+        return;
+    }
+
+    if (d->rebuild_scheduled) {
+        ++d->coalesced_rebuild_count;
+        return;
+    }
+
+    d->rebuild_scheduled = true;
+    QMetaObject::invokeMethod(this, "rebuildCenterPanel", Qt::QueuedConnection);
+}
+
+//! \brief Creates the key area requested through loadCenterPanel().
+//!
+//! Shift and dead key views which were shown before for the current main view
+//! are created from their label overlay. Main, shift and symbols views that
+//! were prepared before (such as for the other orientation, see
+//! onKeyAreaPrepared()) are taken as they are. Otherwise, converts
+//! synchronously, unless asynchronous loading is enabled.
+void LayoutUpdater::rebuildCenterPanel()
+{
+    Q_D(LayoutUpdater);
+
+    if (not d->rebuild_scheduled) {
+        return;
+    }
+
+    d->rebuild_scheduled = false;
+
+    if (not d->layout || d->style.isNull()) {
+        return;
+    }
+
+    ++d->rebuild_count;
 
     const LayoutHelper::Orientation orientation(d->layout->orientation());
-    KeyAreaConverter converter(d->style->attributes(), &d->loader);
+    const LayoutPipeline::View view(d->rebuild_view);
+    const int page(d->rebuild_page);
+    const Key dead_key(d->rebuild_dead_key);
+
+    KeyArea key_area;
+    QString style_name;
+
+    if (d->overlaidKeyArea(view, dead_key, &key_area, &style_name)) {
+        ++d->overlaid_rebuild_count;
+
+        if (d->pipeline) {
+            d->pipeline->cancel();
+        }
+
+        // Keep main style attributes in sync, as if key area was converted here:
+        d->style->attributes()->setStyleName(style_name);
+        setCenterPanel(key_area);
+        return;
+    }
+
+    if (d->preparedKeyArea(orientation, view, page, &key_area, &style_name)) {
+        ++d->prepared_rebuild_count;
+
+        if (d->pipeline) {
+            d->pipeline->cancel();
+        }
+
+        d->recordKeyArea(view, dead_key, key_area, style_name);
+
+        // Keep main style attributes in sync, as if key area was converted here:
+        d->style->attributes()->setStyleName(style_name);
+        setCenterPanel(key_area);
+        d->prepareOtherOrientation(orientation, view, page);
+        prepareOverlays(orientation, view);
+        return;
+    }
+
+    if (d->asynchronous_loading) {
+        d->pending_serial = d->pipeline->request(d->loader.activeId(), d->style->profile(), orientation,
+                                                 view, page, dead_key);
+        d->pending_orientation = orientation;
+        d->pending_view = view;
+        d->pending_page = page;
+        d->pending_dead_key = dead_key;
+        return;
+    }
+
+    KeyAreaConverter converter(d->style->attributes(), &d->loader, &d->key_area_cache);
     converter.setLayoutOrientation(orientation);
-    const Key accent(d->deadkey_machine.accentKey());
-    d->layout->setCenterPanel(d->inShiftedState() ? converter.shiftedDeadKeyArea(accent)
-                                                  : converter.deadKeyArea(accent));
+
+    switch (view) {
+    case LayoutPipeline::MainView:
+        key_area = converter.keyArea();
+        break;
+
+    case LayoutPipeline::ShiftedView:
+        key_area = converter.shiftedKeyArea();
+        break;
+
+    case LayoutPipeline::SymbolsView:
+        key_area = converter.symbolsKeyArea(page);
+        break;
+
+    case LayoutPipeline::DeadkeyView:
+        key_area = converter.deadKeyArea(dead_key);
+        break;
+
+    case LayoutPipeline::ShiftedDeadkeyView:
+        key_area = converter.shiftedDeadKeyArea(dead_key);
+        break;
+
+    case LayoutPipeline::NumberView:
+        key_area = converter.numberKeyArea();
+        break;
+
+    case LayoutPipeline::PhoneNumberView:
+        key_area = converter.phoneNumberKeyArea();
+        break;
+    }
+
+    style_name = d->style->attributes()->styleName();
+    d->recordKeyArea(view, dead_key, key_area, style_name);
+    d->storePrepared(orientation, view, page, key_area, style_name);
+    setCenterPanel(key_area);
+    prepareOverlays(orientation, view);
+}
+
+void LayoutUpdater::onCenterPanelLoaded(int serial,
+                                        const KeyArea &key_area,
+                                        const QString &style_name)
+{
+    Q_D(LayoutUpdater);
+
+    if (not d->layout || d->style.isNull()) {
+        return;
+    }
+
+    if (serial == d->pending_serial) {
+        d->recordKeyArea(d->pending_view, d->pending_dead_key, key_area, style_name);
+        d->storePrepared(d->pending_orientation, d->pending_view, d->pending_page, key_area, style_name);
+    }
+
+    // Keep main style attributes in sync, as if key area was converted here:
+    d->style->attributes()->setStyleName(style_name);
+    setCenterPanel(key_area);
+
+    // Rotating the device should not need to convert anything:
+    if (serial == d->pending_serial) {
+        d->prepareOtherOrientation(d->pending_orientation, d->pending_view, d->pending_page);
+        prepareOverlays(d->pending_orientation, d->pending_view);
+    }
+}
+
+//! \brief Shows key_area as center panel, and asks the layout pipeline to
+//! warm up its extended key areas, if enabled.
+void LayoutUpdater::setCenterPanel(const KeyArea &key_area)
+{
+    Q_D(LayoutUpdater);
+
+    d->layout->setCenterPanel(key_area);
+
+    if (not d->extended_warmup_enabled) {
+        return;
+    }
+
+    const LayoutHelper::Orientation orientation(d->layout->orientation());
+    const QStringList labels(d->takeExtendedWarmupLabels(key_area, orientation));
+
+    if (not labels.isEmpty()) {
+        pipeline()->prepareExtendedKeys(d->loader.activeId(), d->style->profile(),
+                                        orientation, labels);
+    }
+}
+
+//! \brief Converts the shifted view in the background when a main view is
+//! shown, so that its label overlay exists before the first shift press.
+//! Only used with asynchronous loading, which owns the layout pipeline.
+void LayoutUpdater::prepareOverlays(LayoutHelper::Orientation orientation,
+                                    LayoutPipeline::View view)
+{
+    Q_D(LayoutUpdater);
+
+    if (not d->asynchronous_loading || view != LayoutPipeline::MainView
+        || d->style.isNull()) {
+        return;
+    }
+
+    KeyArea unused;
+
+    if (d->overlaidKeyArea(LayoutPipeline::ShiftedView, Key(), &unused)
+        || d->preparedKeyArea(orientation, LayoutPipeline::ShiftedView, 0, &unused)) {
+        return;
+    }
+
+    pipeline()->prepare(d->loader.activeId(), d->style->profile(), orientation,
+                        LayoutPipeline::ShiftedView);
+}
+
+//! \brief Caches an extended key area that was converted in the background,
+//! unless the keyboard or style changed in the meantime.
+void LayoutUpdater::onExtendedKeyAreaPrepared(const QString &keyboard_id,
+                                              const QString &style_profile,
+                                              int orientation,
+                                              const QString &label,
+                                              const KeyArea &key_area,
+                                              const QString &style_name)
+{
+    Q_D(LayoutUpdater);
+
+    if (d->style.isNull()
+        || keyboard_id != d->loader.activeId()
+        || style_profile != d->style->profile()) {
+        return;
+    }
+
+    KeyAreaConverter converter(d->style->extendedKeysAttributes(), &d->loader, &d->extended_key_area_cache);
+    converter.setLayoutOrientation(static_cast<LayoutHelper::Orientation>(orientation));
+    converter.cacheExtendedKeyArea(label, key_area, style_name);
+}
+
+//! \brief Keeps a key area that was prepared in the background, unless the
+//! keyboard or style changed in the meantime.
+void LayoutUpdater::onKeyAreaPrepared(const QString &keyboard_id,
+                                      const QString &style_profile,
+                                      int orientation,
+                                      int view,
+                                      int page,
+                                      const KeyArea &key_area,
+                                      const QString &style_name)
+{
+    Q_D(LayoutUpdater);
+
+    if (d->style.isNull()
+        || keyboard_id != d->loader.activeId()
+        || style_profile != d->style->profile()) {
+        return;
+    }
+
+    d->storePrepared(static_cast<LayoutHelper::Orientation>(orientation),
+                     static_cast<LayoutPipeline::View>(view),
+                     page, key_area, style_name);
+
+    // Overlays are made for the main view that is shown:
+    if (d->layout && orientation == d->layout->orientation()) {
+        d->recordKeyArea(static_cast<LayoutPipeline::View>(view), Key(), key_area, style_name);
+    }
 }
 
 }} // namespace Logic, MaliitKeyboard
@@ -39,12 +39,14 @@
 #include "models/wordcandidate.h"
 #include "logic/layouthelper.h"
 #include "logic/style.h"
+#include "logic/layoutpipeline.h"
 
 #include <QtCore>
 
 namespace MaliitKeyboard {
 namespace Logic {
 
+class AbstractStateMachine;
 class LayoutUpdaterPrivate;
 
 class LayoutUpdater
@@ -73,6 +75,21 @@ public:
 
     void setStyle(const SharedStyle &style);
 
+    void setAsynchronousLoading(bool enable);
+    bool isAsynchronousLoading() const;
+
+    int rebuildCount() const;
+    int coalescedRebuildCount() const;
+    int overlaidRebuildCount() const;
+    int preparedRebuildCount() const;
+    int preparedKeyAreaCount() const;
+
+    void setExtendedKeysWarmupEnabled(bool enable);
+    bool isExtendedKeysWarmupEnabled() const;
+    int extendedKeyAreaCount() const;
+
+    void releaseCaches();
+
     bool isWordRibbonVisible() const;
     Q_SLOT void setWordRibbonVisible(bool visible);
     Q_SIGNAL void wordRibbonVisibleChanged(bool visible);
@@ -91,6 +108,7 @@ public:
     Q_SLOT void clearActiveKeysAndMagnifier();
     Q_SLOT void resetOnKeyboardClosed();
     Q_SLOT void onWordCandidatesChanged(const WordCandidateList &candidates);
+    Q_SLOT void onAutoCapsActivated();
 
     // ExtendedKeyArea signal handlers:
     Q_SLOT void onExtendedKeysShown(const Key &main_key);
@@ -105,29 +123,48 @@ public:
     Q_SIGNAL void addToUserDictionary();
 
     Q_SIGNAL void keyboardTitleChanged(const QString &title);
+    Q_SIGNAL void keyboardLabelsLoaded(const QString &id,
+                                       const QStringList &labels);
 
 private:
-    Q_SIGNAL void shiftPressed();
-    Q_SIGNAL void shiftReleased();
-    Q_SIGNAL void autoCapsActivated();
-    Q_SIGNAL void shiftCancelled();
+    void processEvent(AbstractStateMachine *machine,
+                      int event);
+    LayoutPipeline * pipeline();
+    void setCenterPanel(const KeyArea &key_area);
+    void prepareOverlays(LayoutHelper::Orientation orientation,
+                         LayoutPipeline::View view);
 
     Q_SLOT void syncLayoutToView();
     Q_SLOT void onKeyboardsChanged();
-
-    Q_SIGNAL void symKeyReleased();
-    Q_SIGNAL void symSwitcherReleased();
+    Q_SLOT void requestKeyboardLabels();
+    Q_SLOT void clearKeyAreaCache();
 
     Q_SLOT void switchToMainView();
     Q_SLOT void switchToPrimarySymView();
     Q_SLOT void switchToSecondarySymView();
-
-    Q_SIGNAL void deadkeyPressed();
-    Q_SIGNAL void deadkeyReleased();
-    Q_SIGNAL void deadkeyCancelled();
-
     Q_SLOT void switchToAccentedView();
 
+    void loadCenterPanel(LayoutPipeline::View view,
+                         int page = 0,
+                         const Key &dead_key = Key());
+    Q_SLOT void rebuildCenterPanel();
+    Q_SLOT void onCenterPanelLoaded(int serial,
+                                    const MaliitKeyboard::KeyArea &key_area,
+                                    const QString &style_name);
+    Q_SLOT void onExtendedKeyAreaPrepared(const QString &keyboard_id,
+                                          const QString &style_profile,
+                                          int orientation,
+                                          const QString &label,
+                                          const MaliitKeyboard::KeyArea &key_area,
+                                          const QString &style_name);
+    Q_SLOT void onKeyAreaPrepared(const QString &keyboard_id,
+                                  const QString &style_profile,
+                                  int orientation,
+                                  int view,
+                                  int page,
+                                  const MaliitKeyboard::KeyArea &key_area,
+                                  const QString &style_name);
+
     const QScopedPointer<LayoutUpdaterPrivate> d_ptr;
 };
 
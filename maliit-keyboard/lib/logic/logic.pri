@@ -6,9 +6,13 @@ HEADERS += \
     logic/layoutupdater.h \
     logic/keyboardloader.h \
     logic/keyareaconverter.h \
+    logic/keyareacache.h \
+    logic/labeloverlay.h \
+    logic/layoutpipeline.h \
     logic/style.h \
     logic/spellchecker.h \
     logic/abstracttexteditor.h \
+    logic/wordboundarytracker.h \
     logic/abstractwordengine.h \
     logic/wordengine.h \
     logic/abstractlanguagefeatures.h \
@@ -21,9 +25,13 @@ SOURCES += \
     logic/layoutupdater.cpp \
     logic/keyboardloader.cpp \
     logic/keyareaconverter.cpp \
+    logic/keyareacache.cpp \
+    logic/labeloverlay.cpp \
+    logic/layoutpipeline.cpp \
     logic/style.cpp \
     logic/spellchecker.cpp \
     logic/abstracttexteditor.cpp \
+    logic/wordboundarytracker.cpp \
     logic/abstractwordengine.cpp \
     logic/wordengine.cpp \
     logic/abstractlanguagefeatures.cpp \
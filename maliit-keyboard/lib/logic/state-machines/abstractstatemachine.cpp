@@ -31,36 +31,65 @@
  */
 
 #include "abstractstatemachine.h"
-#include <QtCore>
 
 namespace MaliitKeyboard {
 namespace Logic {
 
-AbstractStateMachine::AbstractStateMachine()
+//! \class AbstractStateMachine
+//! \brief A synchronous state machine, driven by a static transition table.
+//!
+//! Events are processed immediately, without an event queue or signal
+//! dispatch. The machine does not notify anyone about state changes;
+//! callers check the return value of processEvent() instead.
+
+//! \param transitions The transition table, needs to outlive the machine.
+//! \param transition_count Number of rows in the transition table.
+//! \param initial_state The state the machine starts in, and returns to on
+//!        restart().
+AbstractStateMachine::AbstractStateMachine(const Transition *transitions,
+                                           int transition_count,
+                                           int initial_state)
+    : m_transitions(transitions)
+    , m_transition_count(transition_count)
+    , m_initial_state(initial_state)
+    , m_state(initial_state)
 {}
 
 AbstractStateMachine::~AbstractStateMachine()
 {}
 
-bool AbstractStateMachine::inState(const QString &name) const
+int AbstractStateMachine::state() const
 {
-    if (const QStateMachine *sm = dynamic_cast<const QStateMachine *>(this)) {
-        Q_FOREACH (QAbstractState *state, sm->configuration()) {
-            if (state->objectName() == name) {
-                return true;
-            }
+    return m_state;
+}
+
+bool AbstractStateMachine::inState(int state) const
+{
+    return (m_state == state);
+}
+
+//! \brief Looks up the transition for the current state and \a event.
+//! \returns Whether the machine entered another state. Events without a
+//!          matching transition are ignored.
+bool AbstractStateMachine::processEvent(int event)
+{
+    for (int index = 0; index < m_transition_count; ++index) {
+        const Transition &transition(m_transitions[index]);
+
+        if (transition.state == m_state && transition.event == event) {
+            const bool changed(m_state != transition.target);
+            m_state = transition.target;
+            return changed;
         }
     }
 
     return false;
 }
 
+//! \brief Returns to the initial state, synchronously.
 void AbstractStateMachine::restart()
 {
-    if (QStateMachine *sm = dynamic_cast<QStateMachine *>(this)) {
-        sm->stop();
-        QTimer::singleShot(0, sm, SLOT(start()));
-    }
+    m_state = m_initial_state;
 }
 
 }} // namespace Logic, MaliitKeyboard
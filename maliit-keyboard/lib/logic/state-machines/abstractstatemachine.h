@@ -33,22 +33,36 @@
 #ifndef MALIIT_KEYBOARD_ABSTRACTSTATEMACHINE_H
 #define MALIIT_KEYBOARD_ABSTRACTSTATEMACHINE_H
 
-class QString;
-
 namespace MaliitKeyboard {
 namespace Logic {
 
-class LayoutUpdater;
-
 class AbstractStateMachine
 {
 public:
-    explicit AbstractStateMachine();
+    //! One row of a transition table: Receiving \a event while in \a state
+    //! makes the machine enter \a target.
+    struct Transition
+    {
+        int state;
+        int event;
+        int target;
+    };
+
+    explicit AbstractStateMachine(const Transition *transitions,
+                                  int transition_count,
+                                  int initial_state);
     virtual ~AbstractStateMachine() = 0;
 
-    virtual void setup(LayoutUpdater *updater) = 0;
-    virtual bool inState(const QString &name) const;
+    int state() const;
+    bool inState(int state) const;
+    bool processEvent(int event);
     virtual void restart();
+
+private:
+    const Transition *const m_transitions;
+    const int m_transition_count;
+    const int m_initial_state;
+    int m_state;
 };
 
 }} // namespace Logic, MaliitKeyboard
@@ -32,14 +32,21 @@
  */
 
 #include "deadkeymachine.h"
-#include "logic/layoutupdater.h"
 
 namespace MaliitKeyboard {
 namespace Logic {
 
-const char *const DeadkeyMachine::no_deadkey_state = "no-deadkey";
-const char *const DeadkeyMachine::latched_deadkey_state = "latched-deadkey";
-const char *const DeadkeyMachine::deadkey_state = "deadkey";
+namespace {
+
+const AbstractStateMachine::Transition g_transitions[] = {
+    { DeadkeyMachine::NoDeadkeyState, DeadkeyMachine::DeadkeyPressed, DeadkeyMachine::DeadkeyState },
+    { DeadkeyMachine::DeadkeyState, DeadkeyMachine::DeadkeyCancelled, DeadkeyMachine::NoDeadkeyState },
+    { DeadkeyMachine::DeadkeyState, DeadkeyMachine::DeadkeyReleased, DeadkeyMachine::LatchedDeadkeyState },
+    { DeadkeyMachine::LatchedDeadkeyState, DeadkeyMachine::DeadkeyCancelled, DeadkeyMachine::NoDeadkeyState },
+    { DeadkeyMachine::LatchedDeadkeyState, DeadkeyMachine::DeadkeyPressed, DeadkeyMachine::NoDeadkeyState },
+};
+
+} // namespace
 
 class DeadkeyMachinePrivate
 {
@@ -51,56 +58,15 @@ public:
     {}
 };
 
-DeadkeyMachine::DeadkeyMachine(QObject *parent)
-    : QStateMachine(parent)
+DeadkeyMachine::DeadkeyMachine()
+    : AbstractStateMachine(g_transitions, sizeof(g_transitions) / sizeof(g_transitions[0]),
+                           NoDeadkeyState)
     , d_ptr(new DeadkeyMachinePrivate)
 {}
 
 DeadkeyMachine::~DeadkeyMachine()
 {}
 
-void DeadkeyMachine::setup(LayoutUpdater *updater)
-{
-    if (not updater) {
-        qCritical() << __PRETTY_FUNCTION__
-                    << "No updater specified. Aborting setup.";
-        return;
-    }
-
-    setChildMode(QState::ExclusiveStates);
-
-    QState *no_deadkey = 0;
-    QState *deadkey = 0;
-    QState *latched_deadkey = 0;
-
-    // addState makes state machine to be a parent of passed state,
-    // so we don't have to care about deleting states explicitly.
-    addState(no_deadkey = new QState);
-    addState(deadkey = new QState);
-    addState(latched_deadkey = new QState);
-    setInitialState(no_deadkey);
-
-    no_deadkey->setObjectName(no_deadkey_state);
-    deadkey->setObjectName(deadkey_state);
-    latched_deadkey->setObjectName(latched_deadkey_state);
-
-    no_deadkey->addTransition(updater, SIGNAL(deadkeyPressed()), deadkey);
-    connect(no_deadkey, SIGNAL(entered()),
-            updater,    SLOT(switchToMainView()));
-
-
-    deadkey->addTransition(updater, SIGNAL(deadkeyCancelled()), no_deadkey);
-    deadkey->addTransition(updater, SIGNAL(deadkeyReleased()), latched_deadkey);
-    connect(deadkey, SIGNAL(entered()),
-            updater, SLOT(switchToAccentedView()));
-
-    latched_deadkey->addTransition(updater, SIGNAL(deadkeyCancelled()), no_deadkey);
-    latched_deadkey->addTransition(updater, SIGNAL(deadkeyPressed()), no_deadkey);
-
-    // Defer to first main loop iteration:
-    QTimer::singleShot(0, this, SLOT(start()));
-}
-
 void DeadkeyMachine::setAccentKey(const Key &accent_key)
 {
     Q_D(DeadkeyMachine);
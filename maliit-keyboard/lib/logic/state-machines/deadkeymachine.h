@@ -45,34 +45,38 @@ namespace Logic {
 class DeadkeyMachinePrivate;
 
 class DeadkeyMachine
-    : public QStateMachine
-    , public AbstractStateMachine
+    : public AbstractStateMachine
 {
-    Q_OBJECT
     Q_DISABLE_COPY(DeadkeyMachine)
     Q_DECLARE_PRIVATE(DeadkeyMachine)
 
 public:
-    explicit DeadkeyMachine(QObject *parent = 0);
-    virtual ~DeadkeyMachine();
+    enum State {
+        //! This state means that deadkey wasn't pressed. No accented
+        //! characters may be entered now. This is initial state.
+        NoDeadkeyState,
+        //! This state means that deadkey was pressed but not yet released.
+        //! In this state either single accented character can be entered
+        //! or deadkey can be released to latch it.
+        DeadkeyState,
+        //! This state means that deadkey was pressed and released and thus
+        //! several accented characters can be entered. Pressing deadkey
+        //! again switches to initial state.
+        LatchedDeadkeyState
+    };
+
+    enum Event {
+        DeadkeyPressed,
+        DeadkeyReleased,
+        DeadkeyCancelled
+    };
 
-    virtual void setup(LayoutUpdater *updater);
+    explicit DeadkeyMachine();
+    virtual ~DeadkeyMachine();
 
     virtual void setAccentKey(const Key &accent_key);
     Key accentKey() const;
 
-    //! This state means that deadkey wasn't pressed. No accented
-    //! characters may be entered now. This is initial state.
-    static const char *const no_deadkey_state;
-    //! This state means that deadkey was pressed but not yet released.
-    //! In this state either single accented character can be entered
-    //! or deadkey can be released to latch it.
-    static const char *const deadkey_state;
-    //! This state means that deadkey was pressed and released and thus
-    //! several accented characters can be entered. Pressing deadkey
-    //! again switches to initial state.
-    static const char *const latched_deadkey_state;
-
 private:
     const QScopedPointer<DeadkeyMachinePrivate> d_ptr;
 };
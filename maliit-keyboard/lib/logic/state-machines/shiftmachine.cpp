@@ -32,63 +32,28 @@
  */
 
 #include "shiftmachine.h"
-#include "logic/layoutupdater.h"
 
 namespace MaliitKeyboard {
 namespace Logic {
 
-const char *const ShiftMachine::no_shift_state = "no-shift";
-const char *const ShiftMachine::shift_state = "shift";
-const char *const ShiftMachine::latched_shift_state = "latched-shift";
-const char *const ShiftMachine::caps_lock_state = "caps-lock";
+namespace {
 
-ShiftMachine::ShiftMachine(QObject *parent)
-    : QStateMachine(parent)
+const AbstractStateMachine::Transition g_transitions[] = {
+    { ShiftMachine::NoShiftState, ShiftMachine::ShiftPressed, ShiftMachine::LatchedShiftState },
+    { ShiftMachine::NoShiftState, ShiftMachine::AutoCapsActivated, ShiftMachine::LatchedShiftState },
+    { ShiftMachine::LatchedShiftState, ShiftMachine::ShiftCancelled, ShiftMachine::NoShiftState },
+    { ShiftMachine::LatchedShiftState, ShiftMachine::ShiftReleased, ShiftMachine::CapsLockState },
+    { ShiftMachine::CapsLockState, ShiftMachine::ShiftReleased, ShiftMachine::NoShiftState },
+};
+
+} // namespace
+
+ShiftMachine::ShiftMachine()
+    : AbstractStateMachine(g_transitions, sizeof(g_transitions) / sizeof(g_transitions[0]),
+                           NoShiftState)
 {}
 
 ShiftMachine::~ShiftMachine()
 {}
 
-void ShiftMachine::setup(LayoutUpdater *updater)
-{
-    if (not updater) {
-        qCritical() << __PRETTY_FUNCTION__
-                    << "No updater specified. Aborting setup.";
-        return;
-    }
-
-    setChildMode(QState::ExclusiveStates);
-
-    QState *no_shift = 0;
-    QState *latched_shift = 0;
-    QState *caps_lock = 0;
-
-    // addState makes state machine to be a parent of passed state,
-    // so we don't have to care about deleting states explicitly.
-    addState(no_shift = new QState);
-    addState(latched_shift = new QState);
-    addState(caps_lock = new QState);
-    setInitialState(no_shift);
-
-    no_shift->setObjectName(no_shift_state);
-    latched_shift->setObjectName(latched_shift_state);
-    caps_lock->setObjectName(caps_lock_state);
-
-    connect(no_shift, SIGNAL(entered()),
-            updater,  SLOT(syncLayoutToView()));
-    connect(latched_shift, SIGNAL(entered()),
-            updater,       SLOT(syncLayoutToView()));
-    connect(caps_lock, SIGNAL(entered()),
-            updater,   SLOT(syncLayoutToView()));
-
-    no_shift->addTransition(updater, SIGNAL(shiftPressed()), latched_shift);
-    no_shift->addTransition(updater, SIGNAL(autoCapsActivated()), latched_shift);
-    latched_shift->addTransition(updater, SIGNAL(shiftCancelled()), no_shift);
-    latched_shift->addTransition(updater, SIGNAL(shiftReleased()), caps_lock);
-    caps_lock->addTransition(updater, SIGNAL(shiftReleased()), no_shift);
-
-    // Defer to first main loop iteration:
-    QTimer::singleShot(0, this, SLOT(start()));
-}
-
 }} // namespace Logic, MaliitKeyboard
@@ -40,33 +40,36 @@
 namespace MaliitKeyboard {
 namespace Logic {
 
-class LayoutUpdater;
-
 class ShiftMachine
-    : public QStateMachine
-    , public AbstractStateMachine
+    : public AbstractStateMachine
 {
-    Q_OBJECT
     Q_DISABLE_COPY(ShiftMachine)
 
 public:
-    explicit ShiftMachine(QObject *parent = 0);
-    virtual ~ShiftMachine();
+    enum State {
+        //! This state means that neither shift nor caps-lock wasn't pressed.
+        //! Entered characters are lowercased. This is initial state.
+        NoShiftState,
+        //! This state means that shift was pressed but not yet released.
+        //! Now user can either release shift state to latch it or press
+        //! a key to enter one uppercased character.
+        ShiftState,
+        //! This state means that shift was pressed and released and thus
+        //! user can enter several uppercased characters.
+        LatchedShiftState,
+        //! Same as latched shift?
+        CapsLockState
+    };
 
-    virtual void setup(LayoutUpdater *updater);
+    enum Event {
+        ShiftPressed,
+        ShiftReleased,
+        ShiftCancelled,
+        AutoCapsActivated
+    };
 
-    //! This state means that neither shift nor caps-lock wasn't pressed.
-    //! Entered characters are lowercased. This is initial state.
-    static const char *const no_shift_state;
-    //! This state means that shift was pressed but not yet released.
-    //! Now user can either release shift state to latch it or press
-    //! a key to enter one uppercased character.
-    static const char *const shift_state;
-    //! This state means that shift was pressed and released and thus
-    //! user can enter several uppercased characters.
-    static const char *const latched_shift_state;
-    //! Same as latched shift?
-    static const char *const caps_lock_state;
+    explicit ShiftMachine();
+    virtual ~ShiftMachine();
 };
 
 }} // namespace Logic, MaliitKeyboard
@@ -32,63 +32,28 @@
  */
 
 #include "viewmachine.h"
-#include "logic/layoutupdater.h"
 
 namespace MaliitKeyboard {
 namespace Logic {
 
-const char *const ViewMachine::main_state = "main";
-const char *const ViewMachine::symbols0_state = "symbols0";
-const char *const ViewMachine::symbols1_state = "symbols1";
+namespace {
 
-ViewMachine::ViewMachine(QObject *parent)
-    : QStateMachine(parent)
+const AbstractStateMachine::Transition g_transitions[] = {
+    { ViewMachine::MainState, ViewMachine::SymKeyReleased, ViewMachine::Symbols0State },
+    { ViewMachine::Symbols0State, ViewMachine::SymKeyReleased, ViewMachine::MainState },
+    { ViewMachine::Symbols0State, ViewMachine::SymSwitcherReleased, ViewMachine::Symbols1State },
+    { ViewMachine::Symbols1State, ViewMachine::SymKeyReleased, ViewMachine::MainState },
+    { ViewMachine::Symbols1State, ViewMachine::SymSwitcherReleased, ViewMachine::Symbols0State },
+};
+
+} // namespace
+
+ViewMachine::ViewMachine()
+    : AbstractStateMachine(g_transitions, sizeof(g_transitions) / sizeof(g_transitions[0]),
+                           MainState)
 {}
 
 ViewMachine::~ViewMachine()
 {}
 
-void ViewMachine::setup(LayoutUpdater *updater)
-{
-    if (not updater) {
-        qCritical() << __PRETTY_FUNCTION__
-                    << "No updater specified. Aborting setup.";
-        return;
-    }
-
-    setChildMode(QState::ExclusiveStates);
-
-    QState *main = 0;
-    QState *symbols0 = 0;
-    QState *symbols1 = 0;
-
-    // addState makes state machine to be a parent of passed state,
-    // so we don't have to care about deleting states explicitly.
-    addState(main = new QState);
-    addState(symbols0 = new QState);
-    addState(symbols1 = new QState);
-    setInitialState(main);
-
-    main->setObjectName(main_state);
-    symbols0->setObjectName(symbols0_state);
-    symbols1->setObjectName(symbols1_state);
-
-    main->addTransition(updater, SIGNAL(symKeyReleased()), symbols0);
-    connect(main,    SIGNAL(entered()),
-            updater, SLOT(switchToMainView()));
-
-    symbols0->addTransition(updater, SIGNAL(symKeyReleased()), main);
-    symbols0->addTransition(updater, SIGNAL(symSwitcherReleased()), symbols1);
-    connect(symbols0, SIGNAL(entered()),
-            updater,  SLOT(switchToPrimarySymView()));
-
-    symbols1->addTransition(updater, SIGNAL(symKeyReleased()), main);
-    symbols1->addTransition(updater, SIGNAL(symSwitcherReleased()), symbols0);
-    connect(symbols1, SIGNAL(entered()),
-            updater,  SLOT(switchToSecondarySymView()));
-
-    // Defer to first main loop iteration:
-    QTimer::singleShot(0, this, SLOT(start()));
-}
-
 }} // namespace Logic, MaliitKeyboard
@@ -40,30 +40,31 @@
 namespace MaliitKeyboard {
 namespace Logic {
 
-class LayoutUpdater;
-
 class ViewMachine
-    : public QStateMachine
-    , public AbstractStateMachine
+    : public AbstractStateMachine
 {
-    Q_OBJECT
     Q_DISABLE_COPY(ViewMachine)
 
 public:
-    explicit ViewMachine(QObject *parent = 0);
-    virtual ~ViewMachine();
+    enum State {
+        //! This state means that main layout is currently active.
+        //! This is initial state.
+        MainState,
+        //! This state means that first page of symbols layout is
+        //! currently active.
+        Symbols0State,
+        //! This state means that second page of symbols layout is
+        //! currently active.
+        Symbols1State
+    };
 
-    virtual void setup(LayoutUpdater *updater);
+    enum Event {
+        SymKeyReleased,
+        SymSwitcherReleased
+    };
 
-    //! This state means that main layout is currently active.
-    //! This is initial state.
-    static const char *const main_state;
-    //! This state means that first page of symbols layout is
-    //! currently active.
-    static const char *const symbols0_state;
-    //! This state means that second page of symbols layout is
-    //! currently active.
-    static const char *const symbols1_state;
+    explicit ViewMachine();
+    virtual ~ViewMachine();
 };
 
 }} // namespace Logic, MaliitKeyboard
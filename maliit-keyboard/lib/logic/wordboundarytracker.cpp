@@ -0,0 +1,232 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+#include "wordboundarytracker.h"
+
+namespace MaliitKeyboard {
+namespace Logic {
+
+//! \class WordBoundaryTracker
+//! \brief Finds the boundaries of the word at the cursor, incrementally.
+//!
+//! Applications report every cursor move together with the whole
+//! surrounding text. The tracker remembers the last text and the range of
+//! characters its result depended on, that is, the word at the cursor and
+//! the separators around it. An update only compares that range with the
+//! new text, either at the same position or moved by the change in text
+//! length, as typing before the word would. If it matches and the cursor
+//! moved along, the last result is reused, shifted if needed. Otherwise
+//! only the word around the cursor gets scanned. Either way, the work done
+//! depends on the word length, not on the length of the text.
+
+WordBoundaryTracker::WordBoundaryTracker()
+    : m_text()
+    , m_cursor_position(0)
+    , m_begin(-1)
+    , m_end(-2)
+    , m_window_begin(0)
+    , m_window_end(0)
+    , m_valid(false)
+    , m_reused(false)
+{}
+
+//! \brief Checks whether given \a c is a word separator.
+//! \param c Char to test.
+//!
+//! Other way to do checks would be using isLetterOrNumber() + some
+//! other methods. But UTF is so crazy that I am not sure whether
+//! other strange categories are parts of the word or not. It is
+//! easier to specify punctuations and whitespaces.
+bool WordBoundaryTracker::isSeparator(const QChar &c)
+{
+    return (c.isPunct() or c.isSpace());
+}
+
+//! \brief Extracts a word boundaries at cursor position.
+//! \param surrounding_text Text from which extraction will happen.
+//! \param cursor_position Position of cursor within \a surrounding_text.
+//! \param replacement Place where replacement data will be stored.
+//!
+//! \return whether surrounding text was valid (not empty).
+//!
+//! If cursor is placed right after the word, boundaries of this word
+//! are extracted.  Otherwise if cursor is placed right before the
+//! word, then no word boundaries are stored - instead invalid
+//! replacement is stored. It might happen that cursor position is
+//! outside the string, so \a replacement will have fixed position.
+bool WordBoundaryTracker::update(const QString &surrounding_text,
+                                 int cursor_position,
+                                 AbstractTextEditor::Replacement *replacement)
+{
+    const int text_length(surrounding_text.length());
+
+    if (text_length == 0) {
+        reset();
+        return false;
+    }
+
+    // just in case - if cursor is far after last char in surrounding
+    // text we place it right after last char.
+    cursor_position = qBound(0, cursor_position, text_length);
+    m_reused = false;
+
+    if (m_valid) {
+        const int delta(text_length - m_text.length());
+
+        if (cursor_position == m_cursor_position
+            and windowMatches(surrounding_text, 0)) {
+            // Edit happened away from the word, if at all:
+            m_reused = true;
+        } else if (delta != 0
+                   and cursor_position == m_cursor_position + delta
+                   and windowMatches(surrounding_text, delta)) {
+            // Edit happened before the word, which moved along:
+            m_reused = true;
+            m_cursor_position += delta;
+            m_window_begin += delta;
+            m_window_end += delta;
+            if (m_begin >= 0) {
+                m_begin += delta;
+                m_end += delta;
+            }
+        }
+    }
+
+    m_text = surrounding_text;
+
+    if (not m_reused) {
+        scan(surrounding_text, cursor_position);
+    }
+
+    if (replacement) {
+        replacement->start = m_begin;
+        replacement->length = m_end - m_begin;
+        replacement->cursor_position = m_cursor_position;
+    }
+
+    return true;
+}
+
+//! \brief Forgets the last text, so that the next update() scans.
+void WordBoundaryTracker::reset()
+{
+    m_text.clear();
+    m_valid = false;
+    m_reused = false;
+}
+
+//! \brief Returns whether the last update() could reuse the previous result.
+bool WordBoundaryTracker::lastUpdateReused() const
+{
+    return m_reused;
+}
+
+// Checks whether the characters the last result depended on are found in
+// text, moved by shift. Text edges have to stay text edges.
+bool WordBoundaryTracker::windowMatches(const QString &text,
+                                        int shift) const
+{
+    const int old_length(m_text.length());
+    const int text_length(text.length());
+
+    if ((m_window_begin < 0 and shift != 0)
+        or (m_window_end >= old_length and m_window_end + shift != text_length)) {
+        return false;
+    }
+
+    const int begin(qMax(0, m_window_begin));
+    const int end(qMin(old_length - 1, m_window_end));
+
+    if (begin + shift < 0 or end + shift >= text_length) {
+        return false;
+    }
+
+    const QChar *const old_data(m_text.constData());
+    const QChar *const new_data(text.constData());
+
+    for (int index = begin; index <= end; ++index) {
+        if (old_data[index] != new_data[index + shift]) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void WordBoundaryTracker::scan(const QString &text,
+                               int cursor_position)
+{
+    const int text_length(text.length());
+    const QChar *const data(text.constData());
+    // The cursor might be placed after last char (that is to say - its
+    // index might be the one of string terminator), which gets treated as
+    // if there was a delimiter.
+    // begin is index of first char in a word
+    int begin(-1);
+    // end is index of a char after last char in a word.
+    // -2, because -2 - (-1) = -1 and we would like to
+    // have -1 as invalid length.
+    int end(-2);
+    int window_begin(-1);
+    int window_end(cursor_position);
+
+    for (int iter(cursor_position); iter >= 0; --iter) {
+        if (iter == text_length or isSeparator(data[iter])) {
+            if (iter != cursor_position) {
+                window_begin = iter;
+                break;
+            }
+        } else {
+            begin = iter;
+        }
+    }
+
+    if (begin >= 0) {
+        for (int iter(cursor_position); iter <= text_length; ++iter) {
+            end = iter;
+            if (iter == text_length or isSeparator(data[iter])) {
+                break;
+            }
+        }
+
+        window_end = end;
+    }
+
+    m_cursor_position = cursor_position;
+    m_begin = begin;
+    m_end = end;
+    m_window_begin = window_begin;
+    m_window_end = window_end;
+    m_valid = true;
+}
+
+}} // namespace Logic, MaliitKeyboard
@@ -0,0 +1,77 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+#ifndef MALIIT_KEYBOARD_WORDBOUNDARYTRACKER_H
+#define MALIIT_KEYBOARD_WORDBOUNDARYTRACKER_H
+
+#include "abstracttexteditor.h"
+
+#include <QtCore>
+
+namespace MaliitKeyboard {
+namespace Logic {
+
+class WordBoundaryTracker
+{
+public:
+    explicit WordBoundaryTracker();
+
+    bool update(const QString &surrounding_text,
+                int cursor_position,
+                AbstractTextEditor::Replacement *replacement);
+    void reset();
+
+    bool lastUpdateReused() const;
+
+    static bool isSeparator(const QChar &c);
+
+private:
+    QString m_text;
+    int m_cursor_position;
+    int m_begin;
+    int m_end;
+    // Range of characters the result depends on, including the separators
+    // that ended the scans. -1 and text length stand for the text edges.
+    int m_window_begin;
+    int m_window_end;
+    bool m_valid;
+    bool m_reused;
+
+    bool windowMatches(const QString &text,
+                       int shift) const;
+    void scan(const QString &text,
+              int cursor_position);
+};
+
+}} // namespace Logic, MaliitKeyboard
+
+#endif // MALIIT_KEYBOARD_WORDBOUNDARYTRACKER_H
@@ -32,6 +32,7 @@
 
 #include "wordengine.h"
 #include "spellchecker.h"
+#include "tracing.h"
 
 #ifdef HAVE_PRESAGE
 #include <presage.h>
@@ -42,6 +43,10 @@ namespace Logic {
 
 namespace {
 
+// Presage only looks at the last few tokens of its context; handing it more
+// than that just costs copies on every keystroke.
+const int g_max_context_words = 8;
+
 void appendToCandidates(WordCandidateList *candidates,
                         WordCandidate::Source source,
                         const QString &candidate,
@@ -106,14 +111,19 @@ std::string CandidatesCallback::get_future_stream() const
 class WordEnginePrivate
 {
 public:
-    SpellChecker spell_checker;
+    QScopedPointer<SpellChecker> spell_checker;
 #ifdef HAVE_PRESAGE
     std::string candidates_context;
     CandidatesCallback presage_candidates;
-    Presage presage;
+    QScopedPointer<Presage> presage;
 #endif
 
     explicit WordEnginePrivate();
+
+    SpellChecker * spellChecker();
+#ifdef HAVE_PRESAGE
+    Presage * predictor();
+#endif
 };
 
 WordEnginePrivate::WordEnginePrivate()
@@ -121,15 +131,34 @@ WordEnginePrivate::WordEnginePrivate()
 #ifdef HAVE_PRESAGE
     , candidates_context()
     , presage_candidates(CandidatesCallback(candidates_context))
-    , presage(&presage_candidates)
+    , presage()
 #endif
+{}
+
+// Dictionaries and the prediction model are loaded on first use, and again
+// after WordEngine::releaseResources():
+SpellChecker * WordEnginePrivate::spellChecker()
 {
     // FIXME: Check whether spellchecker is enabled, and update enabled flag!
+    if (spell_checker.isNull()) {
+        spell_checker.reset(new SpellChecker);
+    }
+
+    return spell_checker.data();
+}
+
 #ifdef HAVE_PRESAGE
-    presage.config("Presage.Selector.SUGGESTIONS", "6");
-    presage.config("Presage.Selector.REPEAT_SUGGESTIONS", "yes");
-#endif
+Presage * WordEnginePrivate::predictor()
+{
+    if (presage.isNull()) {
+        presage.reset(new Presage(&presage_candidates));
+        presage->config("Presage.Selector.SUGGESTIONS", "6");
+        presage->config("Presage.Selector.REPEAT_SUGGESTIONS", "yes");
+    }
+
+    return presage.data();
 }
+#endif
 
 
 //! \brief Constructor.
@@ -163,6 +192,8 @@ void WordEngine::setEnabled(bool enabled)
 
 WordCandidateList WordEngine::fetchCandidates(Model::Text *text)
 {
+    MALIIT_TRACE_SCOPE("WordEngine::fetchCandidates");
+
     WordCandidateList candidates;
  
 #ifdef DISABLE_PREEDIT
@@ -175,9 +206,10 @@ WordCandidateList WordEngine::fetchCandidates(Model::Text *text)
     const bool is_preedit_capitalized(not preedit.isEmpty() && preedit.at(0).isUpper());
 
 #ifdef HAVE_PRESAGE
-    const QString &context = (text->surroundingLeft() + preedit);
+    QString context(text->surroundingContext(g_max_context_words).toString());
+    context.append(preedit);
     d->candidates_context = context.toStdString();
-    const std::vector<std::string> predictions = d->presage.predict();
+    const std::vector<std::string> predictions = d->predictor()->predict();
 
     // TODO: Fine-tune presage behaviour to also perform error correction, not just word prediction.
     if (not context.isEmpty()) {
@@ -191,10 +223,11 @@ WordCandidateList WordEngine::fetchCandidates(Model::Text *text)
     }
 #endif
 
-    const bool correct_spelling(d->spell_checker.spell(preedit));
+    SpellChecker *const spell_checker(d->spellChecker());
+    const bool correct_spelling(spell_checker->spell(preedit));
 
     if (candidates.isEmpty() and not correct_spelling) {
-        Q_FOREACH(const QString &correction, d->spell_checker.suggest(preedit, 5)) {
+        Q_FOREACH(const QString &correction, spell_checker->suggest(preedit, 5)) {
             appendToCandidates(&candidates, WordCandidate::SourceSpellChecking, correction, is_preedit_capitalized);
         }
     }
@@ -215,7 +248,38 @@ void WordEngine::addToUserDictionary(const QString &word)
 {
     Q_D(WordEngine);
 
-    d->spell_checker.addToUserWordlist(word);
+    d->spellChecker()->addToUserWordlist(word);
+}
+
+//! \brief Unloads the spell checker dictionaries and the prediction model.
+//!
+//! User words are stored on disk, so nothing gets lost. Both are loaded
+//! again by restoreResources(), or else on the next candidate update.
+void WordEngine::releaseResources()
+{
+    Q_D(WordEngine);
+
+    d->spell_checker.reset();
+#ifdef HAVE_PRESAGE
+    d->presage.reset();
+#endif
+}
+
+//! \brief Loads the spell checker dictionaries and the prediction model
+//! again, if the word engine is enabled, so that the first keystroke after
+//! releaseResources() does not have to.
+void WordEngine::restoreResources()
+{
+    Q_D(WordEngine);
+
+    if (not isEnabled()) {
+        return;
+    }
+
+    d->spellChecker();
+#ifdef HAVE_PRESAGE
+    d->predictor();
+#endif
 }
 
 }} // namespace Logic, MaliitKeyboard
@@ -58,6 +58,8 @@ public:
     virtual void setEnabled(bool enabled);
 
     virtual void addToUserDictionary(const QString &word);
+    virtual void releaseResources();
+    virtual void restoreResources();
     //! \reimp_end
 
 private:
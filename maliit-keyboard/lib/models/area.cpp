@@ -30,6 +30,7 @@
  */
 
 #include "area.h"
+#include "atoms.h"
 
 namespace MaliitKeyboard {
 
@@ -73,7 +74,7 @@ bool operator==(const Area &lhs,
                 const Area &rhs)
 {
     return (lhs.size() == rhs.size()
-            && lhs.background() == rhs.background()
+            && Atoms::same(lhs.background(), rhs.background())
             && lhs.backgroundBorders() == rhs.backgroundBorders());
 }
 
@@ -31,6 +31,7 @@
  */
 
 #include "key.h"
+#include "atoms.h"
 
 namespace MaliitKeyboard {
 
@@ -42,6 +43,8 @@ Key::Key()
     , m_style(StyleNormalKey)
     , m_margins()
     , m_icon()
+    , m_state(KeyDescription::NormalState)
+    , m_state_backgrounds()
     , m_has_extended_keys(false)
 {}
 
@@ -136,6 +139,42 @@ void Key::setIcon(const QByteArray &icon)
     m_icon = icon;
 }
 
+KeyDescription::State Key::state() const
+{
+    return m_state;
+}
+
+//! \brief Switches the key to another visual state.
+//!
+//! If state backgrounds were attached through setStateBackgrounds(), the
+//! background of the requested state is applied. The icon stays as it is.
+//! @param state The new key state.
+void Key::setState(KeyDescription::State state)
+{
+    if (state < KeyDescription::NormalState || state >= KeyDescription::NumStates) {
+        return;
+    }
+
+    if (m_state_backgrounds) {
+        m_area.setBackground(m_state_backgrounds->backgrounds[state]);
+    }
+
+    m_state = state;
+}
+
+bool Key::hasStateBackgrounds() const
+{
+    return not m_state_backgrounds.isNull();
+}
+
+//! \brief Attaches the backgrounds of all key states, as shared by all keys
+//! of the same style, see StyleAttributes::keyBackgrounds().
+//! @param backgrounds The key backgrounds, indexed by key state.
+void Key::setStateBackgrounds(const SharedKeyBackgrounds &backgrounds)
+{
+    m_state_backgrounds = backgrounds;
+}
+
 bool Key::hasExtendedKeys() const
 {
     return m_has_extended_keys;
@@ -162,7 +201,7 @@ bool operator==(const Key &lhs,
     return (lhs.origin() == rhs.origin()
             && lhs.area() == rhs.area()
             && lhs.label() == rhs.label()
-            && lhs.icon() == rhs.icon());
+            && Atoms::same(lhs.icon(), rhs.icon()));
 }
 
 bool operator!=(const Key &lhs,
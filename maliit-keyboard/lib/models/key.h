@@ -35,6 +35,8 @@
 
 #include "models/area.h"
 #include "models/label.h"
+#include "models/keydescription.h"
+#include "models/keybackgrounds.h"
 
 #include <QtCore>
 
@@ -91,6 +93,8 @@ private:
     Style m_style;
     QMargins m_margins;
     QByteArray m_icon;
+    KeyDescription::State m_state;
+    SharedKeyBackgrounds m_state_backgrounds;
     bool m_has_extended_keys: 1;
     int m_flags_padding: 7;
     QString m_command_sequence;
@@ -125,6 +129,12 @@ public:
     QByteArray icon() const;
     void setIcon(const QByteArray &icon);
 
+    KeyDescription::State state() const;
+    void setState(KeyDescription::State state);
+
+    bool hasStateBackgrounds() const;
+    void setStateBackgrounds(const SharedKeyBackgrounds &backgrounds);
+
     bool hasExtendedKeys() const;
     void setExtendedKeysEnabled(bool enable);
 
@@ -138,6 +148,9 @@ bool operator==(const Key &lhs,
 bool operator!=(const Key &lhs,
                 const Key &rhs);
 
+//! Key labels and icons overriden by the application, by key id.
+typedef QMap<QString, Key> KeyOverrides;
+
 } // namespace MaliitKeyboard
 
 Q_DECLARE_METATYPE(MaliitKeyboard::Key)
@@ -31,6 +31,7 @@
  */
 
 #include "keyarea.h"
+#include "coreutils.h"
 
 namespace MaliitKeyboard {
 
@@ -38,6 +39,8 @@ KeyArea::KeyArea()
     : m_keys()
     , m_origin()
     , m_area()
+    , m_key_ids()
+    , m_key_ids_valid(true)
 {}
 
 bool KeyArea::hasKeys() const
@@ -65,14 +68,66 @@ QVector<Key> KeyArea::keys() const
     return m_keys;
 }
 
+const Key & KeyArea::keyAt(int index) const
+{
+    return m_keys.at(index);
+}
+
 QVector<Key> & KeyArea::rKeys()
 {
+    // Keys might get relabeled through the reference:
+    m_key_ids_valid = false;
     return m_keys;
 }
 
 void KeyArea::setKeys(const QVector<Key> &keys)
 {
     m_keys = keys;
+    updateKeyIds();
+}
+
+//! \brief Returns the indices of all keys with the given override id.
+//!
+//! See CoreUtils::idFromKey(). Uses the index built by updateKeyIds(), or
+//! scans all keys if the index was invalidated by rKeys().
+QVector<int> KeyArea::keyIndices(const QString &id) const
+{
+    if (id.isEmpty()) {
+        return QVector<int>();
+    }
+
+    if (m_key_ids_valid) {
+        return m_key_ids.value(id);
+    }
+
+    QVector<int> indices;
+
+    for (int index = 0; index < m_keys.count(); ++index) {
+        if (CoreUtils::idFromKey(m_keys.at(index)) == id) {
+            indices.append(index);
+        }
+    }
+
+    return indices;
+}
+
+//! \brief Indexes the keys by their override id.
+//!
+//! Called by setKeys(). Needs to be called again after relabeling keys
+//! through rKeys().
+void KeyArea::updateKeyIds()
+{
+    m_key_ids.clear();
+
+    for (int index = 0; index < m_keys.count(); ++index) {
+        const QString &id(CoreUtils::idFromKey(m_keys.at(index)));
+
+        if (not id.isEmpty()) {
+            m_key_ids[id].append(index);
+        }
+    }
+
+    m_key_ids_valid = true;
 }
 
 Area KeyArea::area() const
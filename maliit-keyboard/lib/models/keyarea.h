@@ -45,6 +45,8 @@ private:
     QPoint m_origin;
     Area m_area;
     qreal m_margin;
+    QHash<QString, QVector<int> > m_key_ids;
+    bool m_key_ids_valid;
 
 public:
     explicit KeyArea();
@@ -56,9 +58,13 @@ public:
     void setOrigin(const QPoint &origin);
 
     QVector<Key> keys() const;
+    const Key & keyAt(int index) const;
     QVector<Key> & rKeys();
     void setKeys(const QVector<Key> &keys);
 
+    QVector<int> keyIndices(const QString &id) const;
+    void updateKeyIds();
+
     Area area() const;
     Area & rArea();
     void setArea(const Area &area);
@@ -72,4 +78,6 @@ bool operator!=(const KeyArea &lhs,
 
 } // namespace MaliitKeyboard
 
+Q_DECLARE_METATYPE(MaliitKeyboard::KeyArea)
+
 #endif // MALIIT_KEYBOARD_KEYAREA_H
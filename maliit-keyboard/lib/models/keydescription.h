@@ -71,7 +71,8 @@ struct KeyDescription
         NormalState,
         PressedState,
         DisabledState,
-        HighlightedState
+        HighlightedState,
+        NumStates
     };
 
     enum FontGroup {
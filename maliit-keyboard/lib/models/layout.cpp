@@ -36,6 +36,9 @@
 
 #include "logic/layouthelper.h"
 #include "logic/layoutupdater.h"
+#include "tracing.h"
+#include "atoms.h"
+#include "coreutils.h"
 
 namespace MaliitKeyboard {
 namespace Model {
@@ -50,6 +53,107 @@ QUrl toUrl(const QString &directory,
     return QUrl();
 
 }
+
+bool sameFont(const Font &lhs,
+              const Font &rhs)
+{
+    return (Atoms::same(lhs.name(), rhs.name())
+            && lhs.size() == rhs.size()
+            && Atoms::same(lhs.color(), rhs.color())
+            && lhs.stretch() == rhs.stretch());
+}
+
+// Compares two key areas with identical geometry, for example a main view
+// and its shifted variant. Returns false if geometry differs, otherwise
+// reports the range of changed keys and the model roles affected.
+bool diffKeyFaces(const KeyArea &current,
+                  const KeyArea &next,
+                  int *first_changed,
+                  int *last_changed,
+                  QVector<int> *roles)
+{
+    const QVector<Key> &current_keys(current.keys());
+    const QVector<Key> &next_keys(next.keys());
+
+    if (current.area() != next.area()
+        || current.origin() != next.origin()
+        || current_keys.isEmpty()
+        || current_keys.count() != next_keys.count()) {
+        return false;
+    }
+
+    bool text_changed(false);
+    bool font_changed(false);
+    bool icon_changed(false);
+    bool background_changed(false);
+
+    for (int index = 0; index < current_keys.count(); ++index) {
+        const Key &c(current_keys.at(index));
+        const Key &n(next_keys.at(index));
+
+        if (c.rect() != n.rect() || c.margins() != n.margins()) {
+            return false;
+        }
+
+        const bool key_text_changed(c.label().text() != n.label().text());
+        const bool key_font_changed(not sameFont(c.label().font(), n.label().font()));
+        const bool key_icon_changed(not Atoms::same(c.icon(), n.icon()));
+        const bool key_background_changed(c.area() != n.area());
+
+        if (key_text_changed || key_font_changed || key_icon_changed || key_background_changed) {
+            if (*first_changed < 0) {
+                *first_changed = index;
+            }
+
+            *last_changed = index;
+        }
+
+        text_changed = text_changed || key_text_changed;
+        font_changed = font_changed || key_font_changed;
+        icon_changed = icon_changed || key_icon_changed;
+        background_changed = background_changed || key_background_changed;
+    }
+
+    if (text_changed) {
+        roles->append(Layout::RoleKeyText);
+    }
+
+    if (font_changed) {
+        roles->append(Layout::RoleKeyFont);
+        roles->append(Layout::RoleKeyFontColor);
+        roles->append(Layout::RoleKeyFontSize);
+        roles->append(Layout::RoleKeyFontStretch);
+    }
+
+    if (icon_changed) {
+        roles->append(Layout::RoleKeyIcon);
+    }
+
+    if (background_changed) {
+        roles->append(Layout::RoleKeyBackground);
+        roles->append(Layout::RoleKeyBackgroundBorders);
+    }
+
+    return true;
+}
+
+// Relabels a key with the label and icon of an override:
+Key overridenKey(const Key &original,
+                 const Key &override)
+{
+    Key key(original);
+
+    if (not override.label().text().isEmpty()) {
+        key.rLabel().setText(override.label().text());
+    }
+
+    if (not override.icon().isEmpty()) {
+        key.setIcon(override.icon());
+    }
+
+    return key;
+}
+
 }
 
 
@@ -60,8 +164,12 @@ public:
     KeyArea key_area;
     QString image_directory;
     QHash<int, QByteArray> roles;
+    KeyOverrides overrides;
+    QHash<int, Key> overriden_originals;
 
     explicit LayoutPrivate();
+
+    KeyArea applyOverrides(const KeyArea &area);
 };
 
 
@@ -70,6 +178,8 @@ LayoutPrivate::LayoutPrivate()
     , key_area()
     , image_directory()
     , roles()
+    , overrides()
+    , overriden_originals()
 {
     // Model roles are used as variables in QML, hence the under_score naming
     // convention:
@@ -86,6 +196,32 @@ LayoutPrivate::LayoutPrivate()
 }
 
 
+// Applies the current overrides to a new key area, remembering the original
+// keys so that later updates still find them by their id:
+KeyArea LayoutPrivate::applyOverrides(const KeyArea &area)
+{
+    overriden_originals.clear();
+
+    if (overrides.isEmpty()) {
+        return area;
+    }
+
+    KeyArea result(area);
+    const QVector<Key> &keys(area.keys());
+
+    for (int index = 0; index < keys.count(); ++index) {
+        const KeyOverrides::const_iterator it(overrides.find(CoreUtils::idFromKey(keys.at(index))));
+
+        if (it != overrides.end()) {
+            overriden_originals.insert(index, keys.at(index));
+            result.rKeys()[index] = overridenKey(keys.at(index), it.value());
+        }
+    }
+
+    return result;
+}
+
+
 Layout::Layout(QObject *parent)
     : QAbstractListModel(parent)
     , d_ptr(new LayoutPrivate)
@@ -114,11 +250,37 @@ QString Layout::title() const
 }
 
 
-void Layout::setKeyArea(const KeyArea &area)
+//! \brief Sets the key area shown by this model, with the current key
+//! overrides applied.
+//!
+//! If the new key area only differs in key labels, icons or backgrounds (as
+//! is the case for shift and dead key views), only the affected rows and
+//! roles are announced as changed, instead of resetting the whole model.
+void Layout::setKeyArea(const KeyArea &new_area)
 {
+    Q_D(Layout);
+
+    const KeyArea area(d->applyOverrides(new_area));
+    int first_changed(-1);
+    int last_changed(-1);
+    QVector<int> changed_roles;
+
+    if (diffKeyFaces(d->key_area, area, &first_changed, &last_changed, &changed_roles)) {
+        d->key_area = area;
+
+        if (first_changed >= 0) {
+#if QT_VERSION >= 0x050000
+            Q_EMIT dataChanged(index(first_changed, 0), index(last_changed, 0), changed_roles);
+#else
+            Q_EMIT dataChanged(index(first_changed, 0), index(last_changed, 0));
+#endif
+        }
+
+        return;
+    }
+
     beginResetModel();
 
-    Q_D(Layout);
     const bool geometry_changed(d->key_area.rect() != area.rect());
     const bool background_changed(d->key_area.area().background() != area.area().background());
     const bool background_borders_changed(d->key_area.area().backgroundBorders() != area.area().backgroundBorders());
@@ -153,6 +315,68 @@ void Layout::setKeyArea(const KeyArea &area)
 }
 
 
+//! \brief Sets the key area shown by this model, replacing the key
+//! overrides.
+//! \param area The new key area.
+//! \param overrides All key overrides, by key id.
+void Layout::setKeyArea(const KeyArea &area,
+                        const KeyOverrides &overrides)
+{
+    Q_D(Layout);
+    d->overrides = overrides;
+    setKeyArea(area);
+}
+
+
+//! \brief Applies key overrides to some keys of the current key area.
+//!
+//! The overrides are kept, and applied to key areas set later on.
+//!
+//! Keys are looked up by their id before any override was applied, so that
+//! an overriden label does not hide a key from later updates. Keys whose
+//! override went away get restored. Only the given rows are announced as
+//! changed.
+//! \param indices The indices of the affected keys.
+//! \param overrides All key overrides, by key id.
+void Layout::applyKeyOverrides(const QVector<int> &indices,
+                               const KeyOverrides &overrides)
+{
+    Q_D(Layout);
+
+    d->overrides = overrides;
+    const int count(d->key_area.keys().count());
+
+    Q_FOREACH (int key_index, indices) {
+        if (key_index < 0 || key_index >= count) {
+            continue;
+        }
+
+        const QHash<int, Key>::const_iterator original_it(d->overriden_originals.find(key_index));
+        const Key original(original_it != d->overriden_originals.end()
+                           ? original_it.value() : d->key_area.keyAt(key_index));
+        const KeyOverrides::const_iterator override_it(overrides.find(CoreUtils::idFromKey(original)));
+        Key key(original);
+
+        if (override_it != overrides.end()) {
+            d->overriden_originals.insert(key_index, original);
+            key = overridenKey(original, override_it.value());
+        } else {
+            d->overriden_originals.remove(key_index);
+        }
+
+        key.setState(d->key_area.keyAt(key_index).state());
+        d->key_area.rKeys().replace(key_index, key);
+
+#if QT_VERSION >= 0x050000
+        Q_EMIT dataChanged(index(key_index, 0), index(key_index, 0),
+                           QVector<int>() << RoleKeyText << RoleKeyIcon);
+#else
+        Q_EMIT dataChanged(index(key_index, 0), index(key_index, 0));
+#endif
+    }
+}
+
+
 KeyArea Layout::keyArea() const
 {
     Q_D(const Layout);
@@ -163,12 +387,68 @@ KeyArea Layout::keyArea() const
 void Layout::replaceKey(int index,
                         const Key &key)
 {
+    MALIIT_TRACE_SCOPE("Model::Layout::replaceKey");
+
     Q_D(Layout);
     d->key_area.rKeys().replace(index, key);
     Q_EMIT dataChanged(this->index(index, 0), this->index(index, 0));
 }
 
 
+//! \brief Returns whether \a index refers to a key of the current key area.
+bool Layout::hasKey(int index) const
+{
+    Q_D(const Layout);
+    return (index >= 0 && index < d->key_area.keys().count());
+}
+
+
+//! \brief Returns the key at \a index, without copying it.
+//!
+//! The reference is only valid until the key area or the key changes. Callers
+//! that need the key beyond that should copy it, or hold on to keys(), which
+//! is a cheap, implicitly shared copy. An out of range index yields an
+//! invalid key.
+const Key & Layout::key(int index) const
+{
+    Q_D(const Layout);
+
+    if (not hasKey(index)) {
+        static const Key null_key;
+        return null_key;
+    }
+
+    return d->key_area.keyAt(index);
+}
+
+
+QVector<Key> Layout::keys() const
+{
+    Q_D(const Layout);
+    return d->key_area.keys();
+}
+
+
+//! \brief Changes the state of a key in place.
+//!
+//! Only applies the state backgrounds attached to the key, see
+//! Key::setStateBackgrounds(). Keys without those need to be restyled through
+//! LayoutUpdater::modifyKey() and replaceKey() instead.
+void Layout::setKeyState(int index,
+                         KeyDescription::State state)
+{
+    Q_D(Layout);
+
+    if (not hasKey(index)
+        || d->key_area.keyAt(index).state() == state) {
+        return;
+    }
+
+    d->key_area.rKeys()[index].setState(state);
+    Q_EMIT dataChanged(this->index(index, 0), this->index(index, 0));
+}
+
+
 bool Layout::isVisible() const
 {
     Q_D(const Layout);
@@ -96,11 +96,22 @@ public:
     Q_SIGNAL void titleChanged(const QString &changed);
 
     Q_SLOT void setKeyArea(const KeyArea &area);
+    Q_SLOT void setKeyArea(const KeyArea &area,
+                           const KeyOverrides &overrides);
     KeyArea keyArea() const;
 
+    Q_SLOT void applyKeyOverrides(const QVector<int> &indices,
+                                  const KeyOverrides &overrides);
+
     void replaceKey(int index,
                     const Key &key);
 
+    bool hasKey(int index) const;
+    const Key & key(int index) const;
+    QVector<Key> keys() const;
+    void setKeyState(int index,
+                     KeyDescription::State state);
+
     Q_SLOT bool isVisible() const;
     Q_SIGNAL void visibleChanged(bool changed);
 
@@ -9,10 +9,12 @@ HEADERS += \
     models/layout.h \
     models/keyboard.h \
     models/keydescription.h \
+    models/keybackgrounds.h \
     models/wordcandidate.h \
     models/wordribbon.h \
     models/text.h \
     models/styleattributes.h \
+    models/stylemetrics.h \
 
 SOURCES += \
     models/area.cpp \
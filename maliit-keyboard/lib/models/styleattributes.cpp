@@ -31,6 +31,7 @@
  */
 
 #include "styleattributes.h"
+#include "atoms.h"
 
 //! \class StyleAttributes
 //! This class allows to query style attributes, such as image names and font
@@ -39,6 +40,8 @@
 namespace MaliitKeyboard {
 namespace {
 
+const QString g_default_style_name("default");
+
 //! \brief Converts KeyDescription::Width enum values into string representations.
 //! @param width The enum value to convert.
 //! @returns The string representation.
@@ -118,6 +121,7 @@ QByteArray fromKeyState(KeyDescription::State state)
     case KeyDescription::PressedState: return QByteArray("-pressed");
     case KeyDescription::DisabledState: return QByteArray("-disabled");
     case KeyDescription::HighlightedState: return QByteArray("-highlighted");
+    case KeyDescription::NumStates: break;
     }
 
     return QByteArray();
@@ -194,16 +198,128 @@ QVariant lookup(const QScopedPointer<const QSettings> &store,
 StyleAttributes::StyleAttributes(const QSettings *store)
     : m_store(store)
     , m_style_name()
+    , m_landscape_metrics()
+    , m_portrait_metrics()
+    , m_active_landscape_metrics()
+    , m_active_portrait_metrics()
+    , m_key_backgrounds()
+    , m_icons()
+    , m_key_background_borders()
 {
     if (m_store.isNull()) {
         qFatal("QSettings store cannot be null!");
     }
+
+    compile();
+
+    m_active_landscape_metrics = m_landscape_metrics.value(g_default_style_name);
+    m_active_portrait_metrics = m_portrait_metrics.value(g_default_style_name);
 }
 
 //! \brief Destructor
 StyleAttributes::~StyleAttributes()
 {}
 
+//! \brief Compiles the settings store into typed lookup tables.
+//!
+//! Every style section (and the default section) gets compiled into
+//! StyleMetrics instances, one per orientation. Key backgrounds and icons are
+//! resolved for all key styles, icons and states. Getters afterwards only read
+//! plain fields, without building settings keys or touching QSettings.
+void StyleAttributes::compile()
+{
+    QStringList style_names(m_store->childGroups());
+    style_names.removeAll("background");
+    style_names.removeAll("icon");
+    style_names.removeAll("sound");
+    style_names.removeAll("font");
+
+    if (not style_names.contains(g_default_style_name)) {
+        style_names.append(g_default_style_name);
+    }
+
+    Q_FOREACH (const QString &name, style_names) {
+        m_landscape_metrics.insert(name, compileMetrics(Logic::LayoutHelper::Landscape,
+                                                        name.toLocal8Bit()));
+        m_portrait_metrics.insert(name, compileMetrics(Logic::LayoutHelper::Portrait,
+                                                       name.toLocal8Bit()));
+    }
+
+    for (int style = Key::StyleNormalKey; style <= Key::StyleActivated; ++style) {
+        KeyBackgrounds *backgrounds(new KeyBackgrounds);
+
+        for (int state = KeyDescription::NormalState; state < KeyDescription::NumStates; ++state) {
+            QByteArray key("background/");
+            key.append(fromKeyStyle(static_cast<Key::Style>(style)));
+            key.append(fromKeyState(static_cast<KeyDescription::State>(state)));
+
+            backgrounds->backgrounds[state] = Atoms::intern(m_store->value(key).toByteArray());
+        }
+
+        m_key_backgrounds[style] = SharedKeyBackgrounds(backgrounds);
+    }
+
+    for (int state = KeyDescription::NormalState; state < KeyDescription::NumStates; ++state) {
+        const QByteArray &state_suffix(fromKeyState(static_cast<KeyDescription::State>(state)));
+
+        for (int icon = KeyDescription::NoIcon; icon <= KeyDescription::CustomIcon; ++icon) {
+            QByteArray key("icon/");
+            key.append(fromKeyIcon(static_cast<KeyDescription::Icon>(icon)));
+            key.append(state_suffix);
+
+            m_icons[icon][state] = m_store->value(key).toByteArray();
+        }
+    }
+
+    m_key_background_borders = fromByteArray(m_store->value("background/key-borders").toByteArray());
+}
+
+//! \brief Compiles the style attributes of one style section.
+//! @param orientation The layout orientation (landscape or portrait).
+//! @param style_name The style name, maps to INI file sections. Missing
+//!                   attributes are taken from the 'default' section.
+//! @returns The compiled, immutable style metrics.
+SharedStyleMetrics StyleAttributes::compileMetrics(Logic::LayoutHelper::Orientation orientation,
+                                                   const QByteArray &style_name) const
+{
+    StyleMetrics *m = new StyleMetrics;
+
+    m->font_name = lookup(m_store, orientation, style_name, "font-name").toByteArray();
+    if (m->font_name.isEmpty()) {
+        m->font_name = "Nokia Pure";
+    }
+
+    m->font_color = lookup(m_store, orientation, style_name, "font-color").toByteArray();
+    m->font_size = lookup(m_store, orientation, style_name, "font-size").toReal();
+    m->small_font_size = lookup(m_store, orientation, style_name, "small-font-size").toReal();
+    m->candidate_font_size = lookup(m_store, orientation, style_name, "candidate-font-size").toReal();
+    m->magnifier_font_size = lookup(m_store, orientation, style_name, "magnifier-font-size").toReal();
+    m->candidate_font_stretch = lookup(m_store, orientation, style_name, "candidate-font-stretch").toReal();
+
+    m->word_ribbon_height = lookup(m_store, orientation, style_name, "word-ribbon-height").toReal();
+    m->magnifier_key_height = lookup(m_store, orientation, style_name, "magnifier-key-height").toReal();
+    m->key_height = lookup(m_store, orientation, style_name, "key-height").toReal();
+    m->key_top_row_height = lookup(m_store, orientation, style_name, "key-top-row-height").toReal();
+    m->key_bottom_row_height = lookup(m_store, orientation, style_name, "key-bottom-row-height").toReal();
+
+    m->magnifier_key_width = lookup(m_store, orientation, style_name, "magnifier-key-width").toReal();
+    for (int width = KeyDescription::XXSmall; width <= KeyDescription::Stretched; ++width) {
+        m->key_widths[width] = lookup(m_store, orientation, style_name,
+                                      QByteArray("key-width").append(fromKeyWidth(static_cast<KeyDescription::Width>(width)))).toReal();
+    }
+    m->key_area_width = lookup(m_store, orientation, style_name, "key-area-width").toReal();
+
+    m->key_margin = lookup(m_store, orientation, style_name, "key-margins").toReal();
+    m->key_area_padding = lookup(m_store, orientation, style_name, "key-area-paddings").toReal();
+
+    m->vertical_offset = lookup(m_store, orientation, style_name, "vertical-offset").toReal();
+    m->magnifier_key_label_vertical_offset = lookup(m_store, orientation, style_name,
+                                                    "magnifier-key-label-vertical-offset").toReal();
+    m->safety_margin = lookup(m_store, orientation, style_name, "safety-margin").toReal();
+
+    return SharedStyleMetrics(m);
+}
+
 //! \brief Sets the active style name.
 //!
 //! Consider HTML and CSS, where HTML provides the input and CSS specifies
@@ -219,7 +335,53 @@ StyleAttributes::~StyleAttributes()
 //!             a section exists!
 void StyleAttributes::setStyleName(const QString &name)
 {
+    if (m_style_name == name && not m_active_landscape_metrics.isNull()) {
+        return;
+    }
+
     m_style_name = name;
+
+    // Unknown style names behave like the default section:
+    m_active_landscape_metrics = m_landscape_metrics.value(name, m_landscape_metrics.value(g_default_style_name));
+    m_active_portrait_metrics = m_portrait_metrics.value(name, m_portrait_metrics.value(g_default_style_name));
+}
+
+//! \brief Returns the active style name.
+QString StyleAttributes::styleName() const
+{
+    return m_style_name;
+}
+
+//! \brief Returns the file name of the settings store.
+//!
+//! Identifies style profile and attribute set (main or extended keys), and
+//! stays the same across Style instances loading the same profile.
+QString StyleAttributes::storeName() const
+{
+    return (m_store.isNull() ? QString() : m_store->fileName());
+}
+
+//! \brief Returns the compiled style metrics for the active style name.
+//!
+//! The returned snapshot is immutable and can be shared with other threads.
+//! @param orientation The layout orientation (landscape or portrait).
+SharedStyleMetrics StyleAttributes::metrics(Logic::LayoutHelper::Orientation orientation) const
+{
+    return (orientation == Logic::LayoutHelper::Landscape ? m_active_landscape_metrics
+                                                          : m_active_portrait_metrics);
+}
+
+//! \brief Returns the compiled style metrics for a given style name.
+//!
+//! Does not change the active style name.
+//! @param orientation The layout orientation (landscape or portrait).
+//! @param style_name The style name. Unknown names map to the default section.
+SharedStyleMetrics StyleAttributes::metrics(Logic::LayoutHelper::Orientation orientation,
+                                            const QString &style_name) const
+{
+    const QHash<QString, SharedStyleMetrics> &all(orientation == Logic::LayoutHelper::Landscape
+                                                  ? m_landscape_metrics : m_portrait_metrics);
+    return all.value(style_name, all.value(g_default_style_name));
 }
 
 //! \brief Looks up the background image name for word ribbons.
@@ -254,11 +416,25 @@ QByteArray StyleAttributes::magnifierKeyBackground() const
 QByteArray StyleAttributes::keyBackground(Key::Style style,
                                           KeyDescription::State state) const
 {
-    QByteArray key("background/");
-    key.append(fromKeyStyle(style));
-    key.append(fromKeyState(state));
+    if (style < Key::StyleNormalKey || style > Key::StyleActivated
+        || state < KeyDescription::NormalState || state >= KeyDescription::NumStates) {
+        return QByteArray();
+    }
 
-    return m_store->value(key).toByteArray();
+    return m_key_backgrounds[style]->backgrounds[state];
+}
+
+
+//! \brief Returns the background image names of a key style, for all key
+//!        states. Shared by all keys of that style.
+//! @param style The key style (normal, special, deadkey).
+SharedKeyBackgrounds StyleAttributes::keyBackgrounds(Key::Style style) const
+{
+    if (style < Key::StyleNormalKey || style > Key::StyleActivated) {
+        return SharedKeyBackgrounds();
+    }
+
+    return m_key_backgrounds[style];
 }
 
 
@@ -290,7 +466,7 @@ QMargins StyleAttributes::magnifierKeyBackgroundBorders() const
 //! @returns Value of "background\key-borders".
 QMargins StyleAttributes::keyBackgroundBorders() const
 {
-    return fromByteArray(m_store->value("background/key-borders").toByteArray());
+    return m_key_background_borders;
 }
 
 
@@ -301,11 +477,11 @@ QMargins StyleAttributes::keyBackgroundBorders() const
 QByteArray StyleAttributes::icon(KeyDescription::Icon icon,
                                  KeyDescription::State state) const
 {
-    QByteArray key("icon/");
-    key.append(fromKeyIcon(icon));
-    key.append(fromKeyState(state));
+    if (state < KeyDescription::NormalState || state >= KeyDescription::NumStates) {
+        return QByteArray();
+    }
 
-    return m_store->value(key).toByteArray();
+    return m_icons[icon][state];
 }
 
 
@@ -327,15 +503,7 @@ QByteArray StyleAttributes::customIcon(const QString &icon_name) const
 //! Pure" if there was no such value in style.ini.
 QByteArray StyleAttributes::fontName(Logic::LayoutHelper::Orientation orientation) const
 {
-    const QByteArray font_name(lookup(m_store, orientation,
-                                      m_style_name.toLocal8Bit(),
-                                      QByteArray("font-name")).toByteArray());
-
-    if (font_name.isEmpty()) {
-        return "Nokia Pure";
-    }
-
-    return font_name;
+    return metrics(orientation)->font_name;
 }
 
 
@@ -353,9 +521,7 @@ QStringList StyleAttributes::fontFiles() const
 //! @returns Value of "${style}\${orientation}\font-color".
 QByteArray StyleAttributes::fontColor(Logic::LayoutHelper::Orientation orientation) const
 {
-    return lookup(m_store, orientation,
-                  m_style_name.toLocal8Bit(),
-                  QByteArray("font-color")).toByteArray();
+    return metrics(orientation)->font_color;
 }
 
 
@@ -364,9 +530,7 @@ QByteArray StyleAttributes::fontColor(Logic::LayoutHelper::Orientation orientati
 //! @returns Value of "${style}\${orientation}\font-size".
 qreal StyleAttributes::fontSize(Logic::LayoutHelper::Orientation orientation) const
 {
-    return lookup(m_store, orientation,
-                  m_style_name.toLocal8Bit(),
-                  QByteArray("font-size")).toReal();
+    return metrics(orientation)->font_size;
 }
 
 
@@ -375,9 +539,7 @@ qreal StyleAttributes::fontSize(Logic::LayoutHelper::Orientation orientation) co
 //! @returns Value of "${style}\${orientation}\small-font-size".
 qreal StyleAttributes::smallFontSize(Logic::LayoutHelper::Orientation orientation) const
 {
-    return lookup(m_store, orientation,
-                  m_style_name.toLocal8Bit(),
-                  QByteArray("small-font-size")).toReal();
+    return metrics(orientation)->small_font_size;
 }
 
 
@@ -386,9 +548,7 @@ qreal StyleAttributes::smallFontSize(Logic::LayoutHelper::Orientation orientatio
 //! @returns Value of "${style}\${orientation}\candidates-font-size".
 qreal StyleAttributes::candidateFontSize(Logic::LayoutHelper::Orientation orientation) const
 {
-    return lookup(m_store, orientation,
-                  m_style_name.toLocal8Bit(),
-                  QByteArray("candidate-font-size")).toReal();
+    return metrics(orientation)->candidate_font_size;
 }
 
 
@@ -397,9 +557,7 @@ qreal StyleAttributes::candidateFontSize(Logic::LayoutHelper::Orientation orient
 //! @returns Value of "${style}\${orientation}\magnifier-font-size".
 qreal StyleAttributes::magnifierFontSize(Logic::LayoutHelper::Orientation orientation) const
 {
-    return lookup(m_store, orientation,
-                  m_style_name.toLocal8Bit(),
-                  QByteArray("magnifier-font-size")).toReal();
+    return metrics(orientation)->magnifier_font_size;
 }
 
 
@@ -412,9 +570,7 @@ qreal StyleAttributes::magnifierFontSize(Logic::LayoutHelper::Orientation orient
 //! @returns Value of "${style}\${orientation}\candidate-font-stretch".
 qreal StyleAttributes::candidateFontStretch(Logic::LayoutHelper::Orientation orientation) const
 {
-    return lookup(m_store, orientation,
-                  m_style_name.toLocal8Bit(),
-                  QByteArray("candidate-font-stretch")).toReal();
+    return metrics(orientation)->candidate_font_stretch;
 }
 
 
@@ -423,9 +579,7 @@ qreal StyleAttributes::candidateFontStretch(Logic::LayoutHelper::Orientation ori
 //! @returns Value of "${style}\${orientation}\word-ribbon-height".
 qreal StyleAttributes::wordRibbonHeight(Logic::LayoutHelper::Orientation orientation) const
 {
-    return lookup(m_store, orientation,
-                  m_style_name.toLocal8Bit(),
-                  QByteArray("word-ribbon-height")).toReal();
+    return metrics(orientation)->word_ribbon_height;
 }
 
 
@@ -434,9 +588,7 @@ qreal StyleAttributes::wordRibbonHeight(Logic::LayoutHelper::Orientation orienta
 //! @returns Value of "${style}\${orientation}\magnifier-key-height".
 qreal StyleAttributes::magnifierKeyHeight(Logic::LayoutHelper::Orientation orientation) const
 {
-    return lookup(m_store, orientation,
-                  m_style_name.toLocal8Bit(),
-                  QByteArray("magnifier-key-height")).toReal();
+    return metrics(orientation)->magnifier_key_height;
 }
 
 
@@ -445,9 +597,7 @@ qreal StyleAttributes::magnifierKeyHeight(Logic::LayoutHelper::Orientation orien
 //! @returns Value of "${style}\${orientation}\key-height".
 qreal StyleAttributes::keyHeight(Logic::LayoutHelper::Orientation orientation) const
 {
-    return lookup(m_store, orientation,
-                  m_style_name.toLocal8Bit(),
-                  QByteArray("key-height")).toReal();
+    return metrics(orientation)->key_height;
 }
 
 
@@ -456,9 +606,7 @@ qreal StyleAttributes::keyHeight(Logic::LayoutHelper::Orientation orientation) c
 //! @returns Value of "${style}\${orientation}\key-height".
 qreal StyleAttributes::keyTopRowHeight(Logic::LayoutHelper::Orientation orientation) const
 {
-    return lookup(m_store, orientation,
-                  m_style_name.toLocal8Bit(),
-                  QByteArray("key-top-row-height")).toReal();
+    return metrics(orientation)->key_top_row_height;
 }
 
 
@@ -467,9 +615,7 @@ qreal StyleAttributes::keyTopRowHeight(Logic::LayoutHelper::Orientation orientat
 //! @returns Value of "${style}\${orientation}\key-height".
 qreal StyleAttributes::keyBottomRowHeight(Logic::LayoutHelper::Orientation orientation) const
 {
-    return lookup(m_store, orientation,
-                  m_style_name.toLocal8Bit(),
-                  QByteArray("key-bottom-row-height")).toReal();
+    return metrics(orientation)->key_bottom_row_height;
 }
 
 
@@ -478,9 +624,7 @@ qreal StyleAttributes::keyBottomRowHeight(Logic::LayoutHelper::Orientation orien
 //! @returns Value of "${style}\${orientation}\magnifier-key-width".
 qreal StyleAttributes::magnifierKeyWidth(Logic::LayoutHelper::Orientation orientation) const
 {
-    return lookup(m_store, orientation,
-                  m_style_name.toLocal8Bit(),
-                  QByteArray("magnifier-key-width")).toReal();
+    return metrics(orientation)->magnifier_key_width;
 }
 
 
@@ -491,9 +635,7 @@ qreal StyleAttributes::magnifierKeyWidth(Logic::LayoutHelper::Orientation orient
 qreal StyleAttributes::keyWidth(Logic::LayoutHelper::Orientation orientation,
                                 KeyDescription::Width width) const
 {
-    return lookup(m_store, orientation,
-                  m_style_name.toLocal8Bit(),
-                  QByteArray("key-width").append(fromKeyWidth(width))).toReal();
+    return metrics(orientation)->key_widths[width];
 }
 
 
@@ -502,9 +644,7 @@ qreal StyleAttributes::keyWidth(Logic::LayoutHelper::Orientation orientation,
 //! @returns Value of "${style}\${orientation}\key-area-width".
 qreal StyleAttributes::keyAreaWidth(Logic::LayoutHelper::Orientation orientation) const
 {
-    return lookup(m_store, orientation,
-                  m_style_name.toLocal8Bit(),
-                  QByteArray("key-area-width")).toReal();
+    return metrics(orientation)->key_area_width;
 }
 
 
@@ -517,9 +657,7 @@ qreal StyleAttributes::keyAreaWidth(Logic::LayoutHelper::Orientation orientation
 //! @returns Value of "${style}\${orientation}\key-margins".
 qreal StyleAttributes::keyMargin(Logic::LayoutHelper::Orientation orientation) const
 {
-    return lookup(m_store, orientation,
-                  m_style_name.toLocal8Bit(),
-                  QByteArray("key-margins")).toReal();
+    return metrics(orientation)->key_margin;
 }
 
 //! \brief Looks up the key area paddings.
@@ -532,9 +670,7 @@ qreal StyleAttributes::keyMargin(Logic::LayoutHelper::Orientation orientation) c
 //! @returns Value of "${style}\${orientation}\key-area-paddings".
 qreal StyleAttributes::keyAreaPadding(Logic::LayoutHelper::Orientation orientation) const
 {
-    return lookup(m_store, orientation,
-                  m_style_name.toLocal8Bit(),
-                  QByteArray("key-area-paddings")).toReal();
+    return metrics(orientation)->key_area_padding;
 }
 
 
@@ -546,9 +682,7 @@ qreal StyleAttributes::keyAreaPadding(Logic::LayoutHelper::Orientation orientati
 //! @returns Value of "${style}\${orientation}\vertical-offset".
 qreal StyleAttributes::verticalOffset(Logic::LayoutHelper::Orientation orientation) const
 {
-    return lookup(m_store, orientation,
-                  m_style_name.toLocal8Bit(),
-                  QByteArray("vertical-offset")).toReal();
+    return metrics(orientation)->vertical_offset;
 }
 
 
@@ -557,9 +691,7 @@ qreal StyleAttributes::verticalOffset(Logic::LayoutHelper::Orientation orientati
 //! @returns Value of "${style}\${orientation}\magnifier-key-label-vertical-offset".
 qreal StyleAttributes::magnifierKeyLabelVerticalOffset(Logic::LayoutHelper::Orientation orientation) const
 {
-    return lookup(m_store, orientation,
-                  m_style_name.toLocal8Bit(),
-                  QByteArray("magnifier-key-label-vertical-offset")).toReal();
+    return metrics(orientation)->magnifier_key_label_vertical_offset;
 }
 
 
@@ -571,9 +703,7 @@ qreal StyleAttributes::magnifierKeyLabelVerticalOffset(Logic::LayoutHelper::Orie
 //! @returns Value of "${style}\${orientation}\safety-margin".
 qreal StyleAttributes::safetyMargin(Logic::LayoutHelper::Orientation orientation) const
 {
-    return lookup(m_store, orientation,
-                  m_style_name.toLocal8Bit(),
-                  QByteArray("safety-margin")).toReal();
+    return metrics(orientation)->safety_margin;
 }
 
 
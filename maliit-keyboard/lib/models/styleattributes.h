@@ -34,6 +34,7 @@
 #define MALIIT_KEYBOARD_STYLEATTRIBUTES_H
 
 #include "models/keydescription.h"
+#include "models/stylemetrics.h"
 #include "logic/layouthelper.h"
 
 #include <QtCore>
@@ -45,17 +46,34 @@ class StyleAttributes
 private:
     const QScopedPointer<const QSettings> m_store;
     QString m_style_name;
+    QHash<QString, SharedStyleMetrics> m_landscape_metrics;
+    QHash<QString, SharedStyleMetrics> m_portrait_metrics;
+    SharedStyleMetrics m_active_landscape_metrics;
+    SharedStyleMetrics m_active_portrait_metrics;
+    SharedKeyBackgrounds m_key_backgrounds[Key::StyleActivated + 1];
+    QByteArray m_icons[KeyDescription::CustomIcon + 1][KeyDescription::NumStates];
+    QMargins m_key_background_borders;
+
+    void compile();
+    SharedStyleMetrics compileMetrics(Logic::LayoutHelper::Orientation orientation,
+                                      const QByteArray &style_name) const;
 
 public:
     explicit StyleAttributes(const QSettings *store);
     virtual ~StyleAttributes();
 
     virtual void setStyleName(const QString &name);
+    QString styleName() const;
+    QString storeName() const;
+    SharedStyleMetrics metrics(Logic::LayoutHelper::Orientation orientation) const;
+    SharedStyleMetrics metrics(Logic::LayoutHelper::Orientation orientation,
+                               const QString &style_name) const;
     QByteArray wordRibbonBackground() const;
     QByteArray keyAreaBackground() const;
     QByteArray magnifierKeyBackground() const;
     QByteArray keyBackground(Key::Style style,
                              KeyDescription::State state) const;
+    SharedKeyBackgrounds keyBackgrounds(Key::Style style) const;
 
     QMargins wordRibbonBackgroundBorders() const;
     QMargins keyAreaBackgroundBorders() const;
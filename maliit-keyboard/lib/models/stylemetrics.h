@@ -0,0 +1,76 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef MALIIT_KEYBOARD_STYLEMETRICS_H
+#define MALIIT_KEYBOARD_STYLEMETRICS_H
+
+#include "models/keydescription.h"
+
+#include <QtCore>
+
+namespace MaliitKeyboard {
+
+//! Typed style attributes for one style name and one orientation. Compiled
+//! once from the style INI file, never modified afterwards and therefore
+//! safe to share between threads.
+struct StyleMetrics
+{
+    QByteArray font_name;
+    QByteArray font_color;
+    qreal font_size;
+    qreal small_font_size;
+    qreal candidate_font_size;
+    qreal magnifier_font_size;
+    qreal candidate_font_stretch;
+
+    qreal word_ribbon_height;
+    qreal magnifier_key_height;
+    qreal key_height;
+    qreal key_top_row_height;
+    qreal key_bottom_row_height;
+
+    qreal magnifier_key_width;
+    qreal key_widths[KeyDescription::Stretched + 1];
+    qreal key_area_width;
+
+    qreal key_margin;
+    qreal key_area_padding;
+
+    qreal vertical_offset;
+    qreal magnifier_key_label_vertical_offset;
+    qreal safety_margin;
+};
+
+typedef QSharedPointer<const StyleMetrics> SharedStyleMetrics;
+
+} // namespace MaliitKeyboard
+
+#endif // MALIIT_KEYBOARD_STYLEMETRICS_H
@@ -40,6 +40,13 @@
 
 namespace MaliitKeyboard {
 namespace Model {
+namespace {
+
+// Upper bound for surroundingContext, so that a single huge "word" (think
+// of a pasted URL or a base64 blob) cannot make the scan unbounded again.
+const int g_max_context_length = 256;
+
+} // namespace
 
 //! C'tor
 Text::Text()
@@ -130,6 +137,38 @@ QString Text::surroundingRight() const
     return m_surrounding.mid(m_surrounding_offset);
 }
 
+//! Returns a view on the tail of the text left of cursor position,
+//! covering at most the last \a max_words words (and never more than a
+//! fixed number of characters). Meant for prediction backends, which only
+//! look at the last few words anyway; the cost of this call depends on
+//! the size of the tail, not on the size of the surrounding text.
+//! \param max_words maximum number of words to include.
+QStringRef Text::surroundingContext(int max_words) const
+{
+    const int end(qMin<int>(m_surrounding_offset, m_surrounding.length()));
+    const int limit(qMax(0, end - g_max_context_length));
+    const QChar *data(m_surrounding.constData());
+    int words(0);
+    int begin(end);
+    bool in_word(false);
+
+    for (; begin > limit; --begin) {
+        const bool is_space(data[begin - 1].isSpace());
+
+        if (not is_space and not in_word) {
+            if (words == max_words) {
+                break;
+            }
+
+            ++words;
+        }
+
+        in_word = not is_space;
+    }
+
+    return m_surrounding.midRef(begin, end - begin);
+}
+
 //! Set text surrounding cursor position.
 //! \param surrounding the updated surrounding text.
 void Text::setSurrounding(const QString &surrounding)
@@ -72,6 +72,7 @@ public:
     QString surrounding() const;
     QString surroundingLeft() const;
     QString surroundingRight() const;
+    QStringRef surroundingContext(int max_words) const;
     void setSurrounding(const QString &surrounding);
 
     uint surroundingOffset() const;
@@ -0,0 +1,301 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+#include "tracing.h"
+
+//! \namespace MaliitKeyboard::Tracing
+//! \brief Lightweight trace points for measuring keystroke latency.
+//!
+//! Trace points record a static name, a phase and a monotonic timestamp into
+//! a ring buffer owned by the calling thread, so recording never takes a
+//! lock and never allocates (except for the first event of a thread). When
+//! tracing is disabled, which is the default, a trace point only tests a
+//! flag. The buffers can be written out in the Chrome trace event format,
+//! to be viewed in chrome://tracing or similar tools, which shows each
+//! stage from touch to host commit and frame swap on a per-thread timeline.
+//!
+//! Each thread only keeps its last capacity() events. Dumping copies the
+//! buffers without stopping the writers. Events that got overwritten while
+//! copying are left out, so a dump taken under load can miss the oldest
+//! events of a busy thread.
+
+namespace MaliitKeyboard {
+namespace Tracing {
+namespace {
+
+const int g_slots(8192); // Must be a power of two.
+const int g_capacity(g_slots - 1); // One slot for the event being written.
+bool g_enabled(false);
+
+struct Event
+{
+    const char *name;
+    char phase;
+    qint64 timestamp; // in ns
+};
+
+struct Ring
+{
+    int tid;
+    QString thread_name;
+    QAtomicInt written;
+    Event events[g_slots];
+};
+
+// Owned by the registry, not by the thread, so that events of finished
+// threads can still be dumped.
+struct RingReference
+{
+    Ring *ring;
+};
+
+class Registry
+{
+public:
+    QMutex mutex;
+    QList<Ring *> rings;
+    QElapsedTimer clock;
+    QThreadStorage<RingReference *> current;
+
+    explicit Registry()
+        : mutex()
+        , rings()
+        , clock()
+        , current()
+    {
+        clock.start();
+    }
+
+    ~Registry()
+    {
+        qDeleteAll(rings);
+    }
+};
+
+Registry *registry()
+{
+    static Registry instance;
+    return &instance;
+}
+
+Ring *currentRing(Registry *r)
+{
+    if (not r->current.hasLocalData()) {
+        Ring *ring(new Ring);
+        QThread *thread(QThread::currentThread());
+
+        QMutexLocker locker(&r->mutex);
+        ring->tid = r->rings.count() + 1;
+        ring->thread_name = thread->objectName();
+
+        if (ring->thread_name.isEmpty()) {
+            const bool is_main(QCoreApplication::instance()
+                               and QCoreApplication::instance()->thread() == thread);
+            ring->thread_name = (is_main ? QString("main") : QString("thread %1").arg(ring->tid));
+        }
+
+        r->rings.append(ring);
+
+        RingReference *reference(new RingReference);
+        reference->ring = ring;
+        r->current.setLocalData(reference);
+    }
+
+    return r->current.localData()->ring;
+}
+
+void record(const char *name,
+            char phase)
+{
+    if (not g_enabled) {
+        return;
+    }
+
+    Registry *r(registry());
+    Ring *ring(currentRing(r));
+
+    // Only this thread writes, the release makes the event visible to dumps.
+    const int index(ring->written.fetchAndAddRelaxed(0));
+    Event &event(ring->events[index & (g_slots - 1)]);
+    event.name = name;
+    event.phase = phase;
+    event.timestamp = r->clock.nsecsElapsed();
+    ring->written.fetchAndAddRelease(1);
+}
+
+QByteArray escaped(const QString &text)
+{
+    QByteArray result(text.toUtf8());
+    result.replace('\\', "\\\\");
+    result.replace('"', "\\\"");
+    return result;
+}
+
+} // namespace
+
+//! \brief Enables or disables all trace points.
+//!
+//! Meant to be called once at startup, before the traced threads run.
+void setEnabled(bool enabled)
+{
+    if (enabled) {
+        // Starts the clock before the first event.
+        registry();
+    }
+
+    g_enabled = enabled;
+}
+
+bool isEnabled()
+{
+    return g_enabled;
+}
+
+//! \brief Marks the start of a stage. Prefer MALIIT_TRACE_SCOPE.
+//! \param name A string literal; only the pointer gets stored.
+void begin(const char *name)
+{
+    record(name, 'B');
+}
+
+//! \brief Marks the end of a stage started with begin().
+void end(const char *name)
+{
+    record(name, 'E');
+}
+
+//! \brief Marks a single point in time, such as a frame swap.
+void instant(const char *name)
+{
+    record(name, 'i');
+}
+
+//! \brief Returns how many events each thread keeps.
+int capacity()
+{
+    return g_capacity;
+}
+
+//! \brief Returns the number of events currently kept, over all threads.
+int eventCount()
+{
+    Registry *r(registry());
+    QMutexLocker locker(&r->mutex);
+    int count(0);
+
+    Q_FOREACH (Ring *ring, r->rings) {
+        count += qMin(ring->written.fetchAndAddAcquire(0), g_capacity);
+    }
+
+    return count;
+}
+
+//! \brief Drops all recorded events. Must not be called while tracing.
+void clear()
+{
+    Registry *r(registry());
+    QMutexLocker locker(&r->mutex);
+
+    Q_FOREACH (Ring *ring, r->rings) {
+        ring->written.fetchAndStoreRelease(0);
+    }
+}
+
+//! \brief Writes all kept events as Chrome trace event JSON.
+//! \param device An open, writable device.
+bool writeChromeTrace(QIODevice *device)
+{
+    if (not device or not device->isWritable()) {
+        return false;
+    }
+
+    Registry *r(registry());
+    QMutexLocker locker(&r->mutex);
+    const QByteArray pid(QByteArray::number(QCoreApplication::applicationPid()));
+    QByteArray json("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    bool first(true);
+
+    Q_FOREACH (Ring *ring, r->rings) {
+        const QByteArray tid(QByteArray::number(ring->tid));
+
+        json.append(first ? "" : ",");
+        json.append("\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" + pid
+                    + ",\"tid\":" + tid
+                    + ",\"args\":{\"name\":\"" + escaped(ring->thread_name) + "\"}}");
+        first = false;
+
+        // Copy first, then drop what the writer might have overwritten
+        // meanwhile:
+        const int written(ring->written.fetchAndAddAcquire(0));
+        const int begin(qMax(0, written - g_capacity));
+        QVector<Event> events;
+        events.reserve(written - begin);
+
+        for (int index = begin; index < written; ++index) {
+            events.append(ring->events[index & (g_slots - 1)]);
+        }
+
+        const int rewritten(ring->written.fetchAndAddAcquire(0));
+        const int first_valid(qMax(begin, rewritten - g_capacity));
+
+        for (int index = first_valid; index < written; ++index) {
+            const Event &event(events.at(index - begin));
+
+            json.append(",\n{\"name\":\"" + QByteArray(event.name)
+                        + "\",\"cat\":\"maliit-keyboard\",\"ph\":\"" + QByteArray(1, event.phase)
+                        + "\",\"ts\":" + QByteArray::number(event.timestamp / 1000.0, 'f', 3)
+                        + ",\"pid\":" + pid
+                        + ",\"tid\":" + tid
+                        + (event.phase == 'i' ? ",\"s\":\"t\"}" : "}"));
+        }
+    }
+
+    json.append("\n]}\n");
+    return (device->write(json) == json.size());
+}
+
+//! \brief Writes all kept events as Chrome trace event JSON.
+//! \param file_name The file to (over)write.
+bool dumpChromeTrace(const QString &file_name)
+{
+    QFile file(file_name);
+
+    if (not file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << __PRETTY_FUNCTION__
+                   << "Could not open trace file:" << file_name;
+        return false;
+    }
+
+    return writeChromeTrace(&file);
+}
+
+}} // namespace Tracing, MaliitKeyboard
@@ -0,0 +1,80 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+#ifndef MALIIT_KEYBOARD_TRACING_H
+#define MALIIT_KEYBOARD_TRACING_H
+
+#include <QtCore>
+
+namespace MaliitKeyboard {
+namespace Tracing {
+
+void setEnabled(bool enabled);
+bool isEnabled();
+
+void begin(const char *name);
+void end(const char *name);
+void instant(const char *name);
+
+int capacity();
+int eventCount();
+void clear();
+
+bool writeChromeTrace(QIODevice *device);
+bool dumpChromeTrace(const QString &file_name);
+
+class Scope
+{
+    Q_DISABLE_COPY(Scope)
+
+public:
+    explicit Scope(const char *name)
+        : m_name(name)
+    {
+        begin(m_name);
+    }
+
+    ~Scope()
+    {
+        end(m_name);
+    }
+
+private:
+    const char * const m_name;
+};
+
+}} // namespace Tracing, MaliitKeyboard
+
+#define MALIIT_TRACE_SCOPE(name) \
+    const MaliitKeyboard::Tracing::Scope maliit_trace_scope(name)
+
+#endif // MALIIT_KEYBOARD_TRACING_H
@@ -0,0 +1,265 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+#include "wakeupmonitor.h"
+
+namespace MaliitKeyboard {
+namespace {
+
+QString sourceName(const QObject *object)
+{
+    if (not object->objectName().isEmpty()) {
+        return object->objectName();
+    }
+
+    // Anonymous timers are attributed to their owner, if they have one:
+    const QObject *owner(object->parent() ? object->parent() : object);
+    return QString::fromLatin1(owner->metaObject()->className());
+}
+
+} // namespace
+
+//! \class WakeupMonitor
+//! \brief Counts event loop wakeups of the main thread, while the keyboard
+//! is shown and while it is hidden.
+//!
+//! Each time the event dispatcher wakes up counts as one wakeup, and timer
+//! events are additionally counted by source: the timer's object name, or
+//! the class name of its owner. Give timers that matter an object name to
+//! tell them apart. Together with duration(), this gives wakeups per second
+//! for each phase; a hidden keyboard is expected to have none of its own.
+//!
+//! Disabled by default, in which case it does not install anything.
+
+class WakeupMonitorPrivate
+{
+public:
+    bool enabled;
+    WakeupMonitor::Phase phase;
+    QElapsedTimer clock;
+    qint64 durations[WakeupMonitor::PhaseCount];
+    int wakeups[WakeupMonitor::PhaseCount];
+    QHash<QString, int> timer_wakeups[WakeupMonitor::PhaseCount];
+
+    explicit WakeupMonitorPrivate()
+        : enabled(false)
+        , phase(WakeupMonitor::Hidden)
+        , clock()
+    {
+        clear();
+    }
+
+    void clear()
+    {
+        for (int index = 0; index < WakeupMonitor::PhaseCount; ++index) {
+            durations[index] = 0;
+            wakeups[index] = 0;
+            timer_wakeups[index].clear();
+        }
+
+        clock.start();
+    }
+
+    // Returns the time spent in the given phase, including the current one.
+    qint64 duration(WakeupMonitor::Phase p) const
+    {
+        return (durations[p] + (p == phase ? clock.elapsed() : 0));
+    }
+};
+
+//! \param parent The owner of this instance. Can be 0, in case QObject
+//!               ownership is not required.
+WakeupMonitor::WakeupMonitor(QObject *parent)
+    : QObject(parent)
+    , d_ptr(new WakeupMonitorPrivate)
+{}
+
+WakeupMonitor::~WakeupMonitor()
+{
+    setEnabled(false);
+}
+
+bool WakeupMonitor::isEnabled() const
+{
+    Q_D(const WakeupMonitor);
+    return d->enabled;
+}
+
+//! \brief Starts or stops counting. Must be called from the main thread,
+//! after the application object was created.
+void WakeupMonitor::setEnabled(bool enabled)
+{
+    Q_D(WakeupMonitor);
+
+    QCoreApplication *const app(QCoreApplication::instance());
+
+    if (d->enabled == enabled || not app) {
+        return;
+    }
+
+    d->enabled = enabled;
+    QAbstractEventDispatcher *const dispatcher(QAbstractEventDispatcher::instance(app->thread()));
+
+    if (enabled) {
+        app->installEventFilter(this);
+
+        if (dispatcher) {
+            connect(dispatcher, SIGNAL(awake()),
+                    this,       SLOT(onAwake()),
+                    Qt::DirectConnection);
+        }
+    } else {
+        app->removeEventFilter(this);
+
+        if (dispatcher) {
+            disconnect(dispatcher, SIGNAL(awake()),
+                       this,       SLOT(onAwake()));
+        }
+    }
+}
+
+WakeupMonitor::Phase WakeupMonitor::phase() const
+{
+    Q_D(const WakeupMonitor);
+    return d->phase;
+}
+
+//! \brief Attributes wakeups from now on to \a phase.
+void WakeupMonitor::setPhase(Phase phase)
+{
+    Q_D(WakeupMonitor);
+
+    if (d->phase == phase || phase == PhaseCount) {
+        return;
+    }
+
+    d->durations[d->phase] += d->clock.restart();
+    d->phase = phase;
+}
+
+//! \brief Returns how often the event loop woke up during \a phase.
+int WakeupMonitor::wakeups(Phase phase) const
+{
+    Q_D(const WakeupMonitor);
+    return (phase < PhaseCount ? d->wakeups[phase] : 0);
+}
+
+//! \brief Returns how many timer events were delivered during \a phase.
+int WakeupMonitor::timerWakeups(Phase phase) const
+{
+    int count(0);
+    const QHash<QString, int> &by_source(timerWakeupsBySource(phase));
+
+    for (QHash<QString, int>::const_iterator it = by_source.constBegin();
+         it != by_source.constEnd();
+         ++it) {
+        count += it.value();
+    }
+
+    return count;
+}
+
+//! \brief Returns how many timer events \a source received during \a phase.
+int WakeupMonitor::timerWakeups(Phase phase,
+                                const QString &source) const
+{
+    return timerWakeupsBySource(phase).value(source);
+}
+
+QHash<QString, int> WakeupMonitor::timerWakeupsBySource(Phase phase) const
+{
+    Q_D(const WakeupMonitor);
+    return (phase < PhaseCount ? d->timer_wakeups[phase] : QHash<QString, int>());
+}
+
+//! \brief Returns the time spent in \a phase since the last reset, in ms.
+qint64 WakeupMonitor::duration(Phase phase) const
+{
+    Q_D(const WakeupMonitor);
+    return (phase < PhaseCount ? d->duration(phase) : 0);
+}
+
+void WakeupMonitor::reset()
+{
+    Q_D(WakeupMonitor);
+    d->clear();
+}
+
+//! \brief Returns wakeups per second, for each phase and timer source.
+QString WakeupMonitor::report() const
+{
+    static const char *const names[PhaseCount] = {"shown", "hidden"};
+    QString result;
+
+    for (int index = 0; index < PhaseCount; ++index) {
+        const Phase p(static_cast<Phase>(index));
+        const double seconds(qMax<qint64>(1, duration(p)) / 1000.0);
+
+        result.append(QString("%1: %2 s, %3 wakeups/s\n")
+                      .arg(names[index])
+                      .arg(seconds, 0, 'f', 1)
+                      .arg(wakeups(p) / seconds, 0, 'f', 2));
+
+        const QHash<QString, int> by_source(timerWakeupsBySource(p));
+
+        for (QHash<QString, int>::const_iterator it = by_source.constBegin();
+             it != by_source.constEnd();
+             ++it) {
+            result.append(QString("    %1: %2 timer events/s\n")
+                          .arg(it.key())
+                          .arg(it.value() / seconds, 0, 'f', 2));
+        }
+    }
+
+    return result;
+}
+
+bool WakeupMonitor::eventFilter(QObject *watched,
+                                QEvent *event)
+{
+    Q_D(WakeupMonitor);
+
+    if (event->type() == QEvent::Timer
+        && watched->thread() == thread()) {
+        ++d->timer_wakeups[d->phase][sourceName(watched)];
+    }
+
+    return QObject::eventFilter(watched, event);
+}
+
+void WakeupMonitor::onAwake()
+{
+    Q_D(WakeupMonitor);
+    ++d->wakeups[d->phase];
+}
+
+} // namespace MaliitKeyboard
@@ -0,0 +1,88 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+#ifndef MALIIT_KEYBOARD_WAKEUPMONITOR_H
+#define MALIIT_KEYBOARD_WAKEUPMONITOR_H
+
+#include <QtCore>
+
+namespace MaliitKeyboard {
+
+class WakeupMonitorPrivate;
+
+class WakeupMonitor
+    : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(WakeupMonitor)
+    Q_DECLARE_PRIVATE(WakeupMonitor)
+
+public:
+    enum Phase {
+        Shown,
+        Hidden,
+        PhaseCount
+    };
+
+    explicit WakeupMonitor(QObject *parent = 0);
+    virtual ~WakeupMonitor();
+
+    bool isEnabled() const;
+    void setEnabled(bool enabled);
+
+    Phase phase() const;
+    void setPhase(Phase phase);
+
+    int wakeups(Phase phase) const;
+    int timerWakeups(Phase phase) const;
+    int timerWakeups(Phase phase,
+                     const QString &source) const;
+    QHash<QString, int> timerWakeupsBySource(Phase phase) const;
+    qint64 duration(Phase phase) const;
+
+    void reset();
+    QString report() const;
+
+    //! \reimp
+    virtual bool eventFilter(QObject *watched,
+                             QEvent *event);
+    //! \reimp_end
+
+private:
+    Q_SLOT void onAwake();
+
+    const QScopedPointer<WakeupMonitorPrivate> d_ptr;
+};
+
+} // namespace MaliitKeyboard
+
+#endif // MALIIT_KEYBOARD_WAKEUPMONITOR_H
@@ -32,9 +32,9 @@
 
 #include "models/text.h"
 #include "editor.h"
+#include "tracing.h"
 
 #include <QtGui/QKeyEvent>
-#include <QTimer>
 #include <maliit/namespace.h>
 
 namespace MaliitKeyboard {
@@ -52,74 +52,228 @@ QEvent::Type toQEventType(Logic::AbstractTextEditor::KeyState state)
 
 }
 
+//! \class Editor
+//! \brief Text editor that talks to the application through the input method
+//! host.
+//!
+//! Every host call is a round trip to the application. With batching
+//! enabled, host operations are queued and sent at the end of the current
+//! event loop turn, see flush(). Redundant operations get merged while
+//! queued:
+//! - a preedit update supersedes the previous one,
+//! - a commit drops the preedit update before it, as committing replaces
+//!   the preedit anyway, and gets appended to a preceding commit,
+//! - identical key presses share one queue entry that counts them, which
+//!   only happens when auto-repeat outpaces the event loop. Each counted
+//!   press still reaches the application.
+//! Preedit updates that replace surrounding text are never dropped.
+
+Editor::HostOperation::HostOperation(Type new_type)
+    : type(new_type)
+    , text()
+    , face(Model::Text::PreeditDefault)
+    , replacement()
+    , key_sequence()
+    , key_state(KeyStatePressed)
+    , key(Qt::Key_unknown)
+    , modifier(Qt::NoModifier)
+    , repeat_count(1)
+{}
+
 Editor::Editor(Model::Text *text,
                Logic::AbstractWordEngine *word_engine,
                Logic::AbstractLanguageFeatures *language_features,
                QObject *parent)
     : AbstractTextEditor(text, word_engine, language_features, parent)
     , m_host(0)
-{}
+    , m_batching_enabled(false)
+    , m_pending_operations()
+    , m_flush_timer("Editor::flush")
+{
+    connect(&m_flush_timer, SIGNAL(timeout()),
+            this,           SLOT(flush()));
+}
 
 Editor::~Editor()
 {}
 
 void Editor::setHost(MAbstractInputMethodHost *host)
 {
+    flush();
     m_host = host;
 }
 
-void Editor::sendPreeditString(const QString &preedit,
-                               Model::Text::PreeditFace face,
-                               const Replacement &replacement)
+//! \brief Sets whether host operations are queued until the end of the
+//! current event loop turn. Disabled by default.
+void Editor::setBatchingEnabled(bool enabled)
 {
-    if (not m_host) {
-        qWarning() << __PRETTY_FUNCTION__
-                   << "Host not set, ignoring.";
+    if (m_batching_enabled != enabled) {
+        flush();
+        m_batching_enabled = enabled;
     }
+}
 
-    QList<Maliit::PreeditTextFormat> format_list;
-    const int start (0);
-    const int length (preedit.length());
+bool Editor::isBatchingEnabled() const
+{
+    return m_batching_enabled;
+}
 
-    format_list.append(Maliit::PreeditTextFormat(start,
-                                                 length,
-                                                 static_cast< ::Maliit::PreeditFace>(face)));
+//! \brief Returns how many host operations are queued, after merging.
+int Editor::pendingOperationCount() const
+{
+    return m_pending_operations.count();
+}
+
+//! \brief Sends all queued host operations now.
+void Editor::flush()
+{
+    m_flush_timer.stop();
+
+    if (m_pending_operations.isEmpty()) {
+        return;
+    }
+
+    MALIIT_TRACE_SCOPE("Editor::flush");
+
+    QList<HostOperation> operations;
+    operations.swap(m_pending_operations);
+
+    Q_FOREACH (const HostOperation &operation, operations) {
+        deliver(operation);
+    }
+}
+
+void Editor::sendPreeditString(const QString &preedit,
+                               Model::Text::PreeditFace face,
+                               const Replacement &replacement)
+{
+    MALIIT_TRACE_SCOPE("Editor::sendPreeditString");
 
-    m_host->sendPreeditString(preedit, format_list, replacement.start,
-                              replacement.length, replacement.cursor_position);
+    HostOperation operation(HostOperation::PreeditOperation);
+    operation.text = preedit;
+    operation.face = face;
+    operation.replacement = replacement;
+    enqueue(operation);
 }
 
 void Editor::sendCommitString(const QString &commit)
 {
-    if (not m_host) {
-        qWarning() << __PRETTY_FUNCTION__
-                   << "Host not set, ignoring.";
-    }
+    MALIIT_TRACE_SCOPE("Editor::sendCommitString");
 
-    m_host->sendCommitString(commit);
+    HostOperation operation(HostOperation::CommitOperation);
+    operation.text = commit;
+    enqueue(operation);
 }
 
 void Editor::sendKeyEvent(KeyState state,
                           Qt::Key key,
                           Qt::KeyboardModifier modifier)
 {
-    if (not m_host) {
-        qWarning() << __PRETTY_FUNCTION__
-                     << "Host not set, ignoring.";
-    }
-
-    m_host->sendKeyEvent(QKeyEvent(toQEventType(state), key, modifier));
+    HostOperation operation(HostOperation::KeyEventOperation);
+    operation.key_state = state;
+    operation.key = key;
+    operation.modifier = modifier;
+    enqueue(operation);
 }
 
 void Editor::invokeAction(const QString &action,
                           const QString &key_sequence)
+{
+    HostOperation operation(HostOperation::ActionOperation);
+    operation.text = action;
+    operation.key_sequence = key_sequence;
+    enqueue(operation);
+}
+
+void Editor::enqueue(const HostOperation &operation)
+{
+    if (not m_batching_enabled) {
+        deliver(operation);
+        return;
+    }
+
+    if (not m_pending_operations.isEmpty()) {
+        HostOperation &last(m_pending_operations.last());
+        const bool last_is_plain_preedit(last.type == HostOperation::PreeditOperation
+                                         && last.replacement.start == 0
+                                         && last.replacement.length == 0);
+
+        switch (operation.type) {
+        case HostOperation::PreeditOperation:
+            if (last_is_plain_preedit) {
+                last = operation;
+                return;
+            }
+            break;
+
+        case HostOperation::CommitOperation:
+            if (last_is_plain_preedit) {
+                m_pending_operations.removeLast();
+            }
+
+            if (not m_pending_operations.isEmpty()
+                && m_pending_operations.last().type == HostOperation::CommitOperation) {
+                m_pending_operations.last().text.append(operation.text);
+                return;
+            }
+            break;
+
+        case HostOperation::KeyEventOperation:
+            if (last.type == HostOperation::KeyEventOperation
+                && last.key_state == KeyStatePressed
+                && operation.key_state == KeyStatePressed
+                && last.key == operation.key
+                && last.modifier == operation.modifier) {
+                ++last.repeat_count;
+                return;
+            }
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    m_pending_operations.append(operation);
+    m_flush_timer.schedule();
+}
+
+void Editor::deliver(const HostOperation &operation)
 {
     if (not m_host) {
         qWarning() << __PRETTY_FUNCTION__
-                     << "Host not set, ignoring.";
+                   << "Host not set, ignoring.";
+        return;
     }
 
-    m_host->invokeAction(action, QKeySequence::fromString(key_sequence));
+    switch (operation.type) {
+    case HostOperation::PreeditOperation: {
+        QList<Maliit::PreeditTextFormat> format_list;
+        const int start (0);
+        const int length (operation.text.length());
+
+        format_list.append(Maliit::PreeditTextFormat(start,
+                                                     length,
+                                                     static_cast< ::Maliit::PreeditFace>(operation.face)));
+
+        m_host->sendPreeditString(operation.text, format_list, operation.replacement.start,
+                                  operation.replacement.length, operation.replacement.cursor_position);
+    } break;
+
+    case HostOperation::CommitOperation:
+        m_host->sendCommitString(operation.text);
+        break;
+
+    case HostOperation::KeyEventOperation:
+        for (int count = 0; count < operation.repeat_count; ++count) {
+            m_host->sendKeyEvent(QKeyEvent(toQEventType(operation.key_state), operation.key, operation.modifier));
+        }
+        break;
+
+    case HostOperation::ActionOperation:
+        m_host->invokeAction(operation.text, QKeySequence::fromString(operation.key_sequence));
+        break;
+    }
 }
 
 } // namespace MaliitKeyboard
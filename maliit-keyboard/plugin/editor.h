@@ -36,6 +36,7 @@
 #include "models/key.h"
 #include "models/wordcandidate.h"
 #include "logic/abstracttexteditor.h"
+#include "flushtimer.h"
 
 #include <maliit/plugins/abstractinputmethodhost.h>
 #include <QtCore>
@@ -49,7 +50,32 @@ class Editor
     Q_DISABLE_COPY(Editor)
 
 private:
+    struct HostOperation
+    {
+        enum Type {
+            PreeditOperation,
+            CommitOperation,
+            KeyEventOperation,
+            ActionOperation
+        };
+
+        Type type;
+        QString text; // Preedit, commit string or action.
+        Model::Text::PreeditFace face;
+        Replacement replacement;
+        QString key_sequence;
+        KeyState key_state;
+        Qt::Key key;
+        Qt::KeyboardModifier modifier;
+        int repeat_count; // Key events only.
+
+        explicit HostOperation(Type new_type);
+    };
+
     MAbstractInputMethodHost *m_host;
+    bool m_batching_enabled;
+    QList<HostOperation> m_pending_operations;
+    FlushTimer m_flush_timer;
 
 public:
     explicit Editor(Model::Text *text,
@@ -60,6 +86,11 @@ public:
 
     void setHost(MAbstractInputMethodHost *host);
 
+    void setBatchingEnabled(bool enabled);
+    bool isBatchingEnabled() const;
+    int pendingOperationCount() const;
+    Q_SLOT void flush();
+
 private:
     //! \reimp
     virtual void sendPreeditString(const QString &preedit,
@@ -72,6 +103,9 @@ private:
     virtual void invokeAction(const QString &action,
                               const QString &key_sequence);
     //! \reimp_end
+
+    void enqueue(const HostOperation &operation);
+    void deliver(const HostOperation &operation);
 };
 
 } // namespace MaliitKeyboard
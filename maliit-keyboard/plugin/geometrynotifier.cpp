@@ -0,0 +1,154 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+#include "geometrynotifier.h"
+#include "flushtimer.h"
+
+namespace MaliitKeyboard {
+
+class GeometryNotifierPrivate
+{
+public:
+    bool coalescing_enabled;
+    GeometryNotifier::Surfaces pending;
+    int request_count;
+    int update_count;
+    FlushTimer flush_timer;
+
+    explicit GeometryNotifierPrivate()
+        : coalescing_enabled(false)
+        , pending()
+        , request_count(0)
+        , update_count(0)
+        , flush_timer("GeometryNotifier::flush")
+    {}
+};
+
+//! \class GeometryNotifier
+//! \brief Tells which surfaces need their geometry or input region synced
+//! with their layout models.
+//!
+//! A single key area change makes a layout model emit origin, width and
+//! height changes one by one, and each used to resize a window or send an
+//! input region to the host. With coalescing enabled, changes are collected
+//! until the end of the current event loop turn, and geometryChanged() is
+//! emitted once with all affected surfaces.
+
+GeometryNotifier::GeometryNotifier(QObject *parent)
+    : QObject(parent)
+    , d_ptr(new GeometryNotifierPrivate)
+{
+    Q_D(GeometryNotifier);
+
+    connect(&d->flush_timer, SIGNAL(timeout()),
+            this,            SLOT(flush()));
+}
+
+GeometryNotifier::~GeometryNotifier()
+{}
+
+//! \brief Marks the geometry of \a surface as changed.
+void GeometryNotifier::notify(Surface surface)
+{
+    Q_D(GeometryNotifier);
+
+    ++d->request_count;
+    d->pending |= surface;
+
+    if (not d->coalescing_enabled) {
+        flush();
+    } else {
+        d->flush_timer.schedule();
+    }
+}
+
+//! \brief Sets whether geometry changes are coalesced. Disabled by default.
+void GeometryNotifier::setCoalescingEnabled(bool enabled)
+{
+    Q_D(GeometryNotifier);
+
+    if (d->coalescing_enabled != enabled) {
+        flush();
+        d->coalescing_enabled = enabled;
+    }
+}
+
+bool GeometryNotifier::isCoalescingEnabled() const
+{
+    Q_D(const GeometryNotifier);
+    return d->coalescing_enabled;
+}
+
+//! \brief Emits pending geometry changes, if any, right away.
+void GeometryNotifier::flush()
+{
+    Q_D(GeometryNotifier);
+    d->flush_timer.stop();
+
+    if (not d->pending) {
+        return;
+    }
+
+    const Surfaces surfaces(d->pending);
+    d->pending = Surfaces();
+
+    for (int flag = KeyboardSurface; flag <= MagnifierSurface; flag <<= 1) {
+        if (surfaces.testFlag(static_cast<Surface>(flag))) {
+            ++d->update_count;
+        }
+    }
+
+    Q_EMIT geometryChanged(surfaces);
+}
+
+//! \brief Returns how many geometry changes were notified.
+int GeometryNotifier::requestCount() const
+{
+    Q_D(const GeometryNotifier);
+    return d->request_count;
+}
+
+//! \brief Returns how many surface updates were emitted.
+int GeometryNotifier::updateCount() const
+{
+    Q_D(const GeometryNotifier);
+    return d->update_count;
+}
+
+//! \brief Returns how many surface updates were saved by coalescing.
+int GeometryNotifier::savedCount() const
+{
+    Q_D(const GeometryNotifier);
+    return (d->request_count - d->update_count);
+}
+
+} // namespace MaliitKeyboard
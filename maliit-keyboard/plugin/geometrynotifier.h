@@ -0,0 +1,80 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+#ifndef MALIIT_KEYBOARD_GEOMETRYNOTIFIER_H
+#define MALIIT_KEYBOARD_GEOMETRYNOTIFIER_H
+
+#include <QtCore>
+
+namespace MaliitKeyboard {
+
+class GeometryNotifierPrivate;
+
+class GeometryNotifier
+    : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(GeometryNotifier)
+    Q_DECLARE_PRIVATE(GeometryNotifier)
+
+public:
+    enum Surface {
+        KeyboardSurface = 0x1,
+        ExtendedSurface = 0x2,
+        MagnifierSurface = 0x4
+    };
+    Q_DECLARE_FLAGS(Surfaces, Surface)
+
+    explicit GeometryNotifier(QObject *parent = 0);
+    virtual ~GeometryNotifier();
+
+    void notify(Surface surface);
+
+    void setCoalescingEnabled(bool enabled);
+    bool isCoalescingEnabled() const;
+    Q_SLOT void flush();
+
+    int requestCount() const;
+    int updateCount() const;
+    int savedCount() const;
+
+    Q_SIGNAL void geometryChanged(GeometryNotifier::Surfaces surfaces);
+
+private:
+    const QScopedPointer<GeometryNotifierPrivate> d_ptr;
+};
+
+} // namespace MaliitKeyboard
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(MaliitKeyboard::GeometryNotifier::Surfaces)
+
+#endif // MALIIT_KEYBOARD_GEOMETRYNOTIFIER_H
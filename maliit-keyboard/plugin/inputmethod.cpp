@@ -33,12 +33,19 @@
 #include "inputmethod.h"
 #include "editor.h"
 #include "updatenotifier.h"
+#include "geometrynotifier.h"
 #include "maliitcontext.h"
+#include "styleimageprovider.h"
+#include "tracing.h"
+#include "atoms.h"
+#include "wakeupmonitor.h"
+#include "memorypressuremonitor.h"
 
 #include "models/key.h"
 #include "models/keyarea.h"
 #include "models/wordribbon.h"
 #include "models/layout.h"
+#include "models/styleattributes.h"
 
 #include "logic/layouthelper.h"
 #include "logic/layoutupdater.h"
@@ -47,7 +54,12 @@
 #include "logic/languagefeatures.h"
 #include "logic/eventhandler.h"
 
-#ifdef HAVE_QT_MOBILITY
+#include "view/labelpreshaper.h"
+
+#if defined(HAVE_QT_MULTIMEDIA)
+#include "view/pcmfeedback.h"
+typedef MaliitKeyboard::PcmFeedback DefaultFeedback;
+#elif defined(HAVE_QT_MOBILITY)
 #include "view/soundfeedback.h"
 typedef MaliitKeyboard::SoundFeedback DefaultFeedback;
 #else
@@ -76,6 +88,17 @@ namespace {
 
 const int AutoRepeatDelayDefault = 500;
 const int AutoRepeatIntervalDefault = 50;
+const int OverlayWarmUpIdleTime = 1000; // in ms without key input, after keyboard was shown first.
+const int TrimDelayDefault = 60000; // in ms, after keyboard was hidden.
+
+int trimDelay()
+{
+    // A negative delay disables trimming on idle:
+    bool valid(false);
+    const int delay(qgetenv("MALIIT_KEYBOARD_TRIM_DELAY").toInt(&valid));
+
+    return (valid ? delay : TrimDelayDefault);
+}
 
 void makeQuickViewTransparent(QQuickView *view)
 {
@@ -85,9 +108,9 @@ void makeQuickViewTransparent(QQuickView *view)
     view->setColor(QColor(Qt::transparent));
 }
 
-QQuickView *getSurface (MAbstractInputMethodHost *host)
+QQuickView *getSurface (MAbstractInputMethodHost *host, QQmlEngine *engine)
 {
-    QScopedPointer<QQuickView> view(new QQuickView (0));
+    QScopedPointer<QQuickView> view(new QQuickView (engine, 0));
 
     host->registerWindow (view.data(), Maliit::PositionCenterBottom);
 
@@ -96,9 +119,9 @@ QQuickView *getSurface (MAbstractInputMethodHost *host)
     return view.take ();
 }
 
-QQuickView *getOverlaySurface (MAbstractInputMethodHost *host, QQuickView *parent)
+QQuickView *getOverlaySurface (MAbstractInputMethodHost *host, QQmlEngine *engine, QQuickView *parent)
 {
-    QScopedPointer<QQuickView> view(new QQuickView (0));
+    QScopedPointer<QQuickView> view(new QQuickView (engine, 0));
 
     view->setTransientParent(parent);
 
@@ -112,6 +135,7 @@ QQuickView *getOverlaySurface (MAbstractInputMethodHost *host, QQuickView *paren
 const QString g_maliit_keyboard_qml(MALIIT_KEYBOARD_DATA_DIR "/maliit-keyboard.qml");
 const QString g_maliit_keyboard_extended_qml(MALIIT_KEYBOARD_DATA_DIR "/maliit-keyboard-extended.qml");
 const QString g_maliit_magnifier_qml(MALIIT_KEYBOARD_DATA_DIR "/maliit-magnifier.qml");
+const QString g_maliit_keyboard_inscene_qml(MALIIT_KEYBOARD_DATA_DIR "/maliit-keyboard-inscene.qml");
 
 Key overrideToKey(const SharedOverride &override)
 {
@@ -137,6 +161,7 @@ public:
     ScopedSetting word_engine;
     ScopedSetting hide_word_ribbon_in_portrait_mode;
     ScopedSetting auto_repeat_behaviour;
+    ScopedSetting trace_dump;
 };
 
 class LayoutGroup
@@ -161,19 +186,39 @@ LayoutGroup::LayoutGroup()
 class InputMethodPrivate
 {
 public:
+    MAbstractInputMethodHost *host;
+    // Shared by all surfaces, needs to outlive them:
+    QScopedPointer<QQmlEngine> engine;
+    StyleImageProvider *image_provider; // Owned by engine.
     QScopedPointer<QQuickView> surface;
     QScopedPointer<QQuickView> extended_surface;
     QScopedPointer<QQuickView> magnifier_surface;
+    bool warm_up_overlays;
+    bool overlays_warm_up_scheduled;
+    QTimer warm_up_timer;
+    bool in_scene_popups;
+    int popup_headroom;
+    QRegion input_region;
+    QRect input_method_area;
+    QString trace_file;
     Editor editor;
     DefaultFeedback feedback;
     SharedStyle style;
     UpdateNotifier notifier;
+    GeometryNotifier geometry;
     QMap<QString, SharedOverride> key_overrides;
     Settings settings;
     LayoutGroup layout;
     LayoutGroup extended_layout;
     Model::Layout magnifier_layout;
     MaliitContext context;
+    LabelPreshaper preshaper;
+    QTimer trim_timer;
+    bool trimmed;
+    int trimmed_bytes;
+    int restore_time;
+    MemoryPressureMonitor memory_pressure;
+    WakeupMonitor wakeups;
 
     explicit InputMethodPrivate(InputMethod * const q,
                                 MAbstractInputMethodHost *host);
@@ -182,26 +227,63 @@ public:
 
     void connectToNotifier();
     void setContextProperties(QQmlContext *qml_context);
+
+    QQuickView *extendedSurface();
+    QQuickView *magnifierSurface();
+    void syncOverlaySurface(QQuickView *view,
+                            const Model::Layout &model);
+
+    void updatePopupHeadroom();
+    void updateInputRegion();
+
+    int trimMemory();
+    void restoreMemory();
 };
 
 
 InputMethodPrivate::InputMethodPrivate(InputMethod *const q,
                                        MAbstractInputMethodHost *host)
-    : surface(getSurface(host))
-    , extended_surface(getOverlaySurface(host, surface.data()))
-    , magnifier_surface(getOverlaySurface(host, surface.data()))
+    : host(host)
+    , engine(new QQmlEngine)
+    , image_provider(new StyleImageProvider)
+    , surface(getSurface(host, engine.data()))
+    , extended_surface()
+    , magnifier_surface()
+    , warm_up_overlays(qgetenv("MALIIT_KEYBOARD_DISABLE_OVERLAY_WARMUP").isEmpty())
+    , overlays_warm_up_scheduled(false)
+    , warm_up_timer()
+    , in_scene_popups(not qgetenv("MALIIT_KEYBOARD_IN_SCENE_POPUPS").isEmpty())
+    , popup_headroom(0)
+    , input_region()
+    , input_method_area()
+    , trace_file(QString::fromLocal8Bit(qgetenv("MALIIT_KEYBOARD_TRACE_FILE")))
     , editor(new Model::Text, new Logic::WordEngine, new Logic::LanguageFeatures)
     , feedback()
     , style(new Style)
     , notifier()
+    , geometry()
     , key_overrides()
     , settings()
     , layout()
     , extended_layout()
     , magnifier_layout()
     , context(q, style)
+    , preshaper()
+    , trim_timer()
+    , trimmed(false)
+    , trimmed_bytes(0)
+    , restore_time(-1)
+    , memory_pressure()
+    , wakeups()
 {
     editor.setHost(host);
+    // Every host call is a round trip to the application, so redundant
+    // preedit updates get dropped before they are sent:
+    editor.setBatchingEnabled(true);
+    // Applications send bursts of cursor updates during selection drags:
+    notifier.setCoalescingEnabled(true);
+    // Layout models report origin, width and height changes one by one:
+    geometry.setCoalescingEnabled(true);
 
 #ifndef DISABLE_PREEDIT
     editor.setPreeditEnabled(true);
@@ -214,6 +296,27 @@ InputMethodPrivate::InputMethodPrivate(InputMethod *const q,
     extended_layout.updater.setStyle(style);
     feedback.setStyle(style);
 
+    // Language and view switches of the main keyboard should not block input:
+    layout.updater.setAsynchronousLoading(true);
+
+    // Long-press popups should not need to parse the layout:
+    layout.updater.setExtendedKeysWarmupEnabled(true);
+
+    // Named, so that WakeupMonitor can tell them apart:
+    warm_up_timer.setObjectName("InputMethod::warmUpOverlays");
+    warm_up_timer.setSingleShot(true);
+    warm_up_timer.setInterval(OverlayWarmUpIdleTime);
+    trim_timer.setObjectName("InputMethod::trimMemory");
+    trim_timer.setSingleShot(true);
+    trim_timer.setInterval(trimDelay());
+
+    // Trimming also happens right away when the system runs low on memory:
+    memory_pressure.start(QString::fromLocal8Bit(qgetenv("MALIIT_KEYBOARD_MEMORY_PRESSURE_FILE")));
+
+    // Keyboard starts hidden:
+    feedback.setSuspended(true);
+    wakeups.setEnabled(not qgetenv("MALIIT_KEYBOARD_WAKEUP_STATS").isEmpty());
+
     const QSize &screen_size(QGuiApplication::primaryScreen()->availableSize());
     layout.helper.setScreenSize(screen_size);
     layout.helper.setAlignment(Logic::LayoutHelper::Bottom);
@@ -225,24 +328,21 @@ InputMethodPrivate::InputMethodPrivate(InputMethod *const q,
 
     connectToNotifier();
 
-    // TODO: Figure out whether two views can share one engine.
-    QQmlEngine *const engine(surface->engine());
+    // All surfaces share one engine, so QML components, image caches and
+    // context properties exist only once per process:
     engine->addImportPath(MALIIT_KEYBOARD_DATA_DIR);
+    engine->addImageProvider(StyleImageProvider::providerId(), image_provider);
     setContextProperties(engine->rootContext());
 
-    surface->setSource(QUrl::fromLocalFile(g_maliit_keyboard_qml));
-
-    QQmlEngine *const extended_engine(extended_surface->engine());
-    extended_engine->addImportPath(MALIIT_KEYBOARD_DATA_DIR);
-    setContextProperties(extended_engine->rootContext());
-
-    extended_surface->setSource(QUrl::fromLocalFile(g_maliit_keyboard_extended_qml));
-
-    QQmlEngine *const magnifier_engine(magnifier_surface->engine());
-    magnifier_engine->addImportPath(MALIIT_KEYBOARD_DATA_DIR);
-    setContextProperties(magnifier_engine->rootContext());
+    if (in_scene_popups) {
+        // Extended keys and magnifier are rendered by the keyboard surface:
+        surface->setSource(QUrl::fromLocalFile(g_maliit_keyboard_inscene_qml));
+        return;
+    }
 
-    magnifier_surface->setSource(QUrl::fromLocalFile(g_maliit_magnifier_qml));
+    // Extended keys and magnifier surfaces are only created when needed, see
+    // extendedSurface() and magnifierSurface().
+    surface->setSource(QUrl::fromLocalFile(g_maliit_keyboard_qml));
 }
 
 
@@ -251,6 +351,7 @@ void InputMethodPrivate::setLayoutOrientation(Logic::LayoutHelper::Orientation o
     syncWordEngine(orientation);
     layout.updater.setOrientation(orientation);
     extended_layout.updater.setOrientation(orientation);
+    updatePopupHeadroom();
 }
 
 
@@ -287,6 +388,162 @@ void InputMethodPrivate::setContextProperties(QQmlContext *qml_context)
     qml_context->setContextProperty("maliit_extended_layout", &extended_layout.model);
     qml_context->setContextProperty("maliit_extended_event_handler", &extended_layout.event_handler);
     qml_context->setContextProperty("maliit_magnifier_layout", &magnifier_layout);
+    qml_context->setContextProperty("maliit_popup_headroom", popup_headroom);
+}
+
+QQuickView *InputMethodPrivate::extendedSurface()
+{
+    // Most sessions never show extended keys, so surface and QML get created
+    // on first use (or when warming up, see InputMethod::show()):
+    if (extended_surface.isNull()) {
+        MALIIT_TRACE_SCOPE("InputMethod::createExtendedSurface");
+        extended_surface.reset(getOverlaySurface(host, engine.data(), surface.data()));
+        extended_surface->setSource(QUrl::fromLocalFile(g_maliit_keyboard_extended_qml));
+        syncOverlaySurface(extended_surface.data(), extended_layout.model);
+    }
+
+    return extended_surface.data();
+}
+
+QQuickView *InputMethodPrivate::magnifierSurface()
+{
+    if (magnifier_surface.isNull()) {
+        MALIIT_TRACE_SCOPE("InputMethod::createMagnifierSurface");
+        magnifier_surface.reset(getOverlaySurface(host, engine.data(), surface.data()));
+        magnifier_surface->setSource(QUrl::fromLocalFile(g_maliit_magnifier_qml));
+        syncOverlaySurface(magnifier_surface.data(), magnifier_layout);
+    }
+
+    return magnifier_surface.data();
+}
+
+void InputMethodPrivate::syncOverlaySurface(QQuickView *view,
+                                            const Model::Layout &model)
+{
+    view->setGeometry(QRect(surface->position() + model.origin(),
+                            QSize(model.width(), model.height())));
+
+    if (surface->isVisible()) {
+        view->show();
+    }
+}
+
+//! \brief Reserves space above the keyboard for in-scene popups.
+//!
+//! Magnifier and extended keys are moved up by the style's vertical offset,
+//! so popups of top row keys would be clipped by the keyboard surface
+//! otherwise.
+void InputMethodPrivate::updatePopupHeadroom()
+{
+    if (not in_scene_popups || style.isNull()) {
+        return;
+    }
+
+    const int headroom(qMax<int>(0, style->attributes()->verticalOffset(layout.helper.orientation())));
+
+    if (headroom != popup_headroom) {
+        popup_headroom = headroom;
+        engine->rootContext()->setContextProperty("maliit_popup_headroom", popup_headroom);
+        surface->setHeight(layout.model.height() + popup_headroom);
+        updateInputRegion();
+    }
+}
+
+//! \brief Updates the regions reported to the host, for in-scene popups.
+//!
+//! The screen region only grows beyond the keyboard while a popup leaves the
+//! keyboard bounds, and the host is only told about actual changes. Regions
+//! are in surface coordinates.
+void InputMethodPrivate::updateInputRegion()
+{
+    if (not in_scene_popups) {
+        return;
+    }
+
+    const QRect keyboard_rect(QPoint(0, popup_headroom),
+                              QSize(layout.model.width(), layout.model.height()));
+    const Model::Layout *const popups[] = {&extended_layout.model, &magnifier_layout};
+    QRegion region(keyboard_rect);
+
+    for (unsigned int index = 0; index < sizeof(popups) / sizeof(popups[0]); ++index) {
+        const Model::Layout *const popup(popups[index]);
+
+        if (not popup->isVisible()) {
+            continue;
+        }
+
+        const QRect popup_rect(keyboard_rect.topLeft() + popup->origin(),
+                               QSize(popup->width(), popup->height()));
+
+        if (not keyboard_rect.contains(popup_rect)) {
+            region += popup_rect;
+        }
+    }
+
+    if (keyboard_rect != input_method_area) {
+        input_method_area = keyboard_rect;
+        host->setInputMethodArea(QRegion(input_method_area), surface.data());
+    }
+
+    if (region != input_region) {
+        input_region = region;
+        host->setScreenRegion(input_region, surface.data());
+    }
+}
+
+//! \brief Releases memory that is not needed while the keyboard is hidden.
+//! \returns Approximate number of bytes released.
+//!
+//! Overlay surfaces, scene graph resources, cached key areas, the decoded
+//! image atlas, unused interned strings, and the word engine's dictionaries
+//! and prediction model are dropped. The active key areas stay, so that
+//! showing the keyboard again does not require loading layouts. The image
+//! atlas gets restored from its disk cache, the word engine reloads in
+//! restoreMemory(). Released bytes do not include the word engine.
+int InputMethodPrivate::trimMemory()
+{
+    if (trimmed || surface->isVisible()) {
+        return 0;
+    }
+
+    MALIIT_TRACE_SCOPE("InputMethod::trimMemory");
+
+    // Created again on first use, see extendedSurface() and magnifierSurface():
+    extended_surface.reset();
+    magnifier_surface.reset();
+    surface->releaseResources();
+    engine->trimComponentCache();
+
+    layout.updater.releaseCaches();
+    extended_layout.updater.releaseCaches();
+    editor.wordEngine()->releaseResources();
+
+    int released_bytes(image_provider->releaseImages());
+    released_bytes += Atoms::purge();
+
+    trimmed = true;
+    trimmed_bytes = released_bytes;
+    return released_bytes;
+}
+
+//! \brief Restores state released by trimMemory(), before showing the
+//! keyboard. Includes the word engine, so that the first keystroke does not
+//! load dictionaries.
+void InputMethodPrivate::restoreMemory()
+{
+    if (not trimmed) {
+        return;
+    }
+
+    MALIIT_TRACE_SCOPE("InputMethod::restoreMemory");
+
+    QElapsedTimer clock;
+    clock.start();
+
+    image_provider->restoreImages();
+    editor.wordEngine()->restoreResources();
+    trimmed = false;
+    restore_time = clock.elapsed();
 }
 
 InputMethod::InputMethod(MAbstractInputMethodHost *host)
@@ -303,40 +560,52 @@ InputMethod::InputMethod(MAbstractInputMethodHost *host)
     Logic::connectLayoutUpdaterToTextEditor(&d->extended_layout.updater, &d->editor);
 
     connect(&d->layout.helper, SIGNAL(centerPanelChanged(KeyArea,Logic::KeyOverrides)),
-            &d->layout.model, SLOT(setKeyArea(KeyArea)));
+            this,              SLOT(onCenterPanelChanged(KeyArea,Logic::KeyOverrides)));
 
     connect(&d->extended_layout.helper, SIGNAL(extendedPanelChanged(KeyArea,Logic::KeyOverrides)),
             &d->extended_layout.model, SLOT(setKeyArea(KeyArea)));
 
+    connect(&d->layout.helper, SIGNAL(overridenKeysChanged(Logic::LayoutHelper::Panel, QVector<int>, Logic::KeyOverrides)),
+            this,              SLOT(onKeysOverriden(Logic::LayoutHelper::Panel, QVector<int>, Logic::KeyOverrides)));
+
     connect(&d->layout.helper,    SIGNAL(magnifierChanged(KeyArea)),
             &d->magnifier_layout, SLOT(setKeyArea(KeyArea)));
 
     connect(&d->layout.model, SIGNAL(widthChanged(int)),
-            this,             SLOT(onLayoutWidthChanged(int)));
+            this,             SLOT(onLayoutGeometryChanged()));
 
     connect(&d->layout.model, SIGNAL(heightChanged(int)),
-            this,             SLOT(onLayoutHeightChanged(int)));
+            this,             SLOT(onLayoutGeometryChanged()));
 
     connect(&d->layout.updater, SIGNAL(keyboardTitleChanged(QString)),
             &d->layout.model,   SLOT(setTitle(QString)));
 
+    connect(&d->layout.updater, SIGNAL(keyboardLabelsLoaded(QString, QStringList)),
+            this,               SLOT(onKeyboardLabelsLoaded(QString, QStringList)));
+
     connect(&d->extended_layout.model, SIGNAL(widthChanged(int)),
-            this,                      SLOT(onExtendedLayoutWidthChanged(int)));
+            this,                      SLOT(onExtendedLayoutGeometryChanged()));
 
     connect(&d->extended_layout.model, SIGNAL(heightChanged(int)),
-            this,                      SLOT(onExtendedLayoutHeightChanged(int)));
+            this,                      SLOT(onExtendedLayoutGeometryChanged()));
 
     connect(&d->extended_layout.model, SIGNAL(originChanged(QPoint)),
-            this,                      SLOT(onExtendedLayoutOriginChanged(QPoint)));
+            this,                      SLOT(onExtendedLayoutGeometryChanged()));
 
     connect(&d->magnifier_layout, SIGNAL(widthChanged(int)),
-            this,                 SLOT(onMagnifierLayoutWidthChanged(int)));
+            this,                 SLOT(onMagnifierLayoutGeometryChanged()));
 
     connect(&d->magnifier_layout, SIGNAL(heightChanged(int)),
-            this,                 SLOT(onMagnifierLayoutHeightChanged(int)));
+            this,                 SLOT(onMagnifierLayoutGeometryChanged()));
 
     connect(&d->magnifier_layout, SIGNAL(originChanged(QPoint)),
-            this,                 SLOT(onMagnifierLayoutOriginChanged(QPoint)));
+            this,                 SLOT(onMagnifierLayoutGeometryChanged()));
+
+    connect(&d->extended_layout.model, SIGNAL(visibleChanged(bool)),
+            this,                      SLOT(onPopupVisibleChanged(bool)));
+
+    connect(&d->magnifier_layout, SIGNAL(visibleChanged(bool)),
+            this,                 SLOT(onPopupVisibleChanged(bool)));
 
     // FIXME: Reimplement keyboardClosed, switchLeft and switchRight
     // (triggered by glass).
@@ -347,6 +616,37 @@ InputMethod::InputMethod(MAbstractInputMethodHost *host)
     connect(QGuiApplication::primaryScreen(), SIGNAL(geometryChanged(QRect)),
             this,               SLOT(onScreenSizeChange(QRect)));
 
+    connect(&d->trim_timer, SIGNAL(timeout()),
+            this,           SLOT(trimMemory()));
+
+    connect(&d->memory_pressure, SIGNAL(pressureReported()),
+            this,                SLOT(onMemoryPressure()));
+
+    connect(&d->warm_up_timer, SIGNAL(timeout()),
+            this,              SLOT(onWarmUpOverlaySurfaces()));
+
+    // Warming up stalls the main thread, so it waits for a typing pause:
+    connect(&d->layout.event_handler, SIGNAL(keyPressed(Key)),
+            this,                     SLOT(onKeyInput()));
+
+    connect(&d->layout.event_handler, SIGNAL(keyReleased(Key)),
+            this,                     SLOT(onKeyInput()));
+
+    connect(&d->layout.event_handler, SIGNAL(keyEntered(Key)),
+            this,                     SLOT(onKeyInput()));
+
+    connect(&d->geometry, SIGNAL(geometryChanged(GeometryNotifier::Surfaces)),
+            this,         SLOT(onGeometryChanged(GeometryNotifier::Surfaces)));
+
+    if (not d->trace_file.isEmpty()) {
+        Tracing::setEnabled(true);
+
+        // Emitted from the render thread, which gets its own trace buffer:
+        connect(d->surface.data(), SIGNAL(frameSwapped()),
+                this,              SLOT(onFrameSwapped()),
+                Qt::DirectConnection);
+    }
+
     registerStyleSetting(host);
     registerFeedbackSetting(host);
     registerAutoCorrectSetting(host);
@@ -354,6 +654,7 @@ InputMethod::InputMethod(MAbstractInputMethodHost *host)
     registerWordEngineSetting(host);
     registerHideWordRibbonInPortraitModeSetting(host);
     registerAutoRepeatBehaviour(host);
+    registerTraceDumpSetting(host);
 
     // Setting layout orientation depends on word engine and hide word ribbon
     // settings to be initialized first:
@@ -369,26 +670,161 @@ void InputMethod::show()
 {
     Q_D(InputMethod);
 
+    d->wakeups.setPhase(WakeupMonitor::Shown);
+    d->trim_timer.stop();
+    d->restoreMemory();
+    d->context.setShown(true);
+    d->feedback.setSuspended(false);
+    d->preshaper.setSuspended(false);
+
     const QRect &rect = d->surface->screen()->availableGeometry();
 
     d->surface->setGeometry(QRect(QPoint(rect.x() + (rect.width() - d->layout.model.width()) / 2,
-                                         rect.y() + rect.height() - d->layout.model.height()),
+                                         rect.y() + rect.height() - d->layout.model.height() - d->popup_headroom),
                                   QSize(d->layout.model.width(),
-                                        d->layout.model.height())));
+                                        d->layout.model.height() + d->popup_headroom)));
 
     d->surface->show();
-    d->extended_surface->show();
-    d->magnifier_surface->show();
+    d->updateInputRegion();
+
+    if (d->extended_surface) {
+        d->extended_surface->show();
+    }
+
+    if (d->magnifier_surface) {
+        d->magnifier_surface->show();
+    }
+
+    if (d->warm_up_overlays && not d->in_scene_popups && not d->overlays_warm_up_scheduled) {
+        d->overlays_warm_up_scheduled = true;
+        d->warm_up_timer.start();
+    }
 }
 
 void InputMethod::hide()
 {
     Q_D(InputMethod);
     d->layout.updater.resetOnKeyboardClosed();
+    d->editor.cancelAutoRepeat();
     d->editor.clearPreedit();
+    d->editor.flush();
+    d->notifier.flush();
+    d->geometry.flush();
     d->surface->hide();
-    d->extended_surface->hide();
-    d->magnifier_surface->hide();
+    d->context.setShown(false);
+
+    // A hidden keyboard should not wake up by itself, see WakeupMonitor:
+    if (d->warm_up_timer.isActive()) {
+        d->warm_up_timer.stop();
+        d->overlays_warm_up_scheduled = false;
+    }
+
+    d->feedback.setSuspended(true);
+    d->preshaper.setSuspended(true);
+
+    if (d->extended_surface) {
+        d->extended_surface->hide();
+    }
+
+    if (d->magnifier_surface) {
+        d->magnifier_surface->hide();
+    }
+
+    d->wakeups.setPhase(WakeupMonitor::Hidden);
+
+    if (d->trim_timer.interval() >= 0) {
+        d->trim_timer.start();
+    }
+}
+
+//! \brief Releases memory while the keyboard is hidden.
+//!
+//! Called after the keyboard stayed hidden for a while (see
+//! MALIIT_KEYBOARD_TRIM_DELAY), and on memory pressure, see
+//! MemoryPressureMonitor. Does nothing while the keyboard is shown.
+void InputMethod::trimMemory()
+{
+    Q_D(InputMethod);
+
+    if (d->trimmed || d->surface->isVisible()) {
+        return;
+    }
+
+    d->trim_timer.stop();
+    d->trimMemory();
+}
+
+//! \brief Returns the approximate number of bytes released by the last
+//! trimMemory().
+int InputMethod::trimmedBytes() const
+{
+    Q_D(const InputMethod);
+    return d->trimmed_bytes;
+}
+
+//! \brief Returns how long, in ms, the last show() took to restore what
+//! trimMemory() released, or -1 if nothing was restored yet.
+int InputMethod::restoreTime() const
+{
+    Q_D(const InputMethod);
+    return d->restore_time;
+}
+
+//! \brief Writes recorded trace events to MALIIT_KEYBOARD_TRACE_FILE, as
+//! Chrome trace event JSON.
+//!
+//! Triggered through the "trace_dump_requested" plugin setting. Does nothing
+//! unless MALIIT_KEYBOARD_TRACE_FILE is set.
+//! \returns Whether the trace was written.
+bool InputMethod::dumpTrace()
+{
+    Q_D(InputMethod);
+
+    if (d->trace_file.isEmpty()) {
+        return false;
+    }
+
+    return Tracing::dumpChromeTrace(d->trace_file);
+}
+
+//! \brief Returns the wakeup monitor, which only counts wakeups if
+//! MALIIT_KEYBOARD_WAKEUP_STATS is set.
+const WakeupMonitor * InputMethod::wakeupMonitor() const
+{
+    Q_D(const InputMethod);
+    return &d->wakeups;
+}
+
+//! \brief Returns the wakeups counted so far, per phase and source, or an
+//! empty string unless MALIIT_KEYBOARD_WAKEUP_STATS is set.
+QString InputMethod::wakeupReport() const
+{
+    Q_D(const InputMethod);
+
+    if (not d->wakeups.isEnabled()) {
+        return QString();
+    }
+
+    return QString("%1\nGeometry updates saved: %2 of %3")
+            .arg(d->wakeups.report())
+            .arg(d->geometry.savedCount())
+            .arg(d->geometry.requestCount());
+}
+
+//! \brief Trims a hidden keyboard right away. A shown keyboard only drops
+//! caches for views that are not shown.
+void InputMethod::onMemoryPressure()
+{
+    Q_D(InputMethod);
+
+    if (not d->surface->isVisible()) {
+        trimMemory();
+        return;
+    }
+
+    d->layout.updater.releaseCaches();
+    d->extended_layout.updater.releaseCaches();
+    Atoms::purge();
 }
 
 void InputMethod::setPreedit(const QString &preedit,
@@ -547,6 +983,30 @@ void InputMethod::registerAutoCapsSetting(MAbstractInputMethodHost *host)
 }
 
 
+//! \brief Lets settings clients request a trace dump, see dumpTrace().
+//!
+//! Only registered if MALIIT_KEYBOARD_TRACE_FILE is set.
+void InputMethod::registerTraceDumpSetting(MAbstractInputMethodHost *host)
+{
+    Q_D(InputMethod);
+
+    if (d->trace_file.isEmpty()) {
+        return;
+    }
+
+    QVariantMap attributes;
+    attributes[Maliit::SettingEntryAttributes::defaultValue] = false;
+
+    d->settings.trace_dump.reset(host->registerPluginSetting("trace_dump_requested",
+                                                             QT_TR_NOOP("Write latency trace"),
+                                                             Maliit::BoolType,
+                                                             attributes));
+
+    connect(d->settings.trace_dump.data(), SIGNAL(valueChanged()),
+            this,                          SLOT(onTraceDumpSettingChanged()));
+}
+
+
 void InputMethod::registerWordEngineSetting(MAbstractInputMethodHost *host)
 {
     Q_D(InputMethod);
@@ -648,9 +1108,18 @@ void InputMethod::onStyleSettingChanged()
 {
     Q_D(InputMethod);
     d->style->setProfile(d->settings.style->value().toString());
-    d->layout.model.setImageDirectory(d->style->directory(Style::Images));
-    d->extended_layout.model.setImageDirectory(d->style->directory(Style::Images));
-    d->magnifier_layout.setImageDirectory(d->style->directory(Style::Images));
+
+    // Serve style images from a pre-decoded atlas, to avoid decoding images
+    // on first key press. Falls back to image files:
+    const QString image_files(d->style->directory(Style::Images));
+    d->image_provider->loadProfile(d->style->profile(), image_files);
+    const QString atlas_directory(d->image_provider->imageDirectory());
+    const QString &image_directory(atlas_directory.isEmpty() ? image_files : atlas_directory);
+
+    d->layout.model.setImageDirectory(image_directory);
+    d->extended_layout.model.setImageDirectory(image_directory);
+    d->magnifier_layout.setImageDirectory(image_directory);
+    d->updatePopupHeadroom();
 }
 
 void InputMethod::onKeyboardClosed()
@@ -677,6 +1146,16 @@ void InputMethod::onAutoCapsSettingChanged()
     d->editor.setAutoCapsEnabled(d->settings.auto_caps->value().toBool());
 }
 
+void InputMethod::onTraceDumpSettingChanged()
+{
+    Q_D(InputMethod);
+
+    if (d->settings.trace_dump->value().toBool()) {
+        dumpTrace();
+        d->settings.trace_dump->set(false);
+    }
+}
+
 void InputMethod::onWordEngineSettingChanged()
 {
     // FIXME: Renderer doesn't seem to update graphics properly. Word ribbon
@@ -747,52 +1226,144 @@ void InputMethod::updateKey(const QString &key_id,
     }
 }
 
-void InputMethod::onLayoutWidthChanged(int width)
+//! \brief Updates the keys affected by key overrides, for the panel shown
+//! by the main layout model.
+//! \brief Shows a new center panel, keeping the key overrides of the
+//! application applied.
+void InputMethod::onCenterPanelChanged(const KeyArea &key_area,
+                                       const Logic::KeyOverrides &overrides)
+{
+    Q_D(InputMethod);
+    d->layout.model.setKeyArea(key_area, overrides);
+}
+
+void InputMethod::onKeysOverriden(Logic::LayoutHelper::Panel panel,
+                                  const QVector<int> &indices,
+                                  const Logic::KeyOverrides &overrides)
+{
+    Q_D(InputMethod);
+
+    if (panel == Logic::LayoutHelper::CenterPanel) {
+        d->layout.model.applyKeyOverrides(indices, overrides);
+    }
+}
+
+void InputMethod::onLayoutGeometryChanged()
 {
     Q_D(InputMethod);
-    d->surface->setWidth(width);
+    d->geometry.notify(GeometryNotifier::KeyboardSurface);
 }
 
-void InputMethod::onLayoutHeightChanged(int height)
+void InputMethod::onExtendedLayoutGeometryChanged()
 {
     Q_D(InputMethod);
-    d->surface->setHeight(height);
+    d->geometry.notify(GeometryNotifier::ExtendedSurface);
 }
 
-void InputMethod::onExtendedLayoutWidthChanged(int width)
+void InputMethod::onMagnifierLayoutGeometryChanged()
 {
     Q_D(InputMethod);
-    d->extended_surface->setWidth(width);
+    d->geometry.notify(GeometryNotifier::MagnifierSurface);
 }
 
-void InputMethod::onExtendedLayoutHeightChanged(int height)
+//! \brief Shapes all labels of a newly activated keyboard during idle time,
+//! so that first use of a view does not stutter on complex scripts. Labels
+//! of a keyboard that is no longer active are dropped.
+void InputMethod::onKeyboardLabelsLoaded(const QString &id,
+                                         const QStringList &labels)
 {
     Q_D(InputMethod);
-    d->extended_surface->setHeight(height);
+
+    if (id != d->layout.updater.activeKeyboardId()) {
+        return;
+    }
+
+    const StyleAttributes *const attributes(d->style->attributes());
+    const Logic::LayoutHelper::Orientation orientation(d->layout.helper.orientation());
+
+    QFont font(QString::fromUtf8(attributes->fontName(orientation)));
+    font.setPointSize(qMax<int>(1, attributes->fontSize(orientation)));
+
+    d->preshaper.clear();
+    d->preshaper.setFont(font);
+    d->preshaper.preshape(labels);
 }
 
-void InputMethod::onExtendedLayoutOriginChanged(const QPoint &origin)
+void InputMethod::onPopupVisibleChanged(bool visible)
 {
+    Q_UNUSED(visible)
     Q_D(InputMethod);
-    d->extended_surface->setPosition(d->surface->position() + origin);
+
+    // Only the input region depends on visibility, see updateInputRegion():
+    if (d->in_scene_popups) {
+        d->geometry.notify(sender() == &d->magnifier_layout ? GeometryNotifier::MagnifierSurface
+                                                            : GeometryNotifier::ExtendedSurface);
+    }
 }
 
-void InputMethod::onMagnifierLayoutWidthChanged(int width)
+//! \brief Syncs surfaces with their layout models, once per event loop turn
+//! for all geometry changes collected by GeometryNotifier.
+void InputMethod::onGeometryChanged(GeometryNotifier::Surfaces surfaces)
 {
     Q_D(InputMethod);
-    d->magnifier_surface->setWidth(width);
+
+    if (surfaces & GeometryNotifier::KeyboardSurface) {
+        d->surface->resize(d->layout.model.width(),
+                           d->layout.model.height() + d->popup_headroom);
+    }
+
+    // In-scene popups are part of the keyboard surface and only affect its
+    // input region:
+    if (not d->in_scene_popups) {
+        if (surfaces & GeometryNotifier::ExtendedSurface) {
+            const Model::Layout &model(d->extended_layout.model);
+            d->extendedSurface()->setGeometry(QRect(d->surface->position() + model.origin(),
+                                                    QSize(model.width(), model.height())));
+        }
+
+        if (surfaces & GeometryNotifier::MagnifierSurface) {
+            d->magnifierSurface()->setGeometry(QRect(d->surface->position() + d->magnifier_layout.origin(),
+                                                     QSize(d->magnifier_layout.width(),
+                                                           d->magnifier_layout.height())));
+        }
+    }
+
+    d->updateInputRegion();
 }
 
-void InputMethod::onMagnifierLayoutHeightChanged(int height)
+//! \brief Postpones warming up overlay surfaces while the user types.
+void InputMethod::onKeyInput()
 {
     Q_D(InputMethod);
-    d->magnifier_surface->setHeight(height);
+
+    if (d->warm_up_timer.isActive()) {
+        d->warm_up_timer.start();
+    }
 }
 
-void InputMethod::onMagnifierLayoutOriginChanged(const QPoint &origin)
+//! \brief Creates extended keys and magnifier surfaces ahead of their first
+//! use, to avoid a delay on first long press or key press.
+//!
+//! Scheduled once, after the keyboard was first shown and then received no
+//! key input for OverlayWarmUpIdleTime. Can be disabled by setting
+//! MALIIT_KEYBOARD_DISABLE_OVERLAY_WARMUP. Surface creation shows up in
+//! trace dumps, see dumpTrace(), to compare first popup latency with and
+//! without warm-up.
+void InputMethod::onWarmUpOverlaySurfaces()
 {
+    MALIIT_TRACE_SCOPE("InputMethod::warmUpOverlaySurfaces");
+
     Q_D(InputMethod);
-    d->magnifier_surface->setPosition(d->surface->position() + origin);
+    d->extendedSurface();
+    d->magnifierSurface();
+}
+
+//! \brief Records when a frame of the keyboard surface reached the screen.
+//!
+//! Only connected if MALIIT_KEYBOARD_TRACE_FILE is set, see dumpTrace().
+void InputMethod::onFrameSwapped()
+{
+    Tracing::instant("QQuickWindow::frameSwapped");
 }
 
 } // namespace MaliitKeyboard
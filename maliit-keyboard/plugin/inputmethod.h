@@ -38,9 +38,13 @@
 #include <maliit/plugins/keyoverride.h>
 #include <QtGui>
 
+#include "geometrynotifier.h"
+#include "logic/layouthelper.h"
+
 namespace MaliitKeyboard {
 
 class InputMethodPrivate;
+class WakeupMonitor;
 
 class InputMethod
     : public MAbstractInputMethod
@@ -73,6 +77,13 @@ public:
     Q_SLOT void onLeftLayoutSelected();
     Q_SLOT void onRightLayoutSelected();
 
+    Q_SLOT void trimMemory();
+    int trimmedBytes() const;
+    int restoreTime() const;
+    const WakeupMonitor * wakeupMonitor() const;
+    QString wakeupReport() const;
+    Q_SLOT bool dumpTrace();
+
 private:
     void registerStyleSetting(MAbstractInputMethodHost *host);
     void registerFeedbackSetting(MAbstractInputMethodHost *host);
@@ -81,6 +92,7 @@ private:
     void registerWordEngineSetting(MAbstractInputMethodHost *host);
     void registerHideWordRibbonInPortraitModeSetting(MAbstractInputMethodHost *host);
     void registerAutoRepeatBehaviour(MAbstractInputMethodHost *host);
+    void registerTraceDumpSetting(MAbstractInputMethodHost *host);
 
     Q_SLOT void onScreenSizeChange(const QRect &rect);
     Q_SLOT void onStyleSettingChanged();
@@ -91,17 +103,26 @@ private:
     Q_SLOT void onWordEngineSettingChanged();
     Q_SLOT void onHideWordRibbonInPortraitModeSettingChanged();
     Q_SLOT void onAutoRepeatBehaviourChanged();
+    Q_SLOT void onTraceDumpSettingChanged();
     Q_SLOT void updateKey(const QString &key_id,
                           const MKeyOverride::KeyOverrideAttributes changed_attributes);
+    Q_SLOT void onCenterPanelChanged(const KeyArea &key_area,
+                                     const Logic::KeyOverrides &overrides);
+    Q_SLOT void onKeysOverriden(Logic::LayoutHelper::Panel panel,
+                                const QVector<int> &indices,
+                                const Logic::KeyOverrides &overrides);
 
-    Q_SLOT void onLayoutWidthChanged(int width);
-    Q_SLOT void onLayoutHeightChanged(int height);
-    Q_SLOT void onExtendedLayoutWidthChanged(int width);
-    Q_SLOT void onExtendedLayoutHeightChanged(int height);
-    Q_SLOT void onExtendedLayoutOriginChanged(const QPoint &origin);
-    Q_SLOT void onMagnifierLayoutWidthChanged(int width);
-    Q_SLOT void onMagnifierLayoutHeightChanged(int height);
-    Q_SLOT void onMagnifierLayoutOriginChanged(const QPoint &origin);
+    Q_SLOT void onLayoutGeometryChanged();
+    Q_SLOT void onExtendedLayoutGeometryChanged();
+    Q_SLOT void onMagnifierLayoutGeometryChanged();
+    Q_SLOT void onKeyboardLabelsLoaded(const QString &id,
+                                       const QStringList &labels);
+    Q_SLOT void onPopupVisibleChanged(bool visible);
+    Q_SLOT void onGeometryChanged(GeometryNotifier::Surfaces surfaces);
+    Q_SLOT void onKeyInput();
+    Q_SLOT void onWarmUpOverlaySurfaces();
+    Q_SLOT void onMemoryPressure();
+    Q_SLOT void onFrameSwapped();
 
     const QScopedPointer<InputMethodPrivate> d_ptr;
 };
@@ -42,6 +42,7 @@ class MaliitContextPrivate
 public:
     InputMethod * const input_method;
     SharedStyle style;
+    bool shown;
 
     explicit MaliitContextPrivate(InputMethod * const new_input_method,
                                   const SharedStyle &new_style);
@@ -52,6 +53,7 @@ MaliitContextPrivate::MaliitContextPrivate(InputMethod *const new_input_method,
                                            const SharedStyle &new_style)
     : input_method(new_input_method)
     , style(new_style)
+    , shown(false)
 {
     Q_ASSERT(input_method != 0);
     Q_ASSERT(not style.isNull());
@@ -106,4 +108,27 @@ void MaliitContext::selectRightLayout()
     d->input_method->onRightLayoutSelected();
 }
 
+
+//! \brief Returns whether the virtual keyboard is shown.
+//!
+//! QML uses this to stop its timers while the keyboard is hidden.
+bool MaliitContext::isShown() const
+{
+    Q_D(const MaliitContext);
+    return d->shown;
+}
+
+
+//! \brief Sets whether the virtual keyboard is shown. Called by
+//! InputMethod::show() and InputMethod::hide().
+void MaliitContext::setShown(bool shown)
+{
+    Q_D(MaliitContext);
+
+    if (d->shown != shown) {
+        d->shown = shown;
+        Q_EMIT shownChanged(d->shown);
+    }
+}
+
 } // namespace MaliitKeyboard
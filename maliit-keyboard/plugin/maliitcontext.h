@@ -47,6 +47,9 @@ class MaliitContext
     Q_DISABLE_COPY(MaliitContext)
     Q_DECLARE_PRIVATE(MaliitContext)
 
+    Q_PROPERTY(bool shown READ isShown
+                          NOTIFY shownChanged)
+
 public:
     explicit MaliitContext(InputMethod *input_method,
                            const SharedStyle &style,
@@ -58,6 +61,10 @@ public:
     Q_INVOKABLE void selectLeftLayout();
     Q_INVOKABLE void selectRightLayout();
 
+    bool isShown() const;
+    void setShown(bool shown);
+    Q_SIGNAL void shownChanged(bool shown);
+
 private:
     const QScopedPointer<MaliitContextPrivate> d_ptr;
 };
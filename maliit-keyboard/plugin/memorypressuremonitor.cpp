@@ -0,0 +1,158 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+
+#include "memorypressuremonitor.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace MaliitKeyboard {
+
+namespace {
+
+const char * const g_default_pressure_file = "/proc/pressure/memory";
+
+} // unnamed namespace
+
+class MemoryPressureMonitorPrivate
+{
+public:
+    int fd;
+    QScopedPointer<QSocketNotifier> notifier;
+    int pressure_count;
+
+    explicit MemoryPressureMonitorPrivate()
+        : fd(-1)
+        , notifier()
+        , pressure_count(0)
+    {}
+};
+
+//! \class MemoryPressureMonitor
+//! \brief Reports when the system runs low on memory.
+//!
+//! Uses a Linux pressure stall information (PSI) trigger: the kernel wakes
+//! the monitor up when tasks stalled on memory for longer than a threshold
+//! within a time window. There are no timers involved, so a hidden keyboard
+//! only wakes up under actual pressure. Where PSI is not available, other
+//! platform notifications can be connected to reportPressure().
+
+MemoryPressureMonitor::MemoryPressureMonitor(QObject *parent)
+    : QObject(parent)
+    , d_ptr(new MemoryPressureMonitorPrivate)
+{}
+
+MemoryPressureMonitor::~MemoryPressureMonitor()
+{
+    stop();
+}
+
+//! \brief Installs a pressure trigger.
+//! \param file_name The PSI file. Defaults to the system wide memory
+//!                  pressure, /proc/pressure/memory.
+//! \param stall_ms The stall time that counts as pressure.
+//! \param window_ms The time window for measuring stalls. Unprivileged
+//!                  processes need a multiple of two seconds.
+//! \returns Whether the trigger could be installed.
+bool MemoryPressureMonitor::start(const QString &file_name,
+                                  int stall_ms,
+                                  int window_ms)
+{
+    Q_D(MemoryPressureMonitor);
+
+    stop();
+
+    const QByteArray path(file_name.isEmpty() ? QByteArray(g_default_pressure_file)
+                                              : QFile::encodeName(file_name));
+    const int fd(::open(path.constData(), O_RDWR | O_NONBLOCK | O_CLOEXEC));
+
+    if (fd < 0) {
+        return false;
+    }
+
+    // Includes the terminating null byte, as the kernel expects:
+    const QByteArray trigger(QByteArray("some ") + QByteArray::number(stall_ms * 1000)
+                             + " " + QByteArray::number(window_ms * 1000));
+
+    if (::write(fd, trigger.constData(), trigger.size() + 1) < 0) {
+        ::close(fd);
+        return false;
+    }
+
+    d->fd = fd;
+    d->notifier.reset(new QSocketNotifier(fd, QSocketNotifier::Exception));
+
+    connect(d->notifier.data(), SIGNAL(activated(int)),
+            this,               SLOT(onActivated()));
+
+    return true;
+}
+
+//! \brief Removes the pressure trigger, if any.
+void MemoryPressureMonitor::stop()
+{
+    Q_D(MemoryPressureMonitor);
+
+    d->notifier.reset();
+
+    if (d->fd >= 0) {
+        ::close(d->fd);
+        d->fd = -1;
+    }
+}
+
+bool MemoryPressureMonitor::isActive() const
+{
+    Q_D(const MemoryPressureMonitor);
+    return (d->fd >= 0);
+}
+
+//! \brief Returns how many times pressure was reported.
+int MemoryPressureMonitor::pressureCount() const
+{
+    Q_D(const MemoryPressureMonitor);
+    return d->pressure_count;
+}
+
+//! \brief Reports memory pressure, as if the trigger fired.
+void MemoryPressureMonitor::reportPressure()
+{
+    Q_D(MemoryPressureMonitor);
+
+    ++d->pressure_count;
+    Q_EMIT pressureReported();
+}
+
+void MemoryPressureMonitor::onActivated()
+{
+    reportPressure();
+}
+
+} // namespace MaliitKeyboard
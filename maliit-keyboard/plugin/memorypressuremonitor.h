@@ -0,0 +1,70 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+
+#ifndef MALIIT_KEYBOARD_MEMORYPRESSUREMONITOR_H
+#define MALIIT_KEYBOARD_MEMORYPRESSUREMONITOR_H
+
+#include <QtCore>
+
+namespace MaliitKeyboard {
+
+class MemoryPressureMonitorPrivate;
+
+class MemoryPressureMonitor
+    : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(MemoryPressureMonitor)
+    Q_DECLARE_PRIVATE(MemoryPressureMonitor)
+
+public:
+    explicit MemoryPressureMonitor(QObject *parent = 0);
+    virtual ~MemoryPressureMonitor();
+
+    bool start(const QString &file_name = QString(),
+               int stall_ms = 150,
+               int window_ms = 2000);
+    void stop();
+    bool isActive() const;
+
+    int pressureCount() const;
+
+    Q_SLOT void reportPressure();
+    Q_SIGNAL void pressureReported();
+
+private:
+    Q_SLOT void onActivated();
+
+    const QScopedPointer<MemoryPressureMonitorPrivate> d_ptr;
+};
+
+} // namespace MaliitKeyboard
+
+#endif // MALIIT_KEYBOARD_MEMORYPRESSUREMONITOR_H
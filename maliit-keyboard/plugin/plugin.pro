@@ -16,6 +16,10 @@ contains(QT_MAJOR_VERSION, 4) {
     QT = core gui widgets quick qml
 }
 
+enable-qt-multimedia {
+    QT += multimedia
+}
+
 CONFIG += \
     plugin \
 
@@ -25,6 +29,9 @@ HEADERS += \
     editor.h \
     updatenotifier.h \
     maliitcontext.h \
+    styleimageprovider.h \
+    geometrynotifier.h \
+    memorypressuremonitor.h \
 
 SOURCES += \
     plugin.cpp \
@@ -32,6 +39,9 @@ SOURCES += \
     editor.cpp \
     updatenotifier.cpp \
     maliitcontext.cpp \
+    styleimageprovider.cpp \
+    geometrynotifier.cpp \
+    memorypressuremonitor.cpp \
 
 target.path += $${MALIIT_PLUGINS_DIR}
 INSTALLS += target
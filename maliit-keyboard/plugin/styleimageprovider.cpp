@@ -0,0 +1,190 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+#include "styleimageprovider.h"
+#include "view/imageatlas.h"
+
+namespace MaliitKeyboard {
+namespace {
+
+const QString g_provider_id("maliit-style");
+
+QString cacheDirectory()
+{
+    return (QStandardPaths::writableLocation(QStandardPaths::CacheLocation)
+            + "/maliit-keyboard");
+}
+
+} // namespace
+
+//! \class StyleImageProvider
+//! Serves the images of the active style profile to QML, from a pre-decoded
+//! ImageAtlas. Image URLs have the form
+//! image://maliit-style/<profile>/<file name>, so that the QML pixmap cache
+//! never mixes up images of different profiles. Images missing from the
+//! atlas are loaded from the style's image directory.
+
+class StyleImageProviderPrivate
+{
+public:
+    mutable QMutex mutex; // Image requests may come from QML's loader thread.
+    ImageAtlas atlas;
+    QString profile;
+    QString image_directory;
+    bool released; // Atlas was released, reload it on next request.
+
+    explicit StyleImageProviderPrivate()
+        : mutex()
+        , atlas()
+        , profile()
+        , image_directory()
+        , released(false)
+    {}
+
+    void restore()
+    {
+        if (released) {
+            released = false;
+            atlas.load(image_directory, cacheDirectory());
+        }
+    }
+};
+
+StyleImageProvider::StyleImageProvider()
+    : QQuickImageProvider(QQuickImageProvider::Image)
+    , d_ptr(new StyleImageProviderPrivate)
+{}
+
+StyleImageProvider::~StyleImageProvider()
+{}
+
+//! \brief Returns the id under which to register this provider.
+QString StyleImageProvider::providerId()
+{
+    return g_provider_id;
+}
+
+//! \brief Packs (or loads from cache) the images of a style profile, and
+//! makes them available to QML.
+//! \param profile The style profile name.
+//! \param image_directory The profile's image directory.
+//! \returns Whether an atlas could be created.
+bool StyleImageProvider::loadProfile(const QString &profile,
+                                     const QString &image_directory)
+{
+    Q_D(StyleImageProvider);
+    QMutexLocker lock(&d->mutex);
+
+    if (d->profile == profile && d->image_directory == image_directory && d->atlas.isLoaded()) {
+        return true;
+    }
+
+    d->profile = profile;
+    d->image_directory = image_directory;
+    d->released = false;
+
+    return d->atlas.load(image_directory, cacheDirectory());
+}
+
+//! \brief Returns the image directory to use for layout models, pointing to
+//! this provider. Empty if no atlas is loaded.
+QString StyleImageProvider::imageDirectory() const
+{
+    Q_D(const StyleImageProvider);
+    QMutexLocker lock(&d->mutex);
+
+    if (not d->atlas.isLoaded() && not d->released) {
+        return QString();
+    }
+
+    return QString("image://%1/%2").arg(g_provider_id).arg(d->profile);
+}
+
+//! \brief Drops the decoded atlas, for when the keyboard is hidden and
+//! memory gets trimmed.
+//! \returns Number of bytes released.
+//!
+//! The atlas is restored from the on-disk cache by restoreImages(), or on
+//! the next image request, so image URLs handed out before stay valid.
+int StyleImageProvider::releaseImages()
+{
+    Q_D(StyleImageProvider);
+    QMutexLocker lock(&d->mutex);
+
+    if (not d->atlas.isLoaded()) {
+        return 0;
+    }
+
+    const int released_bytes(d->atlas.image().byteCount());
+    d->atlas.clear();
+    d->released = true;
+
+    return released_bytes;
+}
+
+//! \brief Loads the atlas again after releaseImages(), if needed.
+void StyleImageProvider::restoreImages()
+{
+    Q_D(StyleImageProvider);
+    QMutexLocker lock(&d->mutex);
+    d->restore();
+}
+
+QImage StyleImageProvider::requestImage(const QString &id,
+                                        QSize *size,
+                                        const QSize &requested_size)
+{
+    Q_D(StyleImageProvider);
+    QMutexLocker lock(&d->mutex);
+
+    d->restore();
+
+    // Strip profile, see imageDirectory():
+    const QString name(id.section('/', 1));
+    QImage image(d->atlas.image(name));
+
+    if (image.isNull()) {
+        image = QImage(d->image_directory + "/" + name);
+    }
+
+    if (size) {
+        *size = image.size();
+    }
+
+    if (requested_size.isValid() && not image.isNull()) {
+        return image.scaled(requested_size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    }
+
+    return image;
+}
+
+} // namespace MaliitKeyboard
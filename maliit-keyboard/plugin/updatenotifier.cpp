@@ -30,6 +30,7 @@
  */
 
 #include "updatenotifier.h"
+#include "flushtimer.h"
 
 #include <maliit/plugins/updateevent.h>
 
@@ -51,16 +52,40 @@ public:
     UpdateNotifierPrivate();
 
     bool has_selection;
+    bool coalescing_enabled;
+    bool cursor_update_pending;
+    int pending_cursor_position;
+    QString pending_surrounding_text;
+    FlushTimer flush_timer;
 };
 
 UpdateNotifierPrivate::UpdateNotifierPrivate()
     : has_selection(false)
+    , coalescing_enabled(false)
+    , cursor_update_pending(false)
+    , pending_cursor_position(0)
+    , pending_surrounding_text()
+    , flush_timer("UpdateNotifier::flush")
 {}
 
+//! \class UpdateNotifier
+//! \brief Turns host update events into signals.
+//!
+//! With coalescing enabled, cursor and surrounding text updates are
+//! delivered at the end of the current event loop turn, and only the
+//! latest one. Applications send bursts of them during selection drags or
+//! programmatic edits, and each one makes the text editor look for the
+//! word at the cursor.
+
 UpdateNotifier::UpdateNotifier(QObject *parent)
     : QObject(parent)
     , d_ptr(new UpdateNotifierPrivate)
-{}
+{
+    Q_D(UpdateNotifier);
+
+    connect(&d->flush_timer, SIGNAL(timeout()),
+            this,            SLOT(flush()));
+}
 
 UpdateNotifier::~UpdateNotifier()
 {}
@@ -77,7 +102,10 @@ void UpdateNotifier::notify(MImUpdateEvent* event)
         d->has_selection = has_selection;
     }
 
-    if (not d->has_selection and properties_changed.contains(g_cursor_position_property)) {
+    if (d->has_selection) {
+        // Latest wins, and the latest state would not be emitted:
+        d->cursor_update_pending = false;
+    } else if (properties_changed.contains(g_cursor_position_property)) {
         const int cursor_position(event->value(g_cursor_position_property).toInt());
         const QString surrounding_text(event->value(g_surrounding_text_property).toString());
         bool emit_a_signal(true);
@@ -88,12 +116,54 @@ void UpdateNotifier::notify(MImUpdateEvent* event)
             emit_a_signal = (anchor_position == cursor_position);
         }
 
-        if (emit_a_signal) {
+        if (not emit_a_signal) {
+            d->cursor_update_pending = false;
+        } else if (d->coalescing_enabled) {
+            d->cursor_update_pending = true;
+            d->pending_cursor_position = cursor_position;
+            d->pending_surrounding_text = surrounding_text;
+
+            d->flush_timer.schedule();
+        } else {
             Q_EMIT cursorPositionChanged(cursor_position, surrounding_text);
         }
     }
 }
 
+//! \brief Sets whether cursor updates are coalesced. Disabled by default.
+void UpdateNotifier::setCoalescingEnabled(bool enabled)
+{
+    Q_D(UpdateNotifier);
+
+    if (d->coalescing_enabled != enabled) {
+        flush();
+        d->coalescing_enabled = enabled;
+    }
+}
+
+bool UpdateNotifier::isCoalescingEnabled() const
+{
+    Q_D(const UpdateNotifier);
+    return d->coalescing_enabled;
+}
+
+//! \brief Emits the pending cursor update, if any, right away.
+void UpdateNotifier::flush()
+{
+    Q_D(UpdateNotifier);
+    d->flush_timer.stop();
+
+    if (not d->cursor_update_pending) {
+        return;
+    }
+
+    d->cursor_update_pending = false;
+    const QString surrounding_text(d->pending_surrounding_text);
+    d->pending_surrounding_text.clear();
+
+    Q_EMIT cursorPositionChanged(d->pending_cursor_position, surrounding_text);
+}
+
 void UpdateNotifier::notifyOverride(const Logic::KeyOverrides &overriden_keys,
                                     bool update /* = false */)
 {
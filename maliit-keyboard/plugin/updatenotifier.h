@@ -59,6 +59,10 @@ public:
     void notifyOverride(const Logic::KeyOverrides &overriden_keys,
                         bool update = false);
 
+    void setCoalescingEnabled(bool enabled);
+    bool isCoalescingEnabled() const;
+    Q_SLOT void flush();
+
     Q_SIGNAL void cursorPositionChanged(int cursor_position,
                                         const QString &surrounding_text);
     Q_SIGNAL void keysOverriden(const Logic::KeyOverrides &overriden_keys,
@@ -45,7 +45,20 @@ Item {
         target: layout
         onTitleChanged: {
             console.debug("title:" + layout.title)
-            title_timeout.start()
+
+            if (maliit.shown) {
+                title_timeout.start()
+            }
+        }
+    }
+
+    // A hidden keyboard should not wake up by itself:
+    Connections {
+        target: maliit
+        onShownChanged: {
+            if (!maliit.shown) {
+                title_timeout.stop()
+            }
         }
     }
 
@@ -111,6 +124,11 @@ Item {
                     interval: 500
                 }
 
+                Connections {
+                    target: maliit
+                    onShownChanged: gesture_timeout.stop()
+                }
+
                 enabled: area_enabled
                 anchors.fill: parent
                 hoverEnabled: true
@@ -158,6 +176,8 @@ Item {
         opacity: title_timeout.running ? 1.0 : 0.0
 
         Behavior on opacity {
+            enabled: maliit.shown
+
             PropertyAnimation {
                 duration: 300
                 easing.type: Easing.InOutQuad
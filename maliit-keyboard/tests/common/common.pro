@@ -8,10 +8,12 @@ SOURCES += \
            utils.cpp \
            utils-gui.cpp \
            inputmethodhostprobe.cpp \
+           pluginsettingprobe.cpp \
 
 HEADERS += \
            utils.h \
            inputmethodhostprobe.h \
+           pluginsettingprobe.h \
 
 contains(QT_MAJOR_VERSION, 4) {
     QT = core gui
@@ -31,11 +31,14 @@
  */
 
 #include "inputmethodhostprobe.h"
+#include "pluginsettingprobe.h"
 #include <QtDebug>
 
 InputMethodHostProbe::InputMethodHostProbe()
     : m_commit_string_history()
     , m_last_preedit_string()
+    , m_commit_string_count(0)
+    , m_preedit_string_count(0)
     , m_last_key_event(QEvent::None, 0, Qt::NoModifier)
     , m_key_event_count(0)
     , m_last_preedit_text_format_list()
@@ -43,6 +46,7 @@ InputMethodHostProbe::InputMethodHostProbe()
     , m_last_replace_length(0)
     , m_last_cursor_pos(0)
     , m_preedit_string_sent(false)
+    , m_plugin_settings()
 {}
 
 QString InputMethodHostProbe::commitStringHistory() const
@@ -60,6 +64,12 @@ void InputMethodHostProbe::sendCommitString(const QString &string,
     Q_UNUSED(cursor_pos)
 
     m_commit_string_history.append(string);
+    ++m_commit_string_count;
+}
+
+int InputMethodHostProbe::commitStringCount() const
+{
+    return m_commit_string_count;
 }
 
 QString InputMethodHostProbe::lastPreeditString() const
@@ -87,6 +97,11 @@ bool InputMethodHostProbe::preeditStringSent() const
     return m_preedit_string_sent;
 }
 
+int InputMethodHostProbe::preeditStringCount() const
+{
+    return m_preedit_string_count;
+}
+
 void InputMethodHostProbe::sendPreeditString(const QString &string,
                                              const QList<Maliit::PreeditTextFormat> &format,
                                              int replace_start,
@@ -94,6 +109,7 @@ void InputMethodHostProbe::sendPreeditString(const QString &string,
                                              int cursor_pos)
 {
     m_preedit_string_sent = true;
+    ++m_preedit_string_count;
     m_last_preedit_string = string;
     m_last_preedit_text_format_list = format;
     m_last_replace_start = replace_start;
@@ -121,3 +137,26 @@ QList<Maliit::PreeditTextFormat> InputMethodHostProbe::lastPreeditTextFormatList
 {
     return m_last_preedit_text_format_list;
 }
+
+// Presets the value of a plugin setting that is registered later on:
+void InputMethodHostProbe::setPluginSetting(const QString &key,
+                                            const QVariant &value)
+{
+    m_plugin_settings.insert(key, value);
+}
+
+// Settings start out with their preset or default value, and are owned by
+// the caller:
+Maliit::Plugins::AbstractPluginSetting *InputMethodHostProbe::registerPluginSetting(const QString &key,
+                                                                                   const QString &,
+                                                                                   Maliit::SettingEntryType,
+                                                                                   const QVariantMap &attributes)
+{
+    PluginSettingProbe *setting(new PluginSettingProbe(key, attributes.value(Maliit::SettingEntryAttributes::defaultValue)));
+
+    if (m_plugin_settings.contains(key)) {
+        setting->set(m_plugin_settings.value(key));
+    }
+
+    return setting;
+}
@@ -46,6 +46,8 @@ class InputMethodHostProbe
 private:
     QString m_commit_string_history;
     QString m_last_preedit_string;
+    int m_commit_string_count;
+    int m_preedit_string_count;
     QKeyEvent m_last_key_event;
     int m_key_event_count;
     QList<Maliit::PreeditTextFormat> m_last_preedit_text_format_list;
@@ -53,11 +55,13 @@ private:
     int m_last_replace_length;
     int m_last_cursor_pos;
     bool m_preedit_string_sent;
+    QVariantMap m_plugin_settings;
 
 public:
     InputMethodHostProbe();
 
     QString commitStringHistory() const;
+    int commitStringCount() const;
     void sendCommitString(const QString &string,
                           int replace_start,
                           int replace_length,
@@ -68,6 +72,7 @@ public:
     int lastReplaceLength() const;
     int lastCursorPos() const;
     bool preeditStringSent() const;
+    int preeditStringCount() const;
     void sendPreeditString(const QString &string,
                            const QList<Maliit::PreeditTextFormat> &format,
                            int replace_start, 
@@ -79,6 +84,9 @@ public:
     void sendKeyEvent(const QKeyEvent& event, Maliit::EventRequestType);
     QList<Maliit::PreeditTextFormat> lastPreeditTextFormatList() const;
 
+    void setPluginSetting(const QString &key,
+                          const QVariant &value);
+
     // unused reimpl
     int contentType(bool&) {return 0;}
     bool correctionEnabled(bool&) {return false;}
@@ -103,10 +111,10 @@ public:
     void setSelection(int, int) {}
     void setOrientationAngleLocked(bool) {}
     QList<MImPluginDescription> pluginDescriptions(Maliit::HandlerState) const {return QList<MImPluginDescription>();}
-    Maliit::Plugins::AbstractPluginSetting* registerPluginSetting(const QString &,
+    Maliit::Plugins::AbstractPluginSetting* registerPluginSetting(const QString &key,
                                                                   const QString &,
                                                                   Maliit::SettingEntryType ,
-                                                                  const QVariantMap &) { return 0; }
+                                                                  const QVariantMap &attributes);
     void registerWindow(QWindow *, Maliit::Position) {}
 };
 
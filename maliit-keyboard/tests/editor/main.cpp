@@ -204,6 +204,67 @@ private:
         QCOMPARE(host.commitStringHistory(), expected_commit_history);
         QCOMPARE(auto_caps_activated_spy.count(), expected_auto_caps_activated_count);
     }
+
+    Q_SLOT void testBatching_data()
+    {
+        QTest::addColumn<bool>("enable_batching");
+        QTest::addColumn<int>("expected_preedit_count");
+        QTest::addColumn<int>("expected_commit_count");
+        QTest::addColumn<int>("expected_key_event_count");
+
+        // Two preedit updates per character, one commit per preedit and
+        // space, one key event per backspace:
+        QTest::newRow("direct") << false << 4 << 2 << 2;
+        // Commit replaces pending preedit updates, commits get merged,
+        // backspaces pressed within the same turn share one queue entry,
+        // but still delete one character each:
+        QTest::newRow("batched") << true << 0 << 1 << 2;
+    }
+
+    Q_SLOT void testBatching()
+    {
+        QFETCH(bool, enable_batching);
+        QFETCH(int, expected_preedit_count);
+        QFETCH(int, expected_commit_count);
+        QFETCH(int, expected_key_event_count);
+
+        Logic::WordEngineProbe *word_engine = new Logic::WordEngineProbe;
+        Editor editor(new Model::Text, word_engine, new Logic::LanguageFeatures);
+
+        InputMethodHostProbe host;
+        editor.setHost(&host);
+        editor.setBatchingEnabled(enable_batching);
+
+        initializeWordEngine(word_engine);
+
+        editor.wordEngine()->setEnabled(true);
+        editor.setPreeditEnabled(true);
+
+        appendInput(&editor, "He ");
+
+        Key backspace;
+        backspace.setAction(Key::ActionBackspace);
+
+        for (int index = 0; index < 2; ++index) {
+            editor.onKeyPressed(backspace);
+            editor.onKeyReleased(backspace);
+        }
+
+        if (enable_batching) {
+            QCOMPARE(editor.pendingOperationCount(), 2);
+            QCOMPARE(host.commitStringCount(), 0);
+            QCOMPARE(host.keyEventCount(), 0);
+
+            // Flushed at the end of the event loop turn:
+            QTRY_COMPARE(editor.pendingOperationCount(), 0);
+        }
+
+        QCOMPARE(host.preeditStringCount(), expected_preedit_count);
+        QCOMPARE(host.commitStringCount(), expected_commit_count);
+        QCOMPARE(host.commitStringHistory(), QString("He "));
+        QCOMPARE(host.keyEventCount(), expected_key_event_count);
+        QCOMPARE(host.lastKeyEvent().key(), int(Qt::Key_Backspace));
+    }
 };
 
 QTEST_MAIN(TestEditor)
@@ -0,0 +1,115 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+#include "plugin/geometrynotifier.h"
+
+#include <QtCore>
+#include <QtTest>
+
+using namespace MaliitKeyboard;
+
+class TestGeometryNotifier
+    : public QObject
+{
+    Q_OBJECT
+
+public:
+    Q_SLOT void onGeometryChanged(GeometryNotifier::Surfaces surfaces)
+    {
+        updates.append(surfaces);
+    }
+
+private:
+    QList<GeometryNotifier::Surfaces> updates;
+
+    Q_SLOT void init()
+    {
+        updates.clear();
+    }
+
+    Q_SLOT void testImmediate()
+    {
+        GeometryNotifier notifier;
+        connect(&notifier, SIGNAL(geometryChanged(GeometryNotifier::Surfaces)),
+                this,      SLOT(onGeometryChanged(GeometryNotifier::Surfaces)));
+
+        notifier.notify(GeometryNotifier::KeyboardSurface);
+        notifier.notify(GeometryNotifier::KeyboardSurface);
+
+        QCOMPARE(updates.count(), 2);
+        QCOMPARE(notifier.requestCount(), 2);
+        QCOMPARE(notifier.updateCount(), 2);
+        QCOMPARE(notifier.savedCount(), 0);
+    }
+
+    Q_SLOT void testCoalesced()
+    {
+        GeometryNotifier notifier;
+        notifier.setCoalescingEnabled(true);
+        connect(&notifier, SIGNAL(geometryChanged(GeometryNotifier::Surfaces)),
+                this,      SLOT(onGeometryChanged(GeometryNotifier::Surfaces)));
+
+        // Key area change of the main and extended layouts: width and
+        // height, then origin, width and height.
+        notifier.notify(GeometryNotifier::KeyboardSurface);
+        notifier.notify(GeometryNotifier::KeyboardSurface);
+        notifier.notify(GeometryNotifier::ExtendedSurface);
+        notifier.notify(GeometryNotifier::ExtendedSurface);
+        notifier.notify(GeometryNotifier::ExtendedSurface);
+        QVERIFY(updates.isEmpty());
+
+        QTRY_COMPARE(updates.count(), 1);
+        QCOMPARE(int(updates.first()), int(GeometryNotifier::KeyboardSurface
+                                           | GeometryNotifier::ExtendedSurface));
+        QCOMPARE(notifier.requestCount(), 5);
+        QCOMPARE(notifier.updateCount(), 2);
+        QCOMPARE(notifier.savedCount(), 3);
+
+        // Nothing left to deliver:
+        QTest::qWait(10);
+        QCOMPARE(updates.count(), 1);
+
+        // Explicit flush delivers right away:
+        notifier.notify(GeometryNotifier::MagnifierSurface);
+        notifier.flush();
+        QCOMPARE(updates.count(), 2);
+        QCOMPARE(int(updates.last()), int(GeometryNotifier::MagnifierSurface));
+
+        // Disabling coalescing delivers pending changes:
+        notifier.notify(GeometryNotifier::KeyboardSurface);
+        notifier.setCoalescingEnabled(false);
+        QCOMPARE(updates.count(), 3);
+    }
+};
+
+QTEST_MAIN(TestGeometryNotifier)
+#include "main.moc"
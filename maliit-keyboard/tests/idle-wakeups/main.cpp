@@ -0,0 +1,222 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+#include "wakeupmonitor.h"
+#include "plugin/inputmethod.h"
+#include "plugin/memorypressuremonitor.h"
+#include "models/key.h"
+#include "models/keyarea.h"
+#include "models/layout.h"
+#include "view/labelpreshaper.h"
+
+#include <inputmethodhostprobe.h>
+#include <maliit/plugins/updateevent.h>
+
+#include <QtCore>
+#include <QtQuick>
+#include <QtTest>
+
+using namespace MaliitKeyboard;
+
+namespace {
+
+const char *const g_auto_repeat_source("AbstractTextEditor::autoRepeat");
+
+MImUpdateEvent *createCursorUpdate(int cursor_position)
+{
+    QMap<QString, QVariant> update;
+    update.insert("surroundingText", "foo bar");
+    update.insert("cursorPosition", cursor_position);
+
+    return new MImUpdateEvent(update, QStringList() << "cursorPosition");
+}
+
+// Overlay surfaces are transient for the keyboard surface:
+QQuickView *keyboardSurface()
+{
+    Q_FOREACH (QWindow *window, QGuiApplication::topLevelWindows()) {
+        QQuickView *const view(qobject_cast<QQuickView *>(window));
+
+        if (view && view->isVisible() && not view->transientParent()) {
+            return view;
+        }
+    }
+
+    return 0;
+}
+
+} // namespace
+
+// Verifies that a hidden keyboard does not wake up by itself.
+class TestIdleWakeups
+    : public QObject
+{
+    Q_OBJECT
+
+private:
+    Q_SLOT void testMonitor()
+    {
+        WakeupMonitor monitor;
+        QVERIFY(not monitor.isEnabled());
+        QCOMPARE(monitor.phase(), WakeupMonitor::Hidden);
+
+        monitor.setEnabled(true);
+        monitor.setPhase(WakeupMonitor::Shown);
+
+        QTimer timer;
+        timer.setObjectName("test-timer");
+        timer.start(5);
+        QTRY_VERIFY(monitor.timerWakeups(WakeupMonitor::Shown, "test-timer") >= 3);
+        QVERIFY(monitor.wakeups(WakeupMonitor::Shown) > 0);
+
+        timer.stop();
+        monitor.setPhase(WakeupMonitor::Hidden);
+        QTest::qWait(50);
+
+        QCOMPARE(monitor.timerWakeups(WakeupMonitor::Hidden), 0);
+        QVERIFY(monitor.duration(WakeupMonitor::Hidden) > 0);
+        QVERIFY(monitor.report().contains("test-timer"));
+
+        monitor.reset();
+        QCOMPARE(monitor.timerWakeups(WakeupMonitor::Shown), 0);
+
+        // Nothing gets counted once disabled:
+        monitor.setEnabled(false);
+        timer.start(5);
+        QTest::qWait(50);
+        QCOMPARE(monitor.timerWakeups(WakeupMonitor::Hidden), 0);
+    }
+
+    // Hides the keyboard through InputMethod::hide() while backspace is
+    // held, and while the editor, the notifiers, the overlay warm-up and the
+    // QML keyboard have work queued. Key sounds are covered by pcm-feedback.
+    Q_SLOT void testHiddenTimers()
+    {
+        qputenv("MALIIT_KEYBOARD_WAKEUP_STATS", "1");
+        qputenv("MALIIT_KEYBOARD_TRIM_DELAY", "-1");
+
+        InputMethodHostProbe host;
+        host.setPluginSetting("feedback_enabled", false);
+        InputMethod input_method(&host);
+        const WakeupMonitor *const monitor(input_method.wakeupMonitor());
+        QVERIFY(monitor->isEnabled());
+
+        input_method.show();
+        QCOMPARE(monitor->phase(), WakeupMonitor::Shown);
+
+        QQuickView *surface(0);
+        QTRY_VERIFY((surface = keyboardSurface()) != 0);
+        QTRY_VERIFY(surface->rootObject() != 0);
+
+        const Model::Layout *const layout(qobject_cast<Model::Layout *>(
+                                              surface->rootObject()->property("layout").value<QObject *>()));
+        QVERIFY(layout);
+        QTRY_VERIFY(layout->keyArea().hasKeys());
+
+        Key backspace;
+        Q_FOREACH (const Key &key, layout->keyArea().keys()) {
+            if (key.action() == Key::ActionBackspace) {
+                backspace = key;
+            }
+        }
+
+        QCOMPARE(backspace.action(), Key::ActionBackspace);
+
+        const QPointF center(surface->rootObject()->mapToScene(QRectF(backspace.rect()).center()));
+        QTest::mousePress(surface, Qt::LeftButton, Qt::NoModifier, center.toPoint());
+
+        QTRY_VERIFY(host.keyEventCount() > 2);
+        QVERIFY(monitor->timerWakeups(WakeupMonitor::Shown, g_auto_repeat_source) > 0);
+
+        QScopedPointer<MImUpdateEvent> update(createCursorUpdate(3));
+        input_method.imExtensionEvent(update.data());
+
+        input_method.hide();
+        QCOMPARE(monitor->phase(), WakeupMonitor::Hidden);
+
+        // Lets deferred work of hiding itself finish:
+        QTest::qWait(50);
+
+        const int key_events(host.keyEventCount());
+        const int wakeups(monitor->timerWakeups(WakeupMonitor::Hidden));
+
+        // Longer than the title and gesture timeouts of the QML keyboard:
+        QTest::qWait(1500);
+
+        QCOMPARE(host.keyEventCount(), key_events);
+        QCOMPARE(monitor->timerWakeups(WakeupMonitor::Hidden), wakeups);
+        QCOMPARE(monitor->timerWakeups(WakeupMonitor::Hidden, g_auto_repeat_source), 0);
+    }
+
+    Q_SLOT void testSuspendedPreshaper()
+    {
+        LabelPreshaper preshaper;
+        preshaper.setBatchSize(1);
+
+        QStringList labels;
+        for (int index = 0; index < 100; ++index) {
+            labels.append(QString::number(index));
+        }
+
+        preshaper.preshape(labels);
+        preshaper.setSuspended(true);
+        QTest::qWait(50);
+
+        const int pending_labels(preshaper.pendingCount());
+        QVERIFY(pending_labels > 0);
+
+        QTest::qWait(100);
+        QCOMPARE(preshaper.pendingCount(), pending_labels);
+
+        // Pending labels get shaped once shown again:
+        preshaper.setSuspended(false);
+        QTRY_COMPARE(preshaper.pendingCount(), 0);
+    }
+
+    Q_SLOT void testMemoryPressure()
+    {
+        MemoryPressureMonitor monitor;
+        QSignalSpy spy(&monitor, SIGNAL(pressureReported()));
+
+        // No trigger without pressure stall information:
+        QVERIFY(not monitor.start("/nonexistent/pressure/memory"));
+        QVERIFY(not monitor.isActive());
+
+        // Other notifications can still report pressure:
+        monitor.reportPressure();
+        QCOMPARE(spy.count(), 1);
+        QCOMPARE(monitor.pressureCount(), 1);
+    }
+};
+
+QTEST_MAIN(TestIdleWakeups)
+#include "main.moc"
@@ -0,0 +1,122 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+#include "coreutils.h"
+#include "view/imageatlas.h"
+
+#include <QtCore>
+#include <QtGui>
+#include <QtTest>
+
+using namespace MaliitKeyboard;
+
+class TestImageAtlas
+    : public QObject
+{
+    Q_OBJECT
+
+private:
+    QTemporaryDir cache_directory;
+
+    Q_SLOT void testPacking()
+    {
+        const QString image_directory(CoreUtils::maliitKeyboardStyleProfilesDirectory() + "/ubuntu/images");
+        const QStringList files(QDir(image_directory).entryList(QStringList() << "*.png", QDir::Files));
+        QVERIFY(not files.isEmpty());
+
+        ImageAtlas atlas;
+        QVERIFY(atlas.load(image_directory));
+        QVERIFY(not atlas.isFromCache());
+        QCOMPARE(atlas.count(), files.count());
+
+        Q_FOREACH (const QString &file, files) {
+            const QImage expected(QImage(image_directory + "/" + file)
+                                  .convertToFormat(QImage::Format_ARGB32));
+            QCOMPARE(atlas.rect(file).size(), expected.size());
+            QVERIFY(atlas.image(file) == expected);
+        }
+
+        // Images must not overlap:
+        const QStringList names(atlas.names());
+        for (int i = 0; i < names.count(); ++i) {
+            for (int j = i + 1; j < names.count(); ++j) {
+                QVERIFY(not atlas.rect(names.at(i)).intersects(atlas.rect(names.at(j))));
+            }
+        }
+
+        QVERIFY(atlas.image("does-not-exist.png").isNull());
+    }
+
+    Q_SLOT void testSharedPixels()
+    {
+        const QString image_directory(CoreUtils::maliitKeyboardStyleProfilesDirectory() + "/ubuntu/images");
+
+        ImageAtlas atlas;
+        QVERIFY(atlas.load(image_directory));
+
+        const QString name(atlas.names().first());
+        const QImage whole(atlas.image());
+        const QImage image(atlas.image(name));
+
+        // Cut out images point into the atlas:
+        QVERIFY(image.constBits() >= whole.constBits());
+        QVERIFY(image.constBits() < whole.constBits() + whole.byteCount());
+
+        // ... and stay valid after the atlas is released:
+        const QImage expected(image.copy());
+        atlas.clear();
+        QVERIFY(image == expected);
+    }
+
+    Q_SLOT void testCache()
+    {
+        QVERIFY(cache_directory.isValid());
+        const QString image_directory(CoreUtils::maliitKeyboardStyleProfilesDirectory() + "/ubuntu/images");
+
+        ImageAtlas packed;
+        QVERIFY(packed.load(image_directory, cache_directory.path()));
+        QVERIFY(not packed.isFromCache());
+
+        ImageAtlas cached;
+        QVERIFY(cached.load(image_directory, cache_directory.path()));
+        QVERIFY(cached.isFromCache());
+        QCOMPARE(cached.count(), packed.count());
+
+        Q_FOREACH (const QString &name, packed.names()) {
+            QCOMPARE(cached.rect(name), packed.rect(name));
+            QVERIFY(cached.image(name) == packed.image(name));
+        }
+    }
+};
+
+QTEST_MAIN(TestImageAtlas)
+#include "main.moc"
@@ -0,0 +1,169 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ */
+
+
+#include "logic/eventhandler.h"
+#include "logic/layoutupdater.h"
+#include "models/layout.h"
+#include "models/keyarea.h"
+#include "models/key.h"
+
+#include <QtCore>
+#include <QtTest>
+
+using namespace MaliitKeyboard;
+
+namespace {
+
+Key createKey(const QString &text,
+              const QPoint &origin)
+{
+    Key key;
+    key.setOrigin(origin);
+    key.rArea().setSize(QSize(40, 50));
+    key.rLabel().setText(text);
+    KeyBackgrounds *backgrounds(new KeyBackgrounds);
+    backgrounds->backgrounds[KeyDescription::NormalState] = "key-normal.png";
+    backgrounds->backgrounds[KeyDescription::PressedState] = "key-pressed.png";
+    key.setStateBackgrounds(SharedKeyBackgrounds(backgrounds));
+    key.setState(KeyDescription::NormalState);
+
+    return key;
+}
+
+KeyArea createKeyArea(const QString &first,
+                      const QString &second)
+{
+    KeyArea key_area;
+    key_area.rArea().setSize(QSize(80, 50));
+    key_area.rKeys().append(createKey(first, QPoint(0, 0)));
+    key_area.rKeys().append(createKey(second, QPoint(40, 0)));
+
+    return key_area;
+}
+
+}
+
+class TestKeyStates
+    : public QObject
+{
+    Q_OBJECT
+
+private:
+    Q_SLOT void initTestCase()
+    {
+        qRegisterMetaType<Key>("Key");
+    }
+
+    Q_SLOT void testKeyLookup()
+    {
+        Model::Layout layout;
+        layout.setKeyArea(createKeyArea("a", "b"));
+
+        QVERIFY(not layout.hasKey(-1));
+        QVERIFY(not layout.hasKey(2));
+        QVERIFY(not layout.key(2).valid());
+
+        QVERIFY(layout.hasKey(1));
+        QCOMPARE(layout.key(1).label().text(), QString("b"));
+    }
+
+    Q_SLOT void testInPlaceKeyState()
+    {
+        const KeyArea key_area(createKeyArea("a", "b"));
+
+        Model::Layout layout;
+        layout.setKeyArea(key_area);
+
+        Logic::LayoutUpdater updater;
+        Logic::EventHandler event_handler(&layout, &updater);
+
+        QSignalSpy data_changed(&layout, SIGNAL(dataChanged(QModelIndex, QModelIndex)));
+        QSignalSpy key_pressed(&event_handler, SIGNAL(keyPressed(Key)));
+        QSignalSpy key_released(&event_handler, SIGNAL(keyReleased(Key)));
+
+        event_handler.onPressed(0);
+        QCOMPARE(data_changed.count(), 1);
+        QCOMPARE(key_pressed.count(), 1);
+        QCOMPARE(layout.key(0).state(), KeyDescription::PressedState);
+        QCOMPARE(layout.key(0).area().background(), QByteArray("key-pressed.png"));
+
+        const Key pressed(key_pressed.first().first().value<Key>());
+        QCOMPARE(pressed.label().text(), QString("a"));
+        QCOMPARE(pressed.state(), KeyDescription::PressedState);
+
+        // Key areas are shared implicitly, so the original must be unaffected:
+        QCOMPARE(key_area.keys().first().state(), KeyDescription::NormalState);
+
+        // Once the layout owns its keys, state changes happen in place:
+        const Key *const storage(&layout.key(0));
+
+        event_handler.onReleased(0);
+        QCOMPARE(data_changed.count(), 2);
+        QCOMPARE(key_released.count(), 1);
+        QCOMPARE(layout.key(0).state(), KeyDescription::NormalState);
+        QCOMPARE(&layout.key(0), storage);
+
+        event_handler.onPressed(0);
+        QCOMPARE(&layout.key(0), storage);
+
+        // Entering an already pressed key does not touch the model:
+        event_handler.onEntered(0);
+        QCOMPARE(data_changed.count(), 3);
+    }
+
+    Q_SLOT void testEnteredKey()
+    {
+        Model::Layout layout;
+        layout.setKeyArea(createKeyArea("a", "b"));
+
+        Logic::LayoutUpdater updater;
+        Logic::EventHandler event_handler(&layout, &updater);
+
+        QSignalSpy key_entered(&event_handler, SIGNAL(keyEntered(Key)));
+        QSignalSpy key_exited(&event_handler, SIGNAL(keyExited(Key)));
+
+        // Listeners get the key as it was before the state change:
+        event_handler.onEntered(1);
+        QCOMPARE(key_entered.count(), 1);
+        QCOMPARE(key_entered.first().first().value<Key>().state(), KeyDescription::NormalState);
+        QCOMPARE(layout.key(1).state(), KeyDescription::PressedState);
+
+        event_handler.onExited(1);
+        QCOMPARE(key_exited.count(), 1);
+        QCOMPARE(key_exited.first().first().value<Key>().state(), KeyDescription::PressedState);
+        QCOMPARE(layout.key(1).state(), KeyDescription::NormalState);
+    }
+};
+
+QTEST_MAIN(TestKeyStates)
+#include "main.moc"
@@ -36,10 +36,14 @@
 #include "models/keydescription.h"
 #include "models/keyboard.h"
 #include "models/styleattributes.h"
+#include "models/layout.h"
 #include "logic/keyboardloader.h"
 #include "logic/keyareaconverter.h"
+#include "logic/keyareacache.h"
+#include "logic/labeloverlay.h"
 #include "logic/style.h"
 #include "logic/layouthelper.h"
+#include "atoms.h"
 
 #include <QtCore>
 #include <QtTest>
@@ -56,6 +60,7 @@ typedef QPair<Key, KeyDescription> KeyDescriptionPair;
 
 Q_DECLARE_METATYPE(Dictionary)
 Q_DECLARE_METATYPE(Keyboard)
+Q_DECLARE_METATYPE(Logic::LayoutHelper::Panel)
 
 namespace {
 
@@ -571,6 +576,9 @@ private:
         QCOMPARE(style.profile(), QString("test-profile"));
         QCOMPARE(style.attributes()->fontSize(orientation), 10.0);
         QCOMPARE(style.extendedKeysAttributes()->fontSize(orientation), 0.0);
+        QCOMPARE(style.attributes()->metrics(orientation)->font_size, 10.0);
+        QCOMPARE(style.attributes()->metrics(orientation)->key_widths[KeyDescription::Large], 25.0);
+        QCOMPARE(style.attributes()->metrics(Logic::LayoutHelper::Portrait)->key_height, 80.0);
 
         const QString test_profile_dir(QString::fromLatin1(TEST_MALIIT_KEYBOARD_DATADIR)
                                        + "/styles/test-profile");
@@ -619,6 +627,276 @@ private:
         QCOMPARE(key.rect().x(), expected_left_edge);
         QCOMPARE(key.rect().x() + key.rect().width(), expected_right_edge);
     }
+
+    Q_SLOT void testKeyStateBackgrounds()
+    {
+        Style style;
+        style.setProfile("test-profile");
+        SharedKeyboardLoader loader(getLoader("styling_profile_test"));
+        Logic::KeyAreaConverter converter(style.attributes(), loader.data());
+
+        Key key(converter.keyArea().keys().at(0));
+
+        QVERIFY(key.hasStateBackgrounds());
+        const QByteArray icon(key.icon());
+        QCOMPARE(key.state(), KeyDescription::NormalState);
+        QCOMPARE(key.area().background(), QByteArray("key-background.png"));
+
+        key.setState(KeyDescription::PressedState);
+        QCOMPARE(key.state(), KeyDescription::PressedState);
+        QCOMPARE(key.area().background(), QByteArray("key-background-pressed.png"));
+
+        QCOMPARE(key.icon(), icon);
+
+        key.setState(KeyDescription::NormalState);
+        QCOMPARE(key.area().background(), QByteArray("key-background.png"));
+    }
+
+    Q_SLOT void testKeyAreaCache()
+    {
+        Style style;
+        style.setProfile("test-profile");
+        SharedKeyboardLoader loader(getLoader("styling_profile_test"));
+        Logic::KeyAreaCache cache;
+        Logic::KeyAreaConverter converter(style.attributes(), loader.data(), &cache);
+
+        const KeyArea first(converter.keyArea());
+        QCOMPARE(cache.misses(), 1);
+        QCOMPARE(cache.hits(), 0);
+        QCOMPARE(cache.count(), 1);
+
+        const KeyArea second(converter.keyArea());
+        QCOMPARE(cache.hits(), 1);
+        QVERIFY(first == second);
+
+        // Other orientation is a different key area:
+        converter.setLayoutOrientation(Logic::LayoutHelper::Portrait);
+        const KeyArea portrait(converter.keyArea());
+        QCOMPARE(cache.misses(), 2);
+        QCOMPARE(cache.count(), 2);
+        QVERIFY(portrait != first);
+
+        cache.clear();
+        QCOMPARE(cache.count(), 0);
+    }
+
+    Q_SLOT void testExtendedKeyAreaCache()
+    {
+        Style style;
+        style.setProfile("test-profile");
+        SharedKeyboardLoader loader(getLoader("extended_test"));
+        Logic::KeyAreaCache cache;
+        Logic::KeyAreaConverter converter(style.extendedKeysAttributes(), loader.data(), &cache);
+
+        const KeyArea shifted(converter.extendedKeyArea(getKey("A")));
+        QCOMPARE(shifted.keys().count(), 3);
+        QCOMPARE(cache.misses(), 1);
+        QCOMPARE(cache.count(), 1);
+
+        QVERIFY(converter.extendedKeyArea(getKey("A")) == shifted);
+        QCOMPARE(cache.hits(), 1);
+
+        // Each key, and each shift state, has its own extended key area:
+        const KeyArea other(converter.extendedKeyArea(getKey("d")));
+        QCOMPARE(cache.misses(), 2);
+        QCOMPARE(cache.count(), 2);
+        QVERIFY(other != shifted);
+
+        // Spacebars are never looked up:
+        QVERIFY(not converter.extendedKeyArea(getKey("", Key::ActionSpace)).hasKeys());
+        QCOMPARE(cache.misses(), 2);
+        QCOMPARE(cache.count(), 2);
+    }
+
+    Q_SLOT void testLabels()
+    {
+        SharedKeyboardLoader loader(getLoader("general_test1"));
+        const QStringList labels(loader->labels());
+
+        // Main, shifted, extended, symbols, number and phone number views:
+        const QStringList expected(QStringList() << "q" << "Q" << "w" << "W" << "y" << "U"
+                                                 << "1" << "4" << "0" << "9");
+
+        Q_FOREACH (const QString &label, expected) {
+            QVERIFY2(labels.contains(label), qPrintable(label));
+        }
+
+        QCOMPARE(labels.toSet().count(), labels.count());
+    }
+
+    Q_SLOT void testLabelOverlay()
+    {
+        Style style;
+        style.setProfile("test-profile");
+        SharedKeyboardLoader loader(getLoader("general_test1"));
+        Logic::KeyAreaConverter converter(style.attributes(), loader.data());
+
+        const KeyArea main(converter.keyArea());
+        const KeyArea shifted(converter.shiftedKeyArea());
+        const Logic::LabelOverlay overlay(Logic::LabelOverlay::fromKeyAreas(main, shifted));
+
+        QVERIFY(overlay.isValid());
+        QVERIFY(overlay.count() > 0);
+        QVERIFY(overlay.appliesTo(main));
+        QVERIFY(overlay.apply(main) == shifted);
+
+        converter.setLayoutOrientation(Logic::LayoutHelper::Portrait);
+        const KeyArea portrait(converter.keyArea());
+        QVERIFY(not overlay.appliesTo(portrait));
+        QVERIFY(not Logic::LabelOverlay::fromKeyAreas(main, portrait).isValid());
+
+        // Label-only changes must not reset the model:
+        Model::Layout model;
+        model.setKeyArea(main);
+
+        QSignalSpy reset_spy(&model, SIGNAL(modelReset()));
+        QSignalSpy data_spy(&model, SIGNAL(dataChanged(QModelIndex, QModelIndex)));
+
+        model.setKeyArea(overlay.apply(main));
+        QCOMPARE(reset_spy.count(), 0);
+        QCOMPARE(data_spy.count(), 1);
+        QVERIFY(model.keyArea() == shifted);
+
+        model.setKeyArea(portrait);
+        QCOMPARE(reset_spy.count(), 1);
+    }
+
+    Q_SLOT void testInternedStrings()
+    {
+        const QByteArray first(Atoms::intern(QByteArray("key-background.png")));
+        const QByteArray second(Atoms::intern(QString("key-background.png").toUtf8()));
+        QVERIFY(first.constData() == second.constData());
+        QVERIFY(Atoms::same(first, second));
+        QVERIFY(not Atoms::same(first, QByteArray("other.png")));
+        QVERIFY(Atoms::intern(QByteArray()).isNull());
+
+        Style style;
+        style.setProfile("test-profile");
+        SharedKeyboardLoader loader(getLoader("general_test1"));
+        Logic::KeyAreaConverter converter(style.attributes(), loader.data());
+
+        const KeyArea landscape(converter.keyArea());
+        converter.setLayoutOrientation(Logic::LayoutHelper::Portrait);
+        const KeyArea portrait(converter.keyArea());
+
+        // Separate conversions share their strings:
+        const Key &l(landscape.keyAt(0));
+        const Key &p(portrait.keyAt(0));
+        QVERIFY(not l.area().background().isEmpty());
+        QVERIFY(l.area().background().constData() == p.area().background().constData());
+        QVERIFY(l.label().text().constData() == p.label().text().constData());
+        QVERIFY(l.label().font().name().constData() == p.label().font().name().constData());
+
+        // ... and so do keys of the same style:
+        QVERIFY(landscape.keyAt(1).area().background().constData()
+                == landscape.keyAt(2).area().background().constData());
+
+        const int atoms(Atoms::count());
+        converter.setLayoutOrientation(Logic::LayoutHelper::Landscape);
+        converter.keyArea();
+        QCOMPARE(Atoms::count(), atoms);
+
+        // Purging keeps strings that are still in use:
+        Atoms::intern(QByteArray("unused.png"));
+        QVERIFY(Atoms::purge() > 0);
+        QVERIFY(Atoms::count() <= atoms);
+        QVERIFY(Atoms::intern(l.area().background()).constData()
+                == l.area().background().constData());
+        QVERIFY(Atoms::intern(first).constData() == first.constData());
+    }
+
+    Q_SLOT void testOverrideIds()
+    {
+        qRegisterMetaType<Logic::LayoutHelper::Panel>("Logic::LayoutHelper::Panel");
+        qRegisterMetaType<Logic::KeyOverrides>("Logic::KeyOverrides");
+
+        Style style;
+        style.setProfile("test-profile");
+        SharedKeyboardLoader loader(getLoader("general_test1"));
+        Logic::KeyAreaConverter converter(style.attributes(), loader.data());
+
+        const KeyArea main(converter.keyArea());
+        QCOMPARE(main.keyIndices("q"), QVector<int>() << 0);
+        QVERIFY(main.keyIndices("Q").isEmpty());
+        QVERIFY(main.keyIndices(QString()).isEmpty());
+
+        // Relabeled keys are found by their new id:
+        const Logic::LabelOverlay overlay(Logic::LabelOverlay::fromKeyAreas(main, converter.shiftedKeyArea()));
+        const KeyArea shifted(overlay.apply(main));
+        QCOMPARE(shifted.keyIndices("Q"), QVector<int>() << 0);
+        QVERIFY(shifted.keyIndices("q").isEmpty());
+
+        // Without an index, keys are scanned:
+        KeyArea modified(main);
+        modified.rKeys()[0].rLabel().setText("x");
+        QCOMPARE(modified.keyIndices("x"), QVector<int>() << 0);
+        QVERIFY(modified.keyIndices("q").isEmpty());
+
+        Logic::LayoutHelper helper;
+        helper.setCenterPanel(main);
+
+        QSignalSpy panel_spy(&helper, SIGNAL(centerPanelChanged(KeyArea, Logic::KeyOverrides)));
+        QSignalSpy keys_spy(&helper, SIGNAL(overridenKeysChanged(Logic::LayoutHelper::Panel, QVector<int>,
+                                                                 Logic::KeyOverrides)));
+
+        Key override_key;
+        override_key.rLabel().setText("override");
+
+        Logic::KeyOverrides overrides;
+        overrides.insert("q", Key());
+        overrides.insert("unknown", Key());
+        helper.onKeysOverriden(overrides, false);
+
+        QCOMPARE(keys_spy.count(), 1);
+        QCOMPARE(keys_spy.at(0).at(0).value<Logic::LayoutHelper::Panel>(), Logic::LayoutHelper::CenterPanel);
+        QCOMPARE(keys_spy.at(0).at(1).value<QVector<int> >(), QVector<int>() << 0);
+
+        // Updates only touch keys whose override actually changed:
+        Logic::KeyOverrides update;
+        update.insert("unknown", override_key);
+        helper.onKeysOverriden(update, true);
+        QCOMPARE(keys_spy.count(), 1);
+
+        update.insert("q", override_key);
+        helper.onKeysOverriden(update, true);
+        QCOMPARE(keys_spy.count(), 2);
+
+        helper.onKeysOverriden(update, true);
+        QCOMPARE(keys_spy.count(), 2);
+
+        // Panels are not announced again:
+        QCOMPARE(panel_spy.count(), 0);
+
+        // The layout model applies overrides to announced keys only:
+        Model::Layout model;
+        model.setKeyArea(main);
+        QSignalSpy data_spy(&model, SIGNAL(dataChanged(QModelIndex, QModelIndex)));
+
+        model.applyKeyOverrides(keys_spy.last().at(1).value<QVector<int> >(), update);
+        QCOMPARE(data_spy.count(), 1);
+        QCOMPARE(data_spy.at(0).at(0).value<QModelIndex>().row(), 0);
+        QCOMPARE(data_spy.at(0).at(1).value<QModelIndex>().row(), 0);
+        QCOMPARE(model.keyArea().keyAt(0).label().text(), QString("override"));
+        QCOMPARE(model.keyArea().keyAt(1).label().text(), main.keyAt(1).label().text());
+
+        // Overriden keys are still found by their original id:
+        override_key.rLabel().setText("again");
+        update.insert("q", override_key);
+        model.applyKeyOverrides(QVector<int>() << 0, update);
+        QCOMPARE(model.keyArea().keyAt(0).label().text(), QString("again"));
+
+        // Overrides are kept across view changes, matching by key id:
+        model.setKeyArea(shifted);
+        QCOMPARE(model.keyArea().keyAt(0).label().text(), QString("Q"));
+        model.setKeyArea(main);
+        QCOMPARE(model.keyArea().keyAt(0).label().text(), QString("again"));
+        model.setKeyArea(main, update);
+        QCOMPARE(model.keyArea().keyAt(0).label().text(), QString("again"));
+
+        // Without override, the original key comes back:
+        model.applyKeyOverrides(QVector<int>() << 0, Logic::KeyOverrides());
+        QCOMPARE(model.keyArea().keyAt(0).label().text(), QString("q"));
+    }
 };
 
 QTEST_MAIN(TestLanguageLayoutLoading)
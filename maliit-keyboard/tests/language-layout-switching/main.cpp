@@ -85,6 +85,173 @@ private:
         QCOMPARE(layout.activeKeyArea().keys().count(), expected_key_count);
     }
 
+    Q_SLOT void testCoalescedRebuilds()
+    {
+        Logic::LayoutUpdater layout_updater;
+        layout_updater.setAsynchronousLoading(true);
+
+        Logic::LayoutHelper layout(new Logic::LayoutHelper);
+        layout_updater.setLayout(&layout);
+
+        SharedStyle style(new Style);
+        layout_updater.setStyle(style);
+        QTest::qWait(50);
+
+        QSignalSpy center_panel_spy(&layout, SIGNAL(centerPanelChanged(KeyArea,Logic::KeyOverrides)));
+        const int rebuilds(layout_updater.rebuildCount());
+
+        // The language switch and the orientation change both ask for a
+        // rebuild:
+        layout_updater.setActiveKeyboardId("en_gb");
+        layout_updater.setOrientation(Logic::LayoutHelper::Portrait);
+        TestUtils::waitForSignal(&layout, SIGNAL(centerPanelChanged(KeyArea,Logic::KeyOverrides)));
+        QTest::qWait(50);
+
+        QCOMPARE(layout_updater.rebuildCount() - rebuilds, 1);
+        QVERIFY(layout_updater.coalescedRebuildCount() > 0);
+        QCOMPARE(center_panel_spy.count(), 1);
+        QCOMPARE(layout.orientation(), Logic::LayoutHelper::Portrait);
+        QCOMPARE(layout.activeKeyArea().keys().count(), 33);
+    }
+
+    Q_SLOT void testSynchronousRebuilds()
+    {
+        Logic::LayoutUpdater layout_updater;
+
+        Logic::LayoutHelper layout(new Logic::LayoutHelper);
+        layout_updater.setLayout(&layout);
+
+        SharedStyle style(new Style);
+        layout_updater.setStyle(style);
+
+        // Without asynchronous loading, nothing waits for the event loop:
+        layout_updater.setActiveKeyboardId("en_gb");
+        QCOMPARE(layout.activeKeyArea().keys().count(), 33);
+        QCOMPARE(layout_updater.coalescedRebuildCount(), 0);
+
+        // ...nor converts views in the background:
+        QTest::qWait(50);
+        QCOMPARE(layout_updater.preparedKeyAreaCount(), 1);
+    }
+
+    Q_SLOT void testKeyboardLabels()
+    {
+        // Labels get collected without asynchronous loading, too:
+        Logic::LayoutUpdater layout_updater;
+        QVERIFY(not layout_updater.isAsynchronousLoading());
+
+        Logic::LayoutHelper layout(new Logic::LayoutHelper);
+        layout_updater.setLayout(&layout);
+
+        SharedStyle style(new Style);
+        layout_updater.setStyle(style);
+
+        QSignalSpy labels_spy(&layout_updater, SIGNAL(keyboardLabelsLoaded(QString, QStringList)));
+        layout_updater.setActiveKeyboardId("en_gb");
+
+        QTRY_VERIFY(not labels_spy.isEmpty());
+        const QList<QVariant> arguments(labels_spy.last());
+        QCOMPARE(arguments.at(0).toString(), QString("en_gb"));
+        QVERIFY(arguments.at(1).toStringList().contains("q"));
+    }
+
+    Q_SLOT void testPreparedOrientation()
+    {
+        Logic::LayoutUpdater layout_updater;
+        layout_updater.setAsynchronousLoading(true);
+
+        Logic::LayoutHelper layout(new Logic::LayoutHelper);
+        layout_updater.setLayout(&layout);
+
+        SharedStyle style(new Style);
+        layout_updater.setStyle(style);
+
+        layout_updater.setActiveKeyboardId("en_gb");
+        TestUtils::waitForSignal(&layout, SIGNAL(centerPanelChanged(KeyArea,Logic::KeyOverrides)));
+
+        // The shown key area, plus main and shifted views for portrait:
+        QTRY_VERIFY(layout_updater.preparedKeyAreaCount() >= 3);
+        QCOMPARE(layout_updater.preparedRebuildCount(), 0);
+
+        // Prepared key areas bring back the style name they were converted
+        // with:
+        const QString style_name(style->attributes()->styleName());
+        style->attributes()->setStyleName("unknown");
+
+        layout_updater.setOrientation(Logic::LayoutHelper::Portrait);
+        TestUtils::waitForSignal(&layout, SIGNAL(centerPanelChanged(KeyArea,Logic::KeyOverrides)));
+
+        QCOMPARE(layout_updater.preparedRebuildCount(), 1);
+        QCOMPARE(style->attributes()->styleName(), style_name);
+        QCOMPARE(layout.orientation(), Logic::LayoutHelper::Portrait);
+        QCOMPARE(layout.activeKeyArea().keys().count(), 33);
+    }
+
+    Q_SLOT void testPreparedShiftOverlay()
+    {
+        Logic::LayoutUpdater layout_updater;
+        layout_updater.setAsynchronousLoading(true);
+
+        Logic::LayoutHelper layout(new Logic::LayoutHelper);
+        layout_updater.setLayout(&layout);
+
+        SharedStyle style(new Style);
+        layout_updater.setStyle(style);
+
+        layout_updater.setActiveKeyboardId("en_gb");
+        TestUtils::waitForSignal(&layout, SIGNAL(centerPanelChanged(KeyArea,Logic::KeyOverrides)));
+
+        // The shifted view gets converted in the background after load,
+        // following main and shifted views for the other orientation:
+        QTRY_VERIFY(layout_updater.preparedKeyAreaCount() >= 4);
+
+        // Overlaid views bring back the style name of their main view:
+        const QString style_name(style->attributes()->styleName());
+        style->attributes()->setStyleName("unknown");
+
+        layout_updater.onAutoCapsActivated();
+        TestUtils::waitForSignal(&layout, SIGNAL(centerPanelChanged(KeyArea,Logic::KeyOverrides)));
+
+        QCOMPARE(layout_updater.overlaidRebuildCount(), 1);
+        QCOMPARE(layout.activeKeyArea().keys().count(), 33);
+        QCOMPARE(style->attributes()->styleName(), style_name);
+    }
+
+    Q_SLOT void testExtendedKeysWarmup()
+    {
+        Logic::LayoutUpdater layout_updater;
+        layout_updater.setExtendedKeysWarmupEnabled(true);
+
+        Logic::LayoutHelper layout(new Logic::LayoutHelper);
+        layout_updater.setLayout(&layout);
+
+        SharedStyle style(new Style);
+        layout_updater.setStyle(style);
+
+        layout_updater.setActiveKeyboardId("en_gb");
+
+        Key key_with_extended_keys;
+        QSet<QString> labels;
+
+        Q_FOREACH (const Key &key, layout.centerPanel().keys()) {
+            if (key.hasExtendedKeys() && key.action() != Key::ActionSpace) {
+                key_with_extended_keys = key;
+                labels.insert(key.label().text());
+            }
+        }
+
+        // Converted on the pipeline's worker thread:
+        QVERIFY(not labels.isEmpty());
+        QTRY_VERIFY(layout_updater.extendedKeyAreaCount() >= labels.count());
+        QTest::qWait(50);
+        const int warmed_up(layout_updater.extendedKeyAreaCount());
+
+        // Long press only looks up what warm-up converted already:
+        layout_updater.onKeyLongPressed(key_with_extended_keys);
+        QCOMPARE(layout_updater.extendedKeyAreaCount(), warmed_up);
+        QCOMPARE(layout.activePanel(), Logic::LayoutHelper::ExtendedPanel);
+    }
+
     // This test is very trivial. It's required however because none of the
     // current mainline layouts feature layout switch keys, thus making
     // regressions impossible to spot.
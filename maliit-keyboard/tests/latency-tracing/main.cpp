@@ -0,0 +1,195 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+#include "tracing.h"
+#include "models/layout.h"
+#include "models/keyarea.h"
+#include "models/key.h"
+
+#include <QtCore>
+#include <QtTest>
+
+using namespace MaliitKeyboard;
+
+namespace {
+
+class TracingThread
+    : public QThread
+{
+protected:
+    virtual void run()
+    {
+        Tracing::instant("worker");
+    }
+};
+
+QJsonArray traceEvents()
+{
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+
+    if (not Tracing::writeChromeTrace(&buffer)) {
+        return QJsonArray();
+    }
+
+    return QJsonDocument::fromJson(buffer.data()).object().value("traceEvents").toArray();
+}
+
+QJsonArray eventsNamed(const QJsonArray &events,
+                       const QString &name)
+{
+    QJsonArray result;
+
+    Q_FOREACH (const QJsonValue &event, events) {
+        if (event.toObject().value("name").toString() == name) {
+            result.append(event);
+        }
+    }
+
+    return result;
+}
+
+} // namespace
+
+class TestLatencyTracing
+    : public QObject
+{
+    Q_OBJECT
+
+private:
+    Q_SLOT void init()
+    {
+        Tracing::setEnabled(true);
+        Tracing::clear();
+    }
+
+    Q_SLOT void cleanup()
+    {
+        Tracing::setEnabled(false);
+    }
+
+    Q_SLOT void testDisabled()
+    {
+        Tracing::setEnabled(false);
+        Tracing::instant("ignored");
+        QCOMPARE(Tracing::eventCount(), 0);
+    }
+
+    Q_SLOT void testScopes()
+    {
+        {
+            MALIIT_TRACE_SCOPE("outer");
+            Tracing::instant("point");
+        }
+
+        QCOMPARE(Tracing::eventCount(), 3);
+
+        const QJsonArray events(traceEvents());
+        const QJsonArray outer(eventsNamed(events, "outer"));
+        const QJsonArray point(eventsNamed(events, "point"));
+
+        QCOMPARE(outer.count(), 2);
+        QCOMPARE(point.count(), 1);
+        QCOMPARE(outer.at(0).toObject().value("ph").toString(), QString("B"));
+        QCOMPARE(point.at(0).toObject().value("ph").toString(), QString("i"));
+        QCOMPARE(outer.at(1).toObject().value("ph").toString(), QString("E"));
+
+        const double begin(outer.at(0).toObject().value("ts").toDouble());
+        const double instant(point.at(0).toObject().value("ts").toDouble());
+        const double end(outer.at(1).toObject().value("ts").toDouble());
+        QVERIFY(begin <= instant);
+        QVERIFY(instant <= end);
+
+        const QJsonArray names(eventsNamed(events, "thread_name"));
+        QVERIFY(not names.isEmpty());
+        QCOMPARE(names.at(0).toObject().value("args").toObject().value("name").toString(), QString("main"));
+    }
+
+    Q_SLOT void testTracePoints()
+    {
+        KeyArea key_area;
+        key_area.rKeys().append(Key());
+
+        Model::Layout layout;
+        layout.setKeyArea(key_area);
+        layout.replaceKey(0, Key());
+
+        QCOMPARE(eventsNamed(traceEvents(), "Model::Layout::replaceKey").count(), 2);
+    }
+
+    Q_SLOT void testThreads()
+    {
+        Tracing::instant("main");
+
+        TracingThread thread;
+        thread.start();
+        QVERIFY(thread.wait());
+
+        // Buffers of finished threads are kept.
+        const QJsonArray events(traceEvents());
+        const QJsonArray main(eventsNamed(events, "main"));
+        const QJsonArray worker(eventsNamed(events, "worker"));
+
+        QCOMPARE(main.count(), 1);
+        QCOMPARE(worker.count(), 1);
+        QVERIFY(main.at(0).toObject().value("tid").toInt()
+                != worker.at(0).toObject().value("tid").toInt());
+    }
+
+    Q_SLOT void testRingBuffer()
+    {
+        for (int index = 0; index < Tracing::capacity() + 10; ++index) {
+            Tracing::instant("repeated");
+        }
+
+        QCOMPARE(Tracing::eventCount(), Tracing::capacity());
+        QCOMPARE(eventsNamed(traceEvents(), "repeated").count(), Tracing::capacity());
+    }
+
+    Q_SLOT void testDump()
+    {
+        QTemporaryDir directory;
+        QVERIFY(directory.isValid());
+
+        Tracing::instant("dumped");
+
+        const QString file_name(directory.path() + "/trace.json");
+        QVERIFY(Tracing::dumpChromeTrace(file_name));
+
+        QFile file(file_name);
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        QVERIFY(QJsonDocument::fromJson(file.readAll()).isObject());
+    }
+};
+
+QTEST_MAIN(TestLatencyTracing)
+#include "main.moc"
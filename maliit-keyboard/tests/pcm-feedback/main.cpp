@@ -0,0 +1,234 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+#include "coreutils.h"
+#include "logic/style.h"
+#include "view/pcmsound.h"
+#include "view/audiomixer.h"
+#include "view/audiosink.h"
+#include "view/pcmfeedback.h"
+
+#include <QtCore>
+#include <QtTest>
+
+using namespace MaliitKeyboard;
+
+namespace {
+
+PcmSound constantSound(int frames,
+                       qint16 value)
+{
+    return PcmSound(8000, 1, QVector<qint16>(frames, value));
+}
+
+QByteArray wavHeader(int channels,
+                     int sample_rate,
+                     int bits_per_sample,
+                     int data_size)
+{
+    QByteArray header;
+    QDataStream stream(&header, QIODevice::WriteOnly);
+    stream.setByteOrder(QDataStream::LittleEndian);
+
+    stream.writeRawData("RIFF", 4);
+    stream << quint32(36 + data_size);
+    stream.writeRawData("WAVE", 4);
+    stream.writeRawData("fmt ", 4);
+    stream << quint32(16) << quint16(1) << quint16(channels) << quint32(sample_rate)
+           << quint32(sample_rate * channels * bits_per_sample / 8)
+           << quint16(channels * bits_per_sample / 8) << quint16(bits_per_sample);
+    stream.writeRawData("data", 4);
+    stream << quint32(data_size);
+
+    return header;
+}
+
+} // namespace
+
+class TestPcmFeedback
+    : public QObject
+{
+    Q_OBJECT
+
+private:
+    Q_SLOT void testWavDecoding()
+    {
+        const PcmSound typewriter(PcmSound::fromWav(CoreUtils::maliitKeyboardStyleProfilesDirectory()
+                                                    + "/ubuntu/sounds/typewriter.wav"));
+        QVERIFY(not typewriter.isNull());
+        QCOMPARE(typewriter.sampleRate(), 44100);
+        QCOMPARE(typewriter.channels(), 2);
+        QCOMPARE(typewriter.frameCount(), 44032);
+
+        // 8 bit samples are unsigned and get widened.
+        QByteArray eight_bit(wavHeader(1, 8000, 8, 3));
+        eight_bit.append(char(0)).append(char(128)).append(char(255));
+
+        const PcmSound widened(PcmSound::fromWav(eight_bit));
+        QCOMPARE(widened.frameCount(), 3);
+        QCOMPARE(int(widened.samples().at(0)), -32768);
+        QCOMPARE(int(widened.samples().at(1)), 0);
+        QCOMPARE(int(widened.samples().at(2)), 127 << 8);
+
+        QVERIFY(PcmSound::fromWav(QByteArray("RIFF")).isNull());
+        QVERIFY(PcmSound::fromWav(wavHeader(1, 8000, 24, 0)).isNull());
+    }
+
+    Q_SLOT void testConversion()
+    {
+        const PcmSound mono(constantSound(100, 1000));
+        const PcmSound stereo(mono.converted(16000, 2));
+
+        QCOMPARE(stereo.sampleRate(), 16000);
+        QCOMPARE(stereo.channels(), 2);
+        QCOMPARE(stereo.frameCount(), 200);
+        QCOMPARE(stereo.durationMs(), mono.durationMs());
+
+        Q_FOREACH (qint16 sample, stereo.samples()) {
+            QCOMPARE(int(sample), 1000);
+        }
+    }
+
+    Q_SLOT void testMixer()
+    {
+        AudioMixer mixer(8000, 1);
+        mixer.setRetriggerInterval(0);
+        mixer.setMaximumVoices(2);
+        mixer.setSound(0, constantSound(100, 1000));
+        mixer.setSound(1, constantSound(100, 30000));
+
+        QVector<qint16> buffer(60);
+        QVERIFY(not mixer.mix(buffer.data(), 60));
+        QVERIFY(not mixer.trigger(2));
+
+        // Overlapping voices add up.
+        QVERIFY(mixer.trigger(0));
+        QVERIFY(mixer.mix(buffer.data(), 60));
+        QCOMPARE(int(buffer.at(59)), 1000);
+        QVERIFY(mixer.trigger(0));
+        QCOMPARE(mixer.activeVoices(), 2);
+        QVERIFY(mixer.mix(buffer.data(), 60));
+        QCOMPARE(int(buffer.at(0)), 2000);
+        QCOMPARE(int(buffer.at(59)), 1000);
+        QCOMPARE(mixer.activeVoices(), 1);
+
+        // The oldest voice gets dropped, and the sum gets clipped.
+        QVERIFY(mixer.trigger(1));
+        QVERIFY(mixer.trigger(1));
+        QCOMPARE(mixer.activeVoices(), 2);
+        QVERIFY(mixer.mix(buffer.data(), 60));
+        QCOMPARE(int(buffer.at(0)), 32767);
+
+        mixer.stopAll();
+        QCOMPARE(mixer.activeVoices(), 0);
+
+        // Auto-repeat gets rate limited per sound.
+        AudioMixer repeating(8000, 1);
+        repeating.setRetriggerInterval(10000);
+        repeating.setSound(0, constantSound(100, 1000));
+        repeating.setSound(1, constantSound(100, 1000));
+        QVERIFY(repeating.trigger(0));
+        QVERIFY(not repeating.trigger(0));
+        QVERIFY(repeating.trigger(1));
+        QCOMPARE(repeating.activeVoices(), 2);
+    }
+
+    Q_SLOT void testNullSink()
+    {
+        NullAudioSink *sink(new NullAudioSink(8000, 1, 10));
+        PcmFeedback feedback(sink);
+        QVERIFY(feedback.isEnabled());
+
+        SharedStyle style(new Style);
+        style->setProfile("ubuntu");
+        feedback.setStyle(style);
+
+        QTRY_VERIFY(sink->periodCount() > 0);
+        QVERIFY(sink->recordedPeriods().isEmpty());
+
+        feedback.onKeyPressed();
+        QTRY_VERIFY(not sink->recordedPeriods().isEmpty());
+
+        const NullAudioSink::Period first(sink->recordedPeriods().first());
+        QCOMPARE(first.samples.size(), sink->periodFrames());
+        QVERIFY(first.timestamp >= 0);
+
+        // Auto-repeat faster than the retrigger interval only plays once.
+        feedback.mixer()->stopAll();
+        feedback.mixer()->setRetriggerInterval(10000);
+        feedback.onKeyReleased();
+        feedback.onKeyReleased();
+        QCOMPARE(feedback.mixer()->activeVoices(), 1);
+
+        // Layout change has no sound in this profile.
+        feedback.onLayoutChanged();
+        QCOMPARE(feedback.mixer()->activeVoices(), 1);
+
+        feedback.setEnabled(false);
+        feedback.mixer()->stopAll();
+        feedback.onKeyPressed();
+        QCOMPARE(feedback.mixer()->activeVoices(), 0);
+    }
+
+    Q_SLOT void testSuspendedSink()
+    {
+        NullAudioSink *sink(new NullAudioSink(8000, 1, 5));
+        PcmFeedback feedback(sink);
+
+        SharedStyle style(new Style);
+        style->setProfile("ubuntu");
+        feedback.setStyle(style);
+        QTRY_VERIFY(sink->periodCount() > 0);
+
+        // A suspended sink stops pulling periods:
+        feedback.setSuspended(true);
+        QTest::qWait(50);
+        const int suspended_count(sink->periodCount());
+        QTest::qWait(100);
+        QCOMPARE(sink->periodCount(), suspended_count);
+
+        // ... but still plays feedback, and stops again afterwards:
+        feedback.onKeyPressed();
+        QTRY_VERIFY(not sink->recordedPeriods().isEmpty());
+        QTRY_COMPARE(feedback.mixer()->activeVoices(), 0);
+        QTest::qWait(100);
+        const int played_count(sink->periodCount());
+        QTest::qWait(100);
+        QCOMPARE(sink->periodCount(), played_count);
+
+        feedback.setSuspended(false);
+        QTRY_VERIFY(sink->periodCount() > played_count);
+    }
+};
+
+QTEST_MAIN(TestPcmFeedback)
+#include "main.moc"
@@ -620,6 +620,38 @@ private:
         QCOMPARE(test_setup.host.lastPreeditString(), expected_preedit_string);
         QCOMPARE(test_setup.editor.text()->cursorPosition(), expected_cursor_position);
     }
+
+    Q_SLOT void testCoalescedCursorUpdates()
+    {
+        BasicSetupTest test_setup;
+        QSignalSpy spy(&test_setup.notifier, SIGNAL(cursorPositionChanged(int, QString)));
+        test_setup.notifier.setCoalescingEnabled(true);
+
+        // A drag over "foo bar baz", only the last position counts:
+        for (int position = 0; position <= 7; ++position) {
+            QScopedPointer<MImUpdateEvent> update_event(createUpdateEvent("foo bar baz", position));
+            test_setup.notifier.notify(update_event.data());
+        }
+
+        QCOMPARE(spy.count(), 0);
+        QTRY_COMPARE(spy.count(), 1);
+        QCOMPARE(spy.at(0).at(0).toInt(), 7);
+        QCOMPARE(test_setup.editor.text()->preedit(), QString("bar"));
+
+        // Selecting text drops a pending update:
+        QScopedPointer<MImUpdateEvent> update_event(createUpdateEvent("foo bar baz", 2));
+        test_setup.notifier.notify(update_event.data());
+
+        QMap<QString, QVariant> update;
+        update.insert("hasSelection", true);
+        update.insert("cursorPosition", 3);
+        update.insert("surroundingText", QString("foo bar baz"));
+        MImUpdateEvent selection_event(update, QStringList() << "hasSelection" << "cursorPosition");
+        test_setup.notifier.notify(&selection_event);
+
+        test_setup.notifier.flush();
+        QCOMPARE(spy.count(), 1);
+    }
 };
 
 QTEST_MAIN(TestPreeditString)
@@ -0,0 +1,138 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+ */
+
+
+#include "logic/state-machines/shiftmachine.h"
+#include "logic/state-machines/viewmachine.h"
+#include "logic/state-machines/deadkeymachine.h"
+
+#include <QtCore>
+#include <QtTest>
+
+using namespace MaliitKeyboard;
+using Logic::ShiftMachine;
+using Logic::ViewMachine;
+using Logic::DeadkeyMachine;
+
+class TestStateMachines
+    : public QObject
+{
+    Q_OBJECT
+
+private:
+    Q_SLOT void testShiftMachine()
+    {
+        ShiftMachine machine;
+        QVERIFY(machine.inState(ShiftMachine::NoShiftState));
+
+        // Nothing to cancel or release yet:
+        QVERIFY(not machine.processEvent(ShiftMachine::ShiftCancelled));
+        QVERIFY(not machine.processEvent(ShiftMachine::ShiftReleased));
+        QVERIFY(machine.inState(ShiftMachine::NoShiftState));
+
+        QVERIFY(machine.processEvent(ShiftMachine::ShiftPressed));
+        QVERIFY(machine.inState(ShiftMachine::LatchedShiftState));
+
+        QVERIFY(machine.processEvent(ShiftMachine::ShiftReleased));
+        QVERIFY(machine.inState(ShiftMachine::CapsLockState));
+
+        // Caps lock survives typing:
+        QVERIFY(not machine.processEvent(ShiftMachine::ShiftCancelled));
+        QVERIFY(machine.inState(ShiftMachine::CapsLockState));
+
+        QVERIFY(machine.processEvent(ShiftMachine::ShiftReleased));
+        QVERIFY(machine.inState(ShiftMachine::NoShiftState));
+
+        QVERIFY(machine.processEvent(ShiftMachine::AutoCapsActivated));
+        QVERIFY(machine.inState(ShiftMachine::LatchedShiftState));
+
+        QVERIFY(machine.processEvent(ShiftMachine::ShiftCancelled));
+        QVERIFY(machine.inState(ShiftMachine::NoShiftState));
+
+        machine.processEvent(ShiftMachine::ShiftPressed);
+        machine.restart();
+        QCOMPARE(machine.state(), static_cast<int>(ShiftMachine::NoShiftState));
+    }
+
+    Q_SLOT void testViewMachine()
+    {
+        ViewMachine machine;
+        QVERIFY(machine.inState(ViewMachine::MainState));
+
+        QVERIFY(not machine.processEvent(ViewMachine::SymSwitcherReleased));
+        QVERIFY(machine.processEvent(ViewMachine::SymKeyReleased));
+        QVERIFY(machine.inState(ViewMachine::Symbols0State));
+
+        QVERIFY(machine.processEvent(ViewMachine::SymSwitcherReleased));
+        QVERIFY(machine.inState(ViewMachine::Symbols1State));
+
+        QVERIFY(machine.processEvent(ViewMachine::SymSwitcherReleased));
+        QVERIFY(machine.inState(ViewMachine::Symbols0State));
+
+        machine.processEvent(ViewMachine::SymSwitcherReleased);
+        QVERIFY(machine.processEvent(ViewMachine::SymKeyReleased));
+        QVERIFY(machine.inState(ViewMachine::MainState));
+
+        machine.processEvent(ViewMachine::SymKeyReleased);
+        machine.restart();
+        QVERIFY(machine.inState(ViewMachine::MainState));
+    }
+
+    Q_SLOT void testDeadkeyMachine()
+    {
+        DeadkeyMachine machine;
+        QVERIFY(machine.inState(DeadkeyMachine::NoDeadkeyState));
+
+        Key accent;
+        accent.rLabel().setText(QString(QChar(0x00b4)));
+        machine.setAccentKey(accent);
+        QCOMPARE(machine.accentKey().label().text(), accent.label().text());
+
+        QVERIFY(machine.processEvent(DeadkeyMachine::DeadkeyPressed));
+        QVERIFY(machine.inState(DeadkeyMachine::DeadkeyState));
+
+        QVERIFY(machine.processEvent(DeadkeyMachine::DeadkeyReleased));
+        QVERIFY(machine.inState(DeadkeyMachine::LatchedDeadkeyState));
+
+        // Pressing the dead key again unlatches it:
+        QVERIFY(machine.processEvent(DeadkeyMachine::DeadkeyPressed));
+        QVERIFY(machine.inState(DeadkeyMachine::NoDeadkeyState));
+
+        machine.processEvent(DeadkeyMachine::DeadkeyPressed);
+        QVERIFY(machine.processEvent(DeadkeyMachine::DeadkeyCancelled));
+        QVERIFY(machine.inState(DeadkeyMachine::NoDeadkeyState));
+        QVERIFY(not machine.processEvent(DeadkeyMachine::DeadkeyCancelled));
+    }
+};
+
+QTEST_MAIN(TestStateMachines)
+#include "main.moc"
@@ -0,0 +1,106 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+
+#include "models/text.h"
+
+#include <QtCore>
+#include <QtTest>
+
+using namespace MaliitKeyboard;
+
+class TestSurroundingText
+    : public QObject
+{
+    Q_OBJECT
+
+private:
+    Q_SLOT void testContext_data()
+    {
+        QTest::addColumn<QString>("surrounding");
+        QTest::addColumn<int>("offset");
+        QTest::addColumn<int>("max_words");
+        QTest::addColumn<QString>("expected_context");
+
+        QTest::newRow("empty") << "" << 0 << 3 << "";
+        QTest::newRow("fewer words than requested") << "aa bb" << 5 << 3 << "aa bb";
+        QTest::newRow("last two words") << "aa bb cc" << 8 << 2 << " bb cc";
+        QTest::newRow("trailing space") << "aa bb " << 6 << 1 << " bb ";
+        QTest::newRow("cursor in the middle") << "aa bb cc dd" << 5 << 1 << " bb";
+        QTest::newRow("no words") << "aa bb" << 5 << 0 << "";
+    }
+
+    Q_SLOT void testContext()
+    {
+        QFETCH(QString, surrounding);
+        QFETCH(int, offset);
+        QFETCH(int, max_words);
+        QFETCH(QString, expected_context);
+
+        Model::Text text;
+        text.setSurrounding(surrounding);
+        text.setSurroundingOffset(offset);
+
+        QCOMPARE(text.surroundingContext(max_words).toString(), expected_context);
+    }
+
+    Q_SLOT void testBoundedContext()
+    {
+        // A long document must not leak into the context as a whole, even
+        // when it contains no word separators at all:
+        Model::Text text;
+        const QString blob(10000, QChar('x'));
+        text.setSurrounding(blob);
+        text.setSurroundingOffset(blob.length());
+
+        const QStringRef context(text.surroundingContext(8));
+        QVERIFY(not context.isEmpty());
+        QVERIFY(context.length() < 1000);
+        QCOMPARE(context.position() + context.length(), blob.length());
+    }
+
+    Q_SLOT void testUnchangedSurrounding()
+    {
+        Model::Text text;
+        const QString surrounding("foo bar");
+        text.setSurrounding(surrounding);
+
+        // Surrounding text is shared with the caller, not copied:
+        QVERIFY(text.surrounding().constData() == surrounding.constData());
+
+        text.setSurrounding("foo baz");
+        QCOMPARE(text.surrounding(), QString("foo baz"));
+    }
+};
+
+QTEST_MAIN(TestSurroundingText)
+#include "main.moc"
@@ -7,6 +7,15 @@ SUBDIRS = \
     repeat-backspace \
     word-candidates \
     language-layout-loading \
+    image-atlas \
+    pcm-feedback \
+    latency-tracing \
+    word-boundary-tracker \
+    key-states \
+    state-machines \
+    surrounding-text \
+    idle-wakeups \
+    geometry-notifier \
 
 CONFIG += ordered
 QMAKE_EXTRA_TARGETS += check
@@ -0,0 +1,192 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+#include "logic/wordboundarytracker.h"
+
+#include <QtCore>
+#include <QtTest>
+
+using namespace MaliitKeyboard;
+using Logic::AbstractTextEditor;
+using Logic::WordBoundaryTracker;
+
+namespace {
+
+// Straightforward scan, used as reference.
+AbstractTextEditor::Replacement referenceBoundaries(const QString &text,
+                                                    int cursor_position)
+{
+    const QString fake_text(text + " ");
+    cursor_position = qBound(0, cursor_position, text.length());
+    int begin(-1);
+    int end(-2);
+
+    for (int iter(cursor_position); iter >= 0; --iter) {
+        if (WordBoundaryTracker::isSeparator(fake_text.at(iter))) {
+            if (iter != cursor_position) {
+                break;
+            }
+        } else {
+            begin = iter;
+        }
+    }
+
+    if (begin >= 0) {
+        for (int iter(cursor_position); iter <= text.length(); ++iter) {
+            end = iter;
+            if (WordBoundaryTracker::isSeparator(fake_text.at(iter))) {
+                break;
+            }
+        }
+    }
+
+    return AbstractTextEditor::Replacement(begin, end - begin, cursor_position);
+}
+
+} // namespace
+
+class TestWordBoundaryTracker
+    : public QObject
+{
+    Q_OBJECT
+
+private:
+    Q_SLOT void testBoundaries_data()
+    {
+        QTest::addColumn<QString>("text");
+        QTest::addColumn<int>("cursor_position");
+        QTest::addColumn<int>("expected_start");
+        QTest::addColumn<int>("expected_length");
+
+        QTest::newRow("after word") << "foo bar" << 3 << 0 << 3;
+        QTest::newRow("inside word") << "foo bar" << 5 << 4 << 3;
+        QTest::newRow("at end") << "foo bar" << 7 << 4 << 3;
+        QTest::newRow("beyond end") << "foo bar" << 42 << 4 << 3;
+        QTest::newRow("between separators") << "foo, bar" << 4 << -1 << -1;
+        QTest::newRow("at start") << "foo" << 0 << 0 << 3;
+    }
+
+    Q_SLOT void testBoundaries()
+    {
+        QFETCH(QString, text);
+        QFETCH(int, cursor_position);
+        QFETCH(int, expected_start);
+        QFETCH(int, expected_length);
+
+        WordBoundaryTracker tracker;
+        AbstractTextEditor::Replacement replacement;
+
+        QVERIFY(tracker.update(text, cursor_position, &replacement));
+        QCOMPARE(replacement.start, expected_start);
+        QCOMPARE(replacement.length, expected_length);
+        QVERIFY(not tracker.update(QString(), 0, &replacement));
+    }
+
+    Q_SLOT void testReuse()
+    {
+        WordBoundaryTracker tracker;
+        AbstractTextEditor::Replacement replacement;
+
+        QVERIFY(tracker.update("say hello world", 7, &replacement));
+        QVERIFY(not tracker.lastUpdateReused());
+
+        // Typing after the word does not touch it:
+        QVERIFY(tracker.update("say hello world!", 7, &replacement));
+        QVERIFY(tracker.lastUpdateReused());
+        QCOMPARE(replacement.start, 4);
+        QCOMPARE(replacement.length, 5);
+
+        // Typing before the word moves it:
+        QVERIFY(tracker.update("oh, say hello world!", 11, &replacement));
+        QVERIFY(tracker.lastUpdateReused());
+        QCOMPARE(replacement.start, 8);
+        QCOMPARE(replacement.length, 5);
+        QCOMPARE(replacement.cursor_position, 11);
+
+        // Edits on both sides that keep the length keep the word, too:
+        QVERIFY(tracker.update("ah, say hello world?", 11, &replacement));
+        QVERIFY(tracker.lastUpdateReused());
+        QCOMPARE(replacement.start, 8);
+
+        // Editing the word itself needs a scan:
+        QVERIFY(tracker.update("ah, say helo world?", 11, &replacement));
+        QVERIFY(not tracker.lastUpdateReused());
+        QCOMPARE(replacement.length, 4);
+
+        // Moving the cursor too:
+        QVERIFY(tracker.update("ah, say helo world?", 16, &replacement));
+        QVERIFY(not tracker.lastUpdateReused());
+        QCOMPARE(replacement.start, 13);
+    }
+
+    Q_SLOT void testRandomEdits()
+    {
+        const QString alphabet("ab ,c");
+        WordBoundaryTracker tracker;
+        QString text("ab cab, ba");
+        qsrand(42);
+
+        for (int round = 0; round < 2000; ++round) {
+            const int position(qrand() % (text.length() + 1));
+
+            switch (qrand() % 3) {
+            case 0:
+                text.insert(position, alphabet.at(qrand() % alphabet.length()));
+                break;
+            case 1:
+                if (position < text.length()) {
+                    text.remove(position, 1);
+                }
+                break;
+            default:
+                break;
+            }
+
+            if (text.isEmpty()) {
+                text = "a";
+            }
+
+            const int cursor_position(qrand() % 3 == 0 ? qrand() % (text.length() + 1)
+                                                       : qMin(position + 1, text.length()));
+            AbstractTextEditor::Replacement replacement;
+            const AbstractTextEditor::Replacement expected(referenceBoundaries(text, cursor_position));
+
+            QVERIFY(tracker.update(text, cursor_position, &replacement));
+            QCOMPARE(replacement.start, expected.start);
+            QCOMPARE(replacement.length, expected.length);
+            QCOMPARE(replacement.cursor_position, expected.cursor_position);
+        }
+    }
+};
+
+QTEST_MAIN(TestWordBoundaryTracker)
+#include "main.moc"
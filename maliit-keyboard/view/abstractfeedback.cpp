@@ -96,6 +96,16 @@ AbstractFeedback::AbstractFeedback(QObject *parent)
 AbstractFeedback::~AbstractFeedback()
 {}
 
+//! \brief Lets backends stop background work while the keyboard is hidden.
+//! \param suspended Whether the keyboard is hidden.
+//!
+//! Feedback triggered while suspended still gets played. Does nothing by
+//! default.
+void AbstractFeedback::setSuspended(bool suspended)
+{
+    Q_UNUSED(suspended)
+}
+
 //! \brief Set whether the feedback provider is enabled.
 //! \param enabled Whether to enable feedback provider.
 //!
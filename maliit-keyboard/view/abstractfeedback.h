@@ -55,6 +55,7 @@ public:
     virtual ~AbstractFeedback() = 0;
 
     virtual void setStyle(const SharedStyle &style) = 0;
+    virtual void setSuspended(bool suspended);
 
     Q_SLOT void setEnabled(bool enabled);
     bool isEnabled() const;
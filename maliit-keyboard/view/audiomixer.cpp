@@ -0,0 +1,278 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+#include "audiomixer.h"
+
+namespace MaliitKeyboard {
+namespace {
+
+const int g_default_maximum_voices(4);
+const int g_default_retrigger_interval(40); // in ms, about the fastest auto-repeat rate.
+
+} // namespace
+
+//! \class AudioMixer
+//! \brief Mixes pre-decoded sounds into an output buffer.
+//!
+//! trigger() is called from the GUI thread, mix() from the audio thread;
+//! both only take a short lock, no decoding or allocation happens while
+//! playing. Triggered sounds overlap instead of cutting each other off, so
+//! fast typing does not swallow clicks. Retriggering the same sound faster
+//! than retriggerInterval() is ignored, which keeps auto-repeat from piling
+//! up voices.
+
+class AudioMixerPrivate
+{
+public:
+    struct Voice
+    {
+        int id;
+        int position; // in samples
+    };
+
+    const int sample_rate;
+    const int channels;
+    int maximum_voices;
+    int retrigger_interval;
+    QHash<int, PcmSound> sounds;
+    QHash<int, qint64> last_triggered;
+    QVector<Voice> voices;
+    QVector<int> accumulator;
+    QElapsedTimer clock;
+    mutable QMutex mutex;
+
+    explicit AudioMixerPrivate(int new_sample_rate,
+                               int new_channels)
+        : sample_rate(new_sample_rate)
+        , channels(new_channels)
+        , maximum_voices(g_default_maximum_voices)
+        , retrigger_interval(g_default_retrigger_interval)
+        , sounds()
+        , last_triggered()
+        , voices()
+        , accumulator()
+        , clock()
+        , mutex()
+    {
+        clock.start();
+    }
+};
+
+//! \param sample_rate The output sample rate; sounds get converted to it.
+//! \param channels The output channel count; sounds get converted to it.
+AudioMixer::AudioMixer(int sample_rate,
+                       int channels)
+    : d_ptr(new AudioMixerPrivate(sample_rate, channels))
+{}
+
+AudioMixer::~AudioMixer()
+{}
+
+int AudioMixer::sampleRate() const
+{
+    Q_D(const AudioMixer);
+    return d->sample_rate;
+}
+
+int AudioMixer::channels() const
+{
+    Q_D(const AudioMixer);
+    return d->channels;
+}
+
+//! \brief Sets how many sounds can play at the same time.
+//!
+//! When the limit is reached, the oldest voice gets dropped.
+void AudioMixer::setMaximumVoices(int count)
+{
+    Q_D(AudioMixer);
+    QMutexLocker locker(&d->mutex);
+    d->maximum_voices = qMax(1, count);
+}
+
+int AudioMixer::maximumVoices() const
+{
+    Q_D(const AudioMixer);
+    QMutexLocker locker(&d->mutex);
+    return d->maximum_voices;
+}
+
+//! \brief Sets the minimum time between two starts of the same sound.
+//! \param msecs Interval in milliseconds, 0 disables rate limiting.
+void AudioMixer::setRetriggerInterval(int msecs)
+{
+    Q_D(AudioMixer);
+    QMutexLocker locker(&d->mutex);
+    d->retrigger_interval = qMax(0, msecs);
+}
+
+int AudioMixer::retriggerInterval() const
+{
+    Q_D(const AudioMixer);
+    QMutexLocker locker(&d->mutex);
+    return d->retrigger_interval;
+}
+
+//! \brief Registers a sound under an id.
+//! \param id The id to use with trigger().
+//! \param sound The decoded sound. Converted to the output format here, so
+//!              that mix() only ever copies samples. A null sound removes
+//!              the id.
+void AudioMixer::setSound(int id,
+                          const PcmSound &sound)
+{
+    Q_D(AudioMixer);
+    const PcmSound converted(sound.converted(d->sample_rate, d->channels));
+
+    QMutexLocker locker(&d->mutex);
+
+    // Voices index into the old samples, so stop them.
+    for (int index = d->voices.size() - 1; index >= 0; --index) {
+        if (d->voices.at(index).id == id) {
+            d->voices.remove(index);
+        }
+    }
+
+    if (converted.isNull()) {
+        d->sounds.remove(id);
+    } else {
+        d->sounds.insert(id, converted);
+    }
+}
+
+void AudioMixer::clearSounds()
+{
+    Q_D(AudioMixer);
+    QMutexLocker locker(&d->mutex);
+    d->voices.clear();
+    d->sounds.clear();
+    d->last_triggered.clear();
+}
+
+//! \brief Starts playing a sound.
+//! \param id The id given to setSound().
+//!
+//! Returns false if there is no such sound or if it was rate limited.
+bool AudioMixer::trigger(int id)
+{
+    Q_D(AudioMixer);
+    QMutexLocker locker(&d->mutex);
+
+    if (not d->sounds.contains(id)) {
+        return false;
+    }
+
+    const qint64 now(d->clock.elapsed());
+    const QHash<int, qint64>::const_iterator last(d->last_triggered.constFind(id));
+
+    if (last != d->last_triggered.constEnd()
+        and now - last.value() < d->retrigger_interval) {
+        return false;
+    }
+
+    d->last_triggered.insert(id, now);
+
+    if (d->voices.size() >= d->maximum_voices) {
+        d->voices.remove(0, d->voices.size() - d->maximum_voices + 1);
+    }
+
+    const AudioMixerPrivate::Voice voice = { id, 0 };
+    d->voices.append(voice);
+
+    return true;
+}
+
+void AudioMixer::stopAll()
+{
+    Q_D(AudioMixer);
+    QMutexLocker locker(&d->mutex);
+    d->voices.clear();
+}
+
+int AudioMixer::activeVoices() const
+{
+    Q_D(const AudioMixer);
+    QMutexLocker locker(&d->mutex);
+    return d->voices.size();
+}
+
+//! \brief Renders the next frames of all active voices.
+//! \param buffer Receives frames * channels() interleaved samples.
+//! \param frames The number of frames to render.
+//!
+//! Returns false if nothing was playing, in which case the buffer is
+//! filled with silence.
+bool AudioMixer::mix(qint16 *buffer,
+                     int frames)
+{
+    Q_D(AudioMixer);
+    const int count(frames * d->channels);
+    QMutexLocker locker(&d->mutex);
+
+    if (d->voices.isEmpty()) {
+        memset(buffer, 0, count * sizeof(qint16));
+        return false;
+    }
+
+    // Only ever grows, to the size of one period.
+    if (d->accumulator.size() < count) {
+        d->accumulator.resize(count);
+    }
+
+    int *accumulator(d->accumulator.data());
+    memset(accumulator, 0, count * sizeof(int));
+
+    for (int index = d->voices.size() - 1; index >= 0; --index) {
+        AudioMixerPrivate::Voice &voice(d->voices[index]);
+        const QVector<qint16> &samples(d->sounds[voice.id].samples());
+        const int available(qMin(count, samples.size() - voice.position));
+        const qint16 *source(samples.constData() + voice.position);
+
+        for (int sample = 0; sample < available; ++sample) {
+            accumulator[sample] += source[sample];
+        }
+
+        voice.position += available;
+
+        if (voice.position >= samples.size()) {
+            d->voices.remove(index);
+        }
+    }
+
+    for (int sample = 0; sample < count; ++sample) {
+        buffer[sample] = static_cast<qint16>(qBound(-32768, accumulator[sample], 32767));
+    }
+
+    return true;
+}
+
+} // namespace MaliitKeyboard
@@ -0,0 +1,403 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+#include "audiosink.h"
+#include "audiomixer.h"
+
+#ifdef HAVE_QT_MULTIMEDIA
+#include <QAudioDeviceInfo>
+#include <QAudioOutput>
+#include <limits>
+#endif
+
+namespace MaliitKeyboard {
+
+//! \class AudioSink
+//! \brief Pulls mixed audio from an AudioMixer and outputs it.
+//!
+//! Sinks live in the audio thread: start() and stop() are invoked there,
+//! and so is AudioMixer::mix().
+
+AudioSink::AudioSink(QObject *parent)
+    : QObject(parent)
+    , m_mixer(0)
+    , m_stop_pending(false)
+    , m_stop_queued(false)
+{}
+
+AudioSink::~AudioSink()
+{}
+
+//! \brief Sets the mixer to pull audio from. Must be called before start().
+void AudioSink::setMixer(AudioMixer *mixer)
+{
+    m_mixer = mixer;
+}
+
+AudioMixer * AudioSink::mixer() const
+{
+    return m_mixer;
+}
+
+//! \brief Starts the sink again, cancelling a pending stopWhenIdle().
+void AudioSink::resume()
+{
+    m_stop_pending = false;
+    start();
+}
+
+//! \brief Stops the sink as soon as the mixer has no active voices.
+//!
+//! Sounds that are still playing, like the keyboard hide sound, are not cut
+//! off: the sink stops after the period that finished them, see
+//! periodMixed(). Afterwards, the sink causes no more wakeups until resume().
+void AudioSink::stopWhenIdle()
+{
+    m_stop_pending = true;
+    stopIfIdle();
+}
+
+//! \brief Tells the sink that a period was pulled from the mixer.
+//!
+//! Must be called by implementations, from the audio thread, after each
+//! AudioMixer::mix(). Stopping is deferred to the event loop, as the audio
+//! backend might be in the middle of a read.
+void AudioSink::periodMixed()
+{
+    if (m_stop_pending && not m_stop_queued
+        && m_mixer && m_mixer->activeVoices() == 0) {
+        m_stop_queued = true;
+        QMetaObject::invokeMethod(this, "stopIfIdle", Qt::QueuedConnection);
+    }
+}
+
+void AudioSink::stopIfIdle()
+{
+    m_stop_queued = false;
+
+    // Still playing: the period finishing the last voice stops the sink.
+    if (not m_stop_pending
+        || (m_mixer && m_mixer->activeVoices() > 0)) {
+        return;
+    }
+
+    m_stop_pending = false;
+    stop();
+}
+
+//! \class NullAudioSink
+//! \brief A sink that discards audio, but records what would have played.
+//!
+//! Pulls one period from the mixer per period interval, just like a sound
+//! card would. Periods that were not silent are recorded together with the
+//! time they were mixed at, which makes sound feedback testable without an
+//! audio device.
+
+class NullAudioSinkPrivate
+{
+public:
+    const int sample_rate;
+    const int channels;
+    const int period_ms;
+    QTimer timer;
+    QElapsedTimer clock;
+    QVector<qint16> buffer;
+    int period_count;
+    QList<NullAudioSink::Period> recorded_periods;
+    mutable QMutex mutex;
+
+    explicit NullAudioSinkPrivate(int new_sample_rate,
+                                  int new_channels,
+                                  int new_period_ms)
+        : sample_rate(new_sample_rate)
+        , channels(new_channels)
+        , period_ms(new_period_ms)
+        , timer()
+        , clock()
+        , buffer()
+        , period_count(0)
+        , recorded_periods()
+        , mutex()
+    {}
+
+    int periodFrames() const
+    {
+        return sample_rate * period_ms / 1000;
+    }
+};
+
+//! \param sample_rate The sample rate to request from the mixer.
+//! \param channels The channel count to request from the mixer.
+//! \param period_ms How often a period gets pulled from the mixer.
+//! \param parent The owner of this instance. Can be 0, in case QObject
+//!               ownership is not required.
+NullAudioSink::NullAudioSink(int sample_rate,
+                             int channels,
+                             int period_ms,
+                             QObject *parent)
+    : AudioSink(parent)
+    , d_ptr(new NullAudioSinkPrivate(sample_rate, channels, qMax(1, period_ms)))
+{
+    Q_D(NullAudioSink);
+
+    d->timer.setInterval(d->period_ms);
+#if QT_VERSION >= 0x050000
+    d->timer.setTimerType(Qt::PreciseTimer);
+#endif
+    d->buffer.resize(d->periodFrames() * d->channels);
+
+    connect(&d->timer, SIGNAL(timeout()),
+            this,      SLOT(onPeriodElapsed()));
+}
+
+NullAudioSink::~NullAudioSink()
+{}
+
+int NullAudioSink::sampleRate() const
+{
+    Q_D(const NullAudioSink);
+    return d->sample_rate;
+}
+
+int NullAudioSink::channels() const
+{
+    Q_D(const NullAudioSink);
+    return d->channels;
+}
+
+int NullAudioSink::periodFrames() const
+{
+    Q_D(const NullAudioSink);
+    return d->periodFrames();
+}
+
+//! \brief Returns how many periods were pulled since start(), silent or not.
+int NullAudioSink::periodCount() const
+{
+    Q_D(const NullAudioSink);
+    QMutexLocker locker(&d->mutex);
+    return d->period_count;
+}
+
+//! \brief Returns the periods that were not silent, in playback order.
+//!
+//! Safe to call from any thread.
+QList<NullAudioSink::Period> NullAudioSink::recordedPeriods() const
+{
+    Q_D(const NullAudioSink);
+    QMutexLocker locker(&d->mutex);
+    return d->recorded_periods;
+}
+
+void NullAudioSink::clearRecordedPeriods()
+{
+    Q_D(NullAudioSink);
+    QMutexLocker locker(&d->mutex);
+    d->recorded_periods.clear();
+}
+
+void NullAudioSink::start()
+{
+    Q_D(NullAudioSink);
+
+    if (not mixer()) {
+        qWarning() << __PRETTY_FUNCTION__
+                   << "No mixer set.";
+        return;
+    }
+
+    if (d->timer.isActive()) {
+        return;
+    }
+
+    d->clock.start();
+    d->timer.start();
+}
+
+void NullAudioSink::stop()
+{
+    Q_D(NullAudioSink);
+    d->timer.stop();
+}
+
+void NullAudioSink::onPeriodElapsed()
+{
+    Q_D(NullAudioSink);
+    const bool audible(mixer()->mix(d->buffer.data(), d->periodFrames()));
+
+    {
+        QMutexLocker locker(&d->mutex);
+        ++d->period_count;
+
+        if (audible) {
+            const Period period = { d->clock.elapsed(), d->buffer };
+            d->recorded_periods.append(period);
+        }
+    }
+
+    periodMixed();
+}
+
+#ifdef HAVE_QT_MULTIMEDIA
+namespace {
+
+const int g_output_sample_rate(44100);
+const int g_output_channels(2);
+const int g_output_buffer_ms(20);
+
+// Lets QAudioOutput pull samples straight from the mixer.
+class MixerDevice
+    : public QIODevice
+{
+public:
+    explicit MixerDevice(AudioSink *sink,
+                         QObject *parent = 0)
+        : QIODevice(parent)
+        , m_sink(sink)
+        , m_mixer(sink->mixer())
+    {}
+
+    virtual bool isSequential() const
+    {
+        return true;
+    }
+
+    virtual qint64 bytesAvailable() const
+    {
+        // Silence is always available.
+        return std::numeric_limits<int>::max();
+    }
+
+protected:
+    virtual qint64 readData(char *data,
+                            qint64 max_size)
+    {
+        const int frame_size(m_mixer->channels() * sizeof(qint16));
+        const int frames(max_size / frame_size);
+
+        m_mixer->mix(reinterpret_cast<qint16 *>(data), frames);
+        m_sink->periodMixed();
+        return frames * frame_size;
+    }
+
+    virtual qint64 writeData(const char *,
+                             qint64)
+    {
+        return -1;
+    }
+
+private:
+    AudioSink *m_sink;
+    AudioMixer *m_mixer;
+};
+
+} // namespace
+
+//! \class QtAudioSink
+//! \brief Plays mixed audio through QtMultimedia, with a small buffer.
+
+class QtAudioSinkPrivate
+{
+public:
+    QScopedPointer<MixerDevice> device;
+    QScopedPointer<QAudioOutput> output; // Reads from device, so destroy it first.
+
+    explicit QtAudioSinkPrivate()
+        : device()
+        , output()
+    {}
+};
+
+//! \param parent The owner of this instance. Can be 0, in case QObject
+//!               ownership is not required.
+QtAudioSink::QtAudioSink(QObject *parent)
+    : AudioSink(parent)
+    , d_ptr(new QtAudioSinkPrivate)
+{}
+
+QtAudioSink::~QtAudioSink()
+{}
+
+int QtAudioSink::sampleRate() const
+{
+    return g_output_sample_rate;
+}
+
+int QtAudioSink::channels() const
+{
+    return g_output_channels;
+}
+
+void QtAudioSink::start()
+{
+    Q_D(QtAudioSink);
+
+    if (not mixer() or d->output) {
+        return;
+    }
+
+    QAudioFormat format;
+    format.setSampleRate(g_output_sample_rate);
+    format.setChannelCount(g_output_channels);
+    format.setSampleSize(16);
+    format.setSampleType(QAudioFormat::SignedInt);
+    format.setByteOrder(QAudioFormat::Endian(QSysInfo::ByteOrder));
+    format.setCodec("audio/pcm");
+
+    if (not QAudioDeviceInfo::defaultOutputDevice().isFormatSupported(format)) {
+        qWarning() << __PRETTY_FUNCTION__
+                   << "Default audio device does not support" << format;
+        return;
+    }
+
+    // Created here, so that the output lives in the audio thread.
+    d->output.reset(new QAudioOutput(format));
+    d->output->setBufferSize(format.bytesForDuration(g_output_buffer_ms * 1000));
+    d->device.reset(new MixerDevice(this));
+    d->device->open(QIODevice::ReadOnly);
+    d->output->start(d->device.data());
+}
+
+void QtAudioSink::stop()
+{
+    Q_D(QtAudioSink);
+
+    if (d->output) {
+        d->output->stop();
+    }
+
+    d->output.reset();
+    d->device.reset();
+}
+#endif
+
+} // namespace MaliitKeyboard
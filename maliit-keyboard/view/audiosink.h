@@ -0,0 +1,140 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+#ifndef MALIIT_KEYBOARD_AUDIOSINK_H
+#define MALIIT_KEYBOARD_AUDIOSINK_H
+
+#include <QtCore>
+
+namespace MaliitKeyboard {
+
+class AudioMixer;
+
+class AudioSink
+    : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(AudioSink)
+
+public:
+    explicit AudioSink(QObject *parent = 0);
+    virtual ~AudioSink();
+
+    virtual int sampleRate() const = 0;
+    virtual int channels() const = 0;
+
+    void setMixer(AudioMixer *mixer);
+    AudioMixer * mixer() const;
+
+    Q_SLOT virtual void start() = 0;
+    Q_SLOT virtual void stop() = 0;
+
+    Q_SLOT void resume();
+    Q_SLOT void stopWhenIdle();
+
+    void periodMixed();
+
+private:
+    Q_SLOT void stopIfIdle();
+
+    AudioMixer *m_mixer;
+    bool m_stop_pending;
+    bool m_stop_queued;
+};
+
+class NullAudioSinkPrivate;
+
+class NullAudioSink
+    : public AudioSink
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(NullAudioSink)
+    Q_DECLARE_PRIVATE(NullAudioSink)
+
+public:
+    struct Period
+    {
+        qint64 timestamp; // ms since start()
+        QVector<qint16> samples;
+    };
+
+    explicit NullAudioSink(int sample_rate = 44100,
+                           int channels = 2,
+                           int period_ms = 10,
+                           QObject *parent = 0);
+    virtual ~NullAudioSink();
+
+    virtual int sampleRate() const;
+    virtual int channels() const;
+    int periodFrames() const;
+
+    int periodCount() const;
+    QList<Period> recordedPeriods() const;
+    void clearRecordedPeriods();
+
+    Q_SLOT virtual void start();
+    Q_SLOT virtual void stop();
+
+private:
+    const QScopedPointer<NullAudioSinkPrivate> d_ptr;
+
+    Q_SLOT void onPeriodElapsed();
+};
+
+#ifdef HAVE_QT_MULTIMEDIA
+class QtAudioSinkPrivate;
+
+class QtAudioSink
+    : public AudioSink
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(QtAudioSink)
+    Q_DECLARE_PRIVATE(QtAudioSink)
+
+public:
+    explicit QtAudioSink(QObject *parent = 0);
+    virtual ~QtAudioSink();
+
+    virtual int sampleRate() const;
+    virtual int channels() const;
+
+    Q_SLOT virtual void start();
+    Q_SLOT virtual void stop();
+
+private:
+    const QScopedPointer<QtAudioSinkPrivate> d_ptr;
+};
+#endif
+
+} // namespace MaliitKeyboard
+
+#endif // MALIIT_KEYBOARD_AUDIOSINK_H
@@ -0,0 +1,359 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+#include "imageatlas.h"
+
+namespace MaliitKeyboard {
+namespace {
+
+const int g_max_atlas_width(2048);
+const int g_atlas_padding(1); // Keeps BorderImage filtering from bleeding into neighbours.
+const char * const g_index_header("maliit-keyboard-atlas 1");
+
+struct AtlasEntry
+{
+    QString name;
+    QImage image;
+};
+
+bool higherFirst(const AtlasEntry &lhs,
+                 const AtlasEntry &rhs)
+{
+    return lhs.image.height() > rhs.image.height();
+}
+
+// Cut out images hold a reference to the atlas, see ImageAtlas::image():
+void releaseAtlas(void *atlas)
+{
+    delete static_cast<QImage *>(atlas);
+}
+
+// Images of a style only change on installation, so the newest file (or the
+// directory itself) identifies the current set of images.
+QDateTime newestModification(const QFileInfoList &files,
+                             const QFileInfo &directory)
+{
+    QDateTime newest(directory.lastModified());
+
+    Q_FOREACH (const QFileInfo &file, files) {
+        if (file.lastModified() > newest) {
+            newest = file.lastModified();
+        }
+    }
+
+    return newest;
+}
+
+} // namespace
+
+//! \class ImageAtlas
+//! Packs all images of a style into one pre-decoded image, so that the first
+//! use of a key background or icon does not stall on decoding its file.
+//! Packed atlases are stored in a cache directory, keyed by image directory
+//! and modification time, so that packing only happens once per style
+//! installation.
+
+class ImageAtlasPrivate
+{
+public:
+    QImage atlas;
+    QHash<QString, QRect> rects;
+    bool from_cache;
+
+    explicit ImageAtlasPrivate()
+        : atlas()
+        , rects()
+        , from_cache(false)
+    {}
+
+    bool loadCache(const QString &atlas_file,
+                   const QString &index_file);
+    void saveCache(const QString &atlas_file,
+                   const QString &index_file) const;
+    void pack(QList<AtlasEntry> entries);
+};
+
+bool ImageAtlasPrivate::loadCache(const QString &atlas_file,
+                                  const QString &index_file)
+{
+    QFile index(index_file);
+
+    if (not index.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return false;
+    }
+
+    QTextStream stream(&index);
+
+    if (stream.readLine() != QLatin1String(g_index_header)) {
+        return false;
+    }
+
+    QHash<QString, QRect> cached_rects;
+
+    while (not stream.atEnd()) {
+        const QStringList fields(stream.readLine().split(' '));
+
+        if (fields.count() != 5) {
+            continue;
+        }
+
+        cached_rects.insert(fields.at(0), QRect(fields.at(1).toInt(), fields.at(2).toInt(),
+                                                fields.at(3).toInt(), fields.at(4).toInt()));
+    }
+
+    const QImage cached_atlas(atlas_file);
+
+    if (cached_atlas.isNull() || cached_rects.isEmpty()) {
+        return false;
+    }
+
+    atlas = cached_atlas.convertToFormat(QImage::Format_ARGB32);
+    rects = cached_rects;
+    return true;
+}
+
+void ImageAtlasPrivate::saveCache(const QString &atlas_file,
+                                  const QString &index_file) const
+{
+    QDir().mkpath(QFileInfo(atlas_file).absolutePath());
+
+    if (not atlas.save(atlas_file, "PNG")) {
+        qWarning() << __PRETTY_FUNCTION__
+                   << "Could not write image atlas cache:" << atlas_file;
+        return;
+    }
+
+    QFile index(index_file);
+
+    if (not index.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+        return;
+    }
+
+    QTextStream stream(&index);
+    stream << g_index_header << "\n";
+
+    for (QHash<QString, QRect>::const_iterator it(rects.begin()), end(rects.end()); it != end; ++it) {
+        const QRect &r(it.value());
+        stream << it.key() << " " << r.x() << " " << r.y() << " " << r.width() << " " << r.height() << "\n";
+    }
+}
+
+// Simple shelf packing: highest images first, rows of at most
+// g_max_atlas_width pixels.
+void ImageAtlasPrivate::pack(QList<AtlasEntry> entries)
+{
+    qStableSort(entries.begin(), entries.end(), higherFirst);
+
+    int x(0);
+    int y(0);
+    int shelf_height(0);
+    int width(0);
+
+    for (int index = 0; index < entries.count(); ++index) {
+        const QImage &image(entries.at(index).image);
+
+        if (x > 0 && x + image.width() > g_max_atlas_width) {
+            x = 0;
+            y += shelf_height + g_atlas_padding;
+            shelf_height = 0;
+        }
+
+        rects.insert(entries.at(index).name, QRect(QPoint(x, y), image.size()));
+        x += image.width() + g_atlas_padding;
+        width = qMax(width, x);
+        shelf_height = qMax(shelf_height, image.height());
+    }
+
+    atlas = QImage(qMax(1, width), qMax(1, y + shelf_height), QImage::Format_ARGB32);
+    atlas.fill(0);
+
+    // Copy pixels as they are, so that a cached atlas (stored as PNG, which
+    // is not premultiplied) is identical to a freshly packed one:
+    Q_FOREACH (const AtlasEntry &entry, entries) {
+        const QRect &r(rects.value(entry.name));
+        const int bytes_per_line(r.width() * sizeof(QRgb));
+
+        for (int row = 0; row < r.height(); ++row) {
+            memcpy(atlas.scanLine(r.y() + row) + r.x() * sizeof(QRgb),
+                   entry.image.constScanLine(row), bytes_per_line);
+        }
+    }
+}
+
+ImageAtlas::ImageAtlas()
+    : d_ptr(new ImageAtlasPrivate)
+{}
+
+ImageAtlas::~ImageAtlas()
+{}
+
+//! \brief Loads all images of a directory into the atlas.
+//!
+//! Uses a cached atlas if one exists for the current state of the image
+//! directory, otherwise packs the images and stores the result in the cache.
+//! \param image_directory The directory containing the style's images.
+//! \param cache_directory Where to keep packed atlases. No caching if empty.
+//! \returns Whether any image was loaded.
+bool ImageAtlas::load(const QString &image_directory,
+                      const QString &cache_directory)
+{
+    Q_D(ImageAtlas);
+    clear();
+
+    const QDir dir(image_directory);
+    const QFileInfoList files(dir.entryInfoList(QStringList() << "*.png" << "*.jpg",
+                                                QDir::Files | QDir::Readable, QDir::Name));
+
+    if (files.isEmpty()) {
+        return false;
+    }
+
+    QString atlas_file;
+    QString index_file;
+
+    if (not cache_directory.isEmpty()) {
+        const QString key(QString("%1-%2")
+                          .arg(qHash(dir.absolutePath()), 0, 16)
+                          .arg(newestModification(files, QFileInfo(dir.absolutePath())).toTime_t()));
+        atlas_file = cache_directory + "/atlas-" + key + ".png";
+        index_file = cache_directory + "/atlas-" + key + ".index";
+
+        if (d->loadCache(atlas_file, index_file)) {
+            d->from_cache = true;
+            return true;
+        }
+
+        d->rects.clear();
+    }
+
+    QList<AtlasEntry> entries;
+
+    Q_FOREACH (const QFileInfo &file, files) {
+        AtlasEntry entry;
+        entry.name = file.fileName();
+        entry.image = QImage(file.absoluteFilePath()).convertToFormat(QImage::Format_ARGB32);
+
+        if (entry.image.isNull() || entry.name.contains(' ')) {
+            qWarning() << __PRETTY_FUNCTION__
+                       << "Cannot add image to atlas:" << file.absoluteFilePath();
+            continue;
+        }
+
+        entries.append(entry);
+    }
+
+    if (entries.isEmpty()) {
+        return false;
+    }
+
+    d->pack(entries);
+
+    if (not atlas_file.isEmpty()) {
+        d->saveCache(atlas_file, index_file);
+    }
+
+    return true;
+}
+
+void ImageAtlas::clear()
+{
+    Q_D(ImageAtlas);
+    d->atlas = QImage();
+    d->rects.clear();
+    d->from_cache = false;
+}
+
+bool ImageAtlas::isLoaded() const
+{
+    Q_D(const ImageAtlas);
+    return not d->atlas.isNull();
+}
+
+//! \brief Returns whether the atlas was read from cache, instead of packed.
+bool ImageAtlas::isFromCache() const
+{
+    Q_D(const ImageAtlas);
+    return d->from_cache;
+}
+
+int ImageAtlas::count() const
+{
+    Q_D(const ImageAtlas);
+    return d->rects.count();
+}
+
+QStringList ImageAtlas::names() const
+{
+    Q_D(const ImageAtlas);
+    return d->rects.keys();
+}
+
+//! \brief Returns the whole atlas.
+QImage ImageAtlas::image() const
+{
+    Q_D(const ImageAtlas);
+    return d->atlas;
+}
+
+//! \brief Returns the sub-rectangle of an image, or a null rectangle.
+//! \param name The image's file name, relative to the image directory.
+QRect ImageAtlas::rect(const QString &name) const
+{
+    Q_D(const ImageAtlas);
+    return d->rects.value(name);
+}
+
+//! \brief Returns an image, as cut from the atlas. Does not decode or copy
+//! anything.
+//!
+//! The returned image points into the atlas' pixels and keeps them alive,
+//! even across clear().
+//! \param name The image's file name, relative to the image directory.
+QImage ImageAtlas::image(const QString &name) const
+{
+    Q_D(const ImageAtlas);
+    const QRect r(d->rects.value(name));
+
+    if (r.isNull()) {
+        return QImage();
+    }
+
+    QImage *atlas(new QImage(d->atlas));
+    const uchar *bits(atlas->constBits()
+                      + r.y() * atlas->bytesPerLine()
+                      + r.x() * sizeof(QRgb));
+
+    return QImage(bits, r.width(), r.height(), atlas->bytesPerLine(),
+                  atlas->format(), releaseAtlas, atlas);
+}
+
+} // namespace MaliitKeyboard
@@ -0,0 +1,226 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+#include "labelpreshaper.h"
+#include "flushtimer.h"
+
+namespace MaliitKeyboard {
+
+//! \class LabelPreshaper
+//! Shapes key labels ahead of time, in small batches whenever the event loop
+//! is idle. Complex scripts (Indic, Thai, Arabic) need full text shaping and
+//! often fallback fonts. Doing that once, when a layout gets activated,
+//! means that fonts, including fallback fonts, are loaded by the time a view
+//! (shift, symbols, dead keys) shows the labels first.
+//!
+//! Glyphs are not rendered: QtQuick Text items draw from the scene graph's
+//! distance field glyph cache, which gets filled on the render thread when
+//! a label is first shown.
+//!
+//! Font engines are per thread, so this has to run on the GUI thread, where
+//! QtQuick lays out text.
+
+class LabelPreshaperPrivate
+{
+public:
+    QFont font;
+    QStringList pending;
+    QSet<QString> shaped;
+    FlushTimer timer;
+    int batch_size;
+    int glyph_count;
+    bool suspended;
+
+    explicit LabelPreshaperPrivate()
+        : font()
+        , pending()
+        , shaped()
+        , timer("LabelPreshaper::processBatch")
+        , batch_size(8)
+        , glyph_count(0)
+        , suspended(false)
+    {}
+
+    void shape(const QString &label);
+};
+
+void LabelPreshaperPrivate::shape(const QString &label)
+{
+    QTextLayout layout(label, font);
+    layout.setCacheEnabled(true);
+    layout.beginLayout();
+    layout.createLine();
+    layout.endLayout();
+
+    Q_FOREACH (const QGlyphRun &run, layout.glyphRuns()) {
+        glyph_count += run.glyphIndexes().count();
+    }
+}
+
+//! \param parent The owner of this instance (optional).
+LabelPreshaper::LabelPreshaper(QObject *parent)
+    : QObject(parent)
+    , d_ptr(new LabelPreshaperPrivate)
+{
+    Q_D(LabelPreshaper);
+
+    connect(&d->timer, SIGNAL(timeout()),
+            this,      SLOT(processBatch()));
+}
+
+LabelPreshaper::~LabelPreshaper()
+{}
+
+//! \brief Sets the font used for shaping. Labels get shaped again with the
+//! new font.
+void LabelPreshaper::setFont(const QFont &font)
+{
+    Q_D(LabelPreshaper);
+
+    if (d->font != font) {
+        d->font = font;
+        d->shaped.clear();
+    }
+}
+
+QFont LabelPreshaper::font() const
+{
+    Q_D(const LabelPreshaper);
+    return d->font;
+}
+
+//! \brief Sets how many labels are shaped per event loop iteration.
+void LabelPreshaper::setBatchSize(int size)
+{
+    Q_D(LabelPreshaper);
+    d->batch_size = qMax(1, size);
+}
+
+int LabelPreshaper::batchSize() const
+{
+    Q_D(const LabelPreshaper);
+    return d->batch_size;
+}
+
+//! \brief Queues labels for shaping. Labels already shaped with the current
+//! font are skipped.
+//! \param labels The labels, for example KeyboardLoader::labels().
+void LabelPreshaper::preshape(const QStringList &labels)
+{
+    Q_D(LabelPreshaper);
+
+    Q_FOREACH (const QString &label, labels) {
+        if (not label.isEmpty() && not d->shaped.contains(label)) {
+            d->pending.append(label);
+        }
+    }
+
+    if (not d->pending.isEmpty() && not d->suspended) {
+        d->timer.schedule();
+    }
+}
+
+//! \brief Drops all pending labels.
+void LabelPreshaper::clear()
+{
+    Q_D(LabelPreshaper);
+    d->pending.clear();
+    d->timer.stop();
+}
+
+//! \brief Sets whether shaping is paused. Pending labels are kept, and
+//! shaped once resumed. Meant for a hidden keyboard, which should not wake
+//! up by itself.
+void LabelPreshaper::setSuspended(bool suspended)
+{
+    Q_D(LabelPreshaper);
+
+    if (d->suspended == suspended) {
+        return;
+    }
+
+    d->suspended = suspended;
+
+    if (suspended) {
+        d->timer.stop();
+    } else if (not d->pending.isEmpty()) {
+        d->timer.schedule();
+    }
+}
+
+bool LabelPreshaper::isSuspended() const
+{
+    Q_D(const LabelPreshaper);
+    return d->suspended;
+}
+
+int LabelPreshaper::pendingCount() const
+{
+    Q_D(const LabelPreshaper);
+    return d->pending.count();
+}
+
+//! \brief Returns the number of distinct labels shaped with the current font.
+int LabelPreshaper::shapedCount() const
+{
+    Q_D(const LabelPreshaper);
+    return d->shaped.count();
+}
+
+//! \brief Returns the total number of glyphs shaped so far.
+int LabelPreshaper::glyphCount() const
+{
+    Q_D(const LabelPreshaper);
+    return d->glyph_count;
+}
+
+void LabelPreshaper::processBatch()
+{
+    Q_D(LabelPreshaper);
+
+    for (int count = 0; count < d->batch_size && not d->pending.isEmpty(); ++count) {
+        const QString label(d->pending.takeFirst());
+
+        if (not d->shaped.contains(label)) {
+            d->shape(label);
+            d->shaped.insert(label);
+        }
+    }
+
+    if (d->pending.isEmpty()) {
+        Q_EMIT finished();
+    } else {
+        d->timer.schedule();
+    }
+}
+
+} // namespace MaliitKeyboard
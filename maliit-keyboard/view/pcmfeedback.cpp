@@ -0,0 +1,246 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+#include "pcmfeedback.h"
+#include "audiomixer.h"
+#include "audiosink.h"
+#include "pcmsound.h"
+
+#include "logic/style.h"
+#include "models/styleattributes.h"
+
+//! \class MaliitKeyboard::PcmFeedback
+//! Provides a low-latency sound feedback backend. The profile's sounds are
+//! decoded once, when the style gets set, and played back by an AudioMixer
+//! that gets pulled from a dedicated audio thread. Used as default backend
+//! if QtMultimedia is configured.
+
+namespace MaliitKeyboard {
+namespace {
+
+enum EffectId
+{
+    KeyPressEffect,
+    KeyReleaseEffect,
+    LayoutChangeEffect,
+    KeyboardHideEffect
+};
+
+AudioSink * createDefaultSink()
+{
+#ifdef HAVE_QT_MULTIMEDIA
+    return new QtAudioSink;
+#else
+    return new NullAudioSink;
+#endif
+}
+
+} // namespace
+
+class PcmFeedbackPrivate
+{
+public:
+    SharedStyle style;
+    QThread thread;
+    AudioSink *sink;
+    const QScopedPointer<AudioMixer> mixer;
+    bool suspended;
+
+    explicit PcmFeedbackPrivate(AudioSink *new_sink);
+    ~PcmFeedbackPrivate();
+
+    void trigger(EffectId id);
+
+    void setupEffect(EffectId id,
+                     const QString &sounds_dir,
+                     const QByteArray &file,
+                     QHash<QByteArray, PcmSound> *decoded);
+};
+
+PcmFeedbackPrivate::PcmFeedbackPrivate(AudioSink *new_sink)
+    : style()
+    , thread()
+    , sink(new_sink)
+    , mixer(new AudioMixer(new_sink->sampleRate(), new_sink->channels()))
+    , suspended(false)
+{
+    sink->setMixer(mixer.data());
+    sink->moveToThread(&thread);
+    thread.start(QThread::TimeCriticalPriority);
+    QMetaObject::invokeMethod(sink, "start", Qt::QueuedConnection);
+}
+
+PcmFeedbackPrivate::~PcmFeedbackPrivate()
+{
+    QMetaObject::invokeMethod(sink, "stop", Qt::BlockingQueuedConnection);
+    thread.quit();
+    thread.wait();
+    delete sink;
+}
+
+void PcmFeedbackPrivate::trigger(EffectId id)
+{
+    if (not mixer->trigger(id) || not suspended) {
+        return;
+    }
+
+    // Play through a stopped sink, and stop it again once done:
+    QMetaObject::invokeMethod(sink, "resume", Qt::QueuedConnection);
+    QMetaObject::invokeMethod(sink, "stopWhenIdle", Qt::QueuedConnection);
+}
+
+void PcmFeedbackPrivate::setupEffect(EffectId id,
+                                     const QString &sounds_dir,
+                                     const QByteArray &file,
+                                     QHash<QByteArray, PcmSound> *decoded)
+{
+    if (file.isEmpty()) {
+        mixer->setSound(id, PcmSound());
+        return;
+    }
+
+    // Press and release usually share the same file.
+    if (not decoded->contains(file)) {
+        decoded->insert(file, PcmSound::fromWav(sounds_dir + "/" + file));
+    }
+
+    mixer->setSound(id, decoded->value(file));
+}
+
+//! \brief Constructor, plays through QtMultimedia if available.
+//! \param parent The owner of this instance. Can be 0, in case QObject
+//!               ownership is not required.
+PcmFeedback::PcmFeedback(QObject *parent)
+    : AbstractFeedback(parent)
+    , d_ptr(new PcmFeedbackPrivate(createDefaultSink()))
+{
+    setEnabled(true);
+}
+
+//! \brief Constructor.
+//! \param sink The sink to play through, for example a NullAudioSink in
+//!             tests. Takes ownership and moves it to the audio thread.
+//! \param parent The owner of this instance. Can be 0, in case QObject
+//!               ownership is not required.
+PcmFeedback::PcmFeedback(AudioSink *sink,
+                         QObject *parent)
+    : AbstractFeedback(parent)
+    , d_ptr(new PcmFeedbackPrivate(sink))
+{
+    setEnabled(true);
+}
+
+PcmFeedback::~PcmFeedback()
+{}
+
+void PcmFeedback::setStyle(const SharedStyle &style)
+{
+    Q_D(PcmFeedback);
+    if (d->style != style) {
+        if (d->style) {
+            disconnect(d->style.data(), SIGNAL(profileChanged()),
+                       this,            SLOT(applyProfile()));
+        }
+        d->style = style;
+
+        if (d->style.isNull()) {
+            d->mixer->clearSounds();
+            return;
+        }
+
+        connect(d->style.data(), SIGNAL(profileChanged()),
+                this,            SLOT(applyProfile()));
+        applyProfile();
+    }
+}
+
+//! \brief Stops the audio sink while suspended, so that a hidden keyboard
+//! does not keep pulling silence from the mixer. The sink is started again
+//! when resuming, or temporarily when feedback is triggered.
+void PcmFeedback::setSuspended(bool suspended)
+{
+    Q_D(PcmFeedback);
+
+    if (d->suspended == suspended) {
+        return;
+    }
+
+    d->suspended = suspended;
+    QMetaObject::invokeMethod(d->sink, suspended ? "stopWhenIdle" : "resume",
+                              Qt::QueuedConnection);
+}
+
+//! \brief Returns the mixer, e.g. to tune voice count and rate limiting.
+AudioMixer * PcmFeedback::mixer() const
+{
+    Q_D(const PcmFeedback);
+    return d->mixer.data();
+}
+
+void PcmFeedback::applyProfile()
+{
+    Q_D(PcmFeedback);
+    const QString path(d->style->directory(Style::Sounds));
+    const StyleAttributes *attributes(d->style->attributes());
+    QHash<QByteArray, PcmSound> decoded;
+
+    d->setupEffect(KeyPressEffect, path, attributes->keyPressSound(), &decoded);
+    d->setupEffect(KeyReleaseEffect, path, attributes->keyReleaseSound(), &decoded);
+    d->setupEffect(LayoutChangeEffect, path, attributes->layoutChangeSound(), &decoded);
+    d->setupEffect(KeyboardHideEffect, path, attributes->keyboardHideSound(), &decoded);
+}
+
+void PcmFeedback::playPressFeedback()
+{
+    Q_D(PcmFeedback);
+    d->trigger(KeyPressEffect);
+}
+
+void PcmFeedback::playReleaseFeedback()
+{
+    Q_D(PcmFeedback);
+    d->trigger(KeyReleaseEffect);
+}
+
+void PcmFeedback::playLayoutChangeFeedback()
+{
+    Q_D(PcmFeedback);
+    d->trigger(LayoutChangeEffect);
+}
+
+void PcmFeedback::playKeyboardHideFeedback()
+{
+    Q_D(PcmFeedback);
+    d->trigger(KeyboardHideEffect);
+}
+
+} // namespace MaliitKeyboard
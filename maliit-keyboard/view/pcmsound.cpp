@@ -0,0 +1,243 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+#include "pcmsound.h"
+
+namespace MaliitKeyboard {
+namespace {
+
+const quint16 g_wave_format_pcm(1);
+
+quint16 readUInt16(const char *data)
+{
+    return qFromLittleEndian<quint16>(reinterpret_cast<const uchar *>(data));
+}
+
+quint32 readUInt32(const char *data)
+{
+    return qFromLittleEndian<quint32>(reinterpret_cast<const uchar *>(data));
+}
+
+qint16 clampSample(int value)
+{
+    return static_cast<qint16>(qBound<int>(-32768, value, 32767));
+}
+
+} // namespace
+
+//! \class PcmSound
+//! \brief A decoded sound, stored as interleaved signed 16 bit samples.
+//!
+//! Sounds are decoded once, when a style profile gets applied, so that
+//! playing them back only needs to copy samples into the audio buffer.
+
+PcmSound::PcmSound()
+    : m_sample_rate(0)
+    , m_channels(0)
+    , m_samples()
+{}
+
+//! \param sample_rate Frames per second.
+//! \param channels Number of interleaved channels per frame.
+//! \param samples Interleaved samples.
+PcmSound::PcmSound(int sample_rate,
+                   int channels,
+                   const QVector<qint16> &samples)
+    : m_sample_rate(sample_rate)
+    , m_channels(channels)
+    , m_samples(samples)
+{}
+
+//! \brief Decodes an uncompressed RIFF WAVE file.
+//! \param file_name The WAV file to read.
+//!
+//! Returns a null sound if the file cannot be read or is not 8 or 16 bit PCM.
+PcmSound PcmSound::fromWav(const QString &file_name)
+{
+    QFile file(file_name);
+
+    if (not file.open(QIODevice::ReadOnly)) {
+        qWarning() << __PRETTY_FUNCTION__
+                   << "Could not open sound file:" << file_name;
+        return PcmSound();
+    }
+
+    const PcmSound sound(fromWav(file.readAll()));
+
+    if (sound.isNull()) {
+        qWarning() << __PRETTY_FUNCTION__
+                   << "Unsupported sound file:" << file_name;
+    }
+
+    return sound;
+}
+
+//! \brief Decodes uncompressed RIFF WAVE data.
+//! \param data The contents of a WAV file.
+PcmSound PcmSound::fromWav(const QByteArray &data)
+{
+    if (data.size() < 12
+        or not data.startsWith("RIFF")
+        or data.mid(8, 4) != "WAVE") {
+        return PcmSound();
+    }
+
+    const char *begin(data.constData());
+    int sample_rate(0);
+    int channels(0);
+    int bits_per_sample(0);
+    int offset(12);
+
+    while (offset + 8 <= data.size()) {
+        const QByteArray id(data.mid(offset, 4));
+        const int size(qMin<quint32>(readUInt32(begin + offset + 4), data.size() - offset - 8));
+        const char *chunk(begin + offset + 8);
+
+        if (id == "fmt " and size >= 16) {
+            if (readUInt16(chunk) != g_wave_format_pcm) {
+                return PcmSound();
+            }
+
+            channels = readUInt16(chunk + 2);
+            sample_rate = readUInt32(chunk + 4);
+            bits_per_sample = readUInt16(chunk + 14);
+        } else if (id == "data") {
+            if (channels <= 0 or sample_rate <= 0) {
+                return PcmSound();
+            }
+
+            QVector<qint16> samples;
+
+            if (bits_per_sample == 16) {
+                samples.resize(size / 2);
+                for (int index = 0; index < samples.size(); ++index) {
+                    samples[index] = static_cast<qint16>(readUInt16(chunk + index * 2));
+                }
+            } else if (bits_per_sample == 8) {
+                samples.resize(size);
+                for (int index = 0; index < samples.size(); ++index) {
+                    // 8 bit WAV samples are unsigned.
+                    samples[index] = (static_cast<uchar>(chunk[index]) - 128) * 256;
+                }
+            } else {
+                return PcmSound();
+            }
+
+            // Drop a trailing partial frame, if any.
+            samples.resize(samples.size() - samples.size() % channels);
+            return PcmSound(sample_rate, channels, samples);
+        }
+
+        // Chunks are padded to an even size.
+        offset += 8 + size + (size % 2);
+    }
+
+    return PcmSound();
+}
+
+bool PcmSound::isNull() const
+{
+    return (m_sample_rate <= 0 or m_channels <= 0 or m_samples.isEmpty());
+}
+
+int PcmSound::sampleRate() const
+{
+    return m_sample_rate;
+}
+
+int PcmSound::channels() const
+{
+    return m_channels;
+}
+
+int PcmSound::frameCount() const
+{
+    return (m_channels > 0 ? m_samples.size() / m_channels : 0);
+}
+
+int PcmSound::durationMs() const
+{
+    return (m_sample_rate > 0 ? qint64(frameCount()) * 1000 / m_sample_rate : 0);
+}
+
+const QVector<qint16> & PcmSound::samples() const
+{
+    return m_samples;
+}
+
+//! \brief Returns a copy of this sound, converted to another format.
+//! \param sample_rate The wanted sample rate, uses linear interpolation.
+//! \param channels The wanted channel count. Mono gets duplicated into all
+//!                 channels, anything else gets downmixed to mono first.
+PcmSound PcmSound::converted(int sample_rate,
+                             int channels) const
+{
+    if (isNull() or sample_rate <= 0 or channels <= 0) {
+        return PcmSound();
+    }
+
+    if (sample_rate == m_sample_rate and channels == m_channels) {
+        return *this;
+    }
+
+    const int source_frames(frameCount());
+    QVector<qint16> mono(source_frames);
+
+    for (int frame = 0; frame < source_frames; ++frame) {
+        int sum(0);
+        for (int channel = 0; channel < m_channels; ++channel) {
+            sum += m_samples.at(frame * m_channels + channel);
+        }
+        mono[frame] = clampSample(sum / m_channels);
+    }
+
+    const bool keep_channels(channels == m_channels);
+    const int target_frames(qMax<qint64>(1, qint64(source_frames) * sample_rate / m_sample_rate));
+    QVector<qint16> samples(target_frames * channels);
+
+    for (int frame = 0; frame < target_frames; ++frame) {
+        const qint64 position(qint64(frame) * m_sample_rate * 256 / sample_rate);
+        const int index(qMin<int>(position / 256, source_frames - 1));
+        const int next(qMin(index + 1, source_frames - 1));
+        const int weight(position % 256);
+
+        for (int channel = 0; channel < channels; ++channel) {
+            const int first(keep_channels ? m_samples.at(index * channels + channel) : mono.at(index));
+            const int second(keep_channels ? m_samples.at(next * channels + channel) : mono.at(next));
+            samples[frame * channels + channel] = clampSample(first + (second - first) * weight / 256);
+        }
+    }
+
+    return PcmSound(sample_rate, channels, samples);
+}
+
+} // namespace MaliitKeyboard
@@ -0,0 +1,69 @@
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+#ifndef MALIIT_KEYBOARD_PCMSOUND_H
+#define MALIIT_KEYBOARD_PCMSOUND_H
+
+#include <QtCore>
+
+namespace MaliitKeyboard {
+
+class PcmSound
+{
+public:
+    explicit PcmSound();
+    explicit PcmSound(int sample_rate,
+                      int channels,
+                      const QVector<qint16> &samples);
+
+    static PcmSound fromWav(const QString &file_name);
+    static PcmSound fromWav(const QByteArray &data);
+
+    bool isNull() const;
+    int sampleRate() const;
+    int channels() const;
+    int frameCount() const;
+    int durationMs() const;
+    const QVector<qint16> & samples() const;
+
+    PcmSound converted(int sample_rate,
+                       int channels) const;
+
+private:
+    int m_sample_rate;
+    int m_channels;
+    QVector<qint16> m_samples;
+};
+
+} // namespace MaliitKeyboard
+
+#endif // MALIIT_KEYBOARD_PCMSOUND_H
@@ -5,3 +5,7 @@ enable-qt-mobility {
     MOBILITY += feedback
     DEFINES += HAVE_QT_MOBILITY
 }
+
+enable-qt-multimedia {
+    DEFINES += HAVE_QT_MULTIMEDIA
+}
@@ -17,15 +17,31 @@ contains(QT_MAJOR_VERSION, 4) {
     QT = core gui widgets
 }
 
+enable-qt-multimedia {
+    QT += multimedia
+}
+
 HEADERS += \
     abstractfeedback.h \
     nullfeedback.h \
     surface.h \
+    imageatlas.h \
+    labelpreshaper.h \
+    pcmsound.h \
+    audiomixer.h \
+    audiosink.h \
+    pcmfeedback.h \
 
 SOURCES += \
     abstractfeedback.cpp \
     nullfeedback.cpp \
     surface.cpp \
+    imageatlas.cpp \
+    labelpreshaper.cpp \
+    pcmsound.cpp \
+    audiomixer.cpp \
+    audiosink.cpp \
+    pcmfeedback.cpp \
 
 enable-qt-mobility {
     HEADERS += soundfeedback.h
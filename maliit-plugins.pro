@@ -14,6 +14,7 @@ include(config.pri)
         \\n\\t enable-hunspell: Use hunspell for error correction (maliit-keyboard-plugin only) \
         \\n\\t disable-preedit: Always commit characters and never use preedit (maliit-keyboard-plugin only) \
         \\n\\t enable-qt-mobility: Enable use of QtMobility (enables sound and haptic feedback) \
+        \\n\\t enable-qt-multimedia: Enable use of QtMultimedia (enables low-latency sound feedback, Qt 5 only) \
         \\n\\t notests: Do not attempt to build tests \
         \\n\\t nodoc: Do not build documentation \
         \\n\\t disable-maliit-keyboard: Do not build the C++ reference keyboard (Maliit Keyboard) \
@@ -73,6 +74,10 @@ enable-qt-mobility {
     COVERAGE_CONFIG_STRING += CONFIG+=enable-qt-mobility
 }
 
+enable-qt-multimedia {
+    COVERAGE_CONFIG_STRING += CONFIG+=enable-qt-multimedia
+}
+
 COVERAGE_DIR = coverage-build
 
 QMAKE_EXTRA_TARGETS += coverage